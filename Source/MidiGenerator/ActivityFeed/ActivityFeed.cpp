@@ -0,0 +1,120 @@
+/*
+ * ActivityFeed.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "ActivityFeed.hpp"
+#include "FiringHistory.hpp"
+
+/*
+ * Activity Frame
+ */
+
+bool ActivityFrame::has_fired(int neuron_idx) const {
+  return (firing[neuron_idx / 64] >> (neuron_idx % 64)) & 1;
+}
+
+uint8 ActivityFrame::quantize_charge(int state, int threshold) {
+  if (threshold <= 0) {
+    return state > threshold ? full_charge : 0;
+  }
+  int64 charge = static_cast<int64>(state) * full_charge / threshold;
+  return static_cast<uint8>(jlimit<int64>(0, full_charge, charge));
+}
+
+/*
+ * Activity Feed
+ */
+
+ActivityFeed::ActivityFeed() : fifo(capacity), frames(capacity) {
+  pending.num_ticks = 0;
+}
+ActivityFeed::~ActivityFeed() {}
+
+// Audio Thread
+
+void ActivityFeed::write_tick(Brain &brain) {
+  int num_neurons = jmin(brain.num_neurons(), ActivityFrame::max_neurons);
+  const std::vector<int> &output = brain.get_output();
+
+  // neurons have been added or removed, so the old bits are for other neurons
+  if (num_neurons != pending.num_neurons) {
+    pending.firing.fill(0);
+    pending.num_neurons = num_neurons;
+  }
+  ++pending.num_ticks;
+  for (int i = 0; i < num_neurons; ++i) {
+    if (output[i] > 0) {
+      pending.firing[i / 64] |= uint64{1} << (i % 64);
+    }
+    // against the threshold played, which a morph may have moved
+    pending.charge[i] = ActivityFrame::quantize_charge(
+        brain.get_state_for_neuron(i), brain.get_played_threshold(i));
+  }
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 == 0) {
+    // the editor is behind, so this tick stays folded into the pending frame
+    return;
+  }
+  copy_frame(pending, frames[start1]);
+  fifo.finishedWrite(1);
+  std::fill_n(pending.firing.begin(), num_firing_words(num_neurons), 0);
+  pending.num_ticks = 0;
+}
+
+// GUI Thread
+
+// Reads every frame written since the last read into `activity`. A neuron has
+// fired if it fired on any of those ticks, and the charges are the latest.
+// Each frame is also pushed onto `history`, if there is one.
+bool ActivityFeed::read(ActivityFrame &activity, FiringHistory *history) {
+  int num_ready = fifo.getNumReady();
+  if (num_ready == 0) {
+    return false;
+  }
+
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(num_ready, start1, size1, start2, size2);
+  activity.firing.fill(0);
+  activity.num_ticks = 0;
+  for (int block : {0, 1}) {
+    int start = block == 0 ? start1 : start2;
+    int size = block == 0 ? size1 : size2;
+    for (int i = start; i < start + size; ++i) {
+      const ActivityFrame &frame = frames[i];
+      int num_words = num_firing_words(frame.num_neurons);
+      for (int word = 0; word < num_words; ++word) {
+        activity.firing[word] |= frame.firing[word];
+      }
+      std::copy_n(frame.charge.begin(), frame.num_neurons,
+                  activity.charge.begin());
+      activity.num_neurons = frame.num_neurons;
+      activity.num_ticks += frame.num_ticks;
+      if (history != nullptr) {
+        history->push(frame);
+      }
+    }
+  }
+  fifo.finishedRead(size1 + size2);
+  return true;
+}
+
+// Private Methods
+
+void ActivityFeed::copy_frame(const ActivityFrame &source,
+                              ActivityFrame &destination) {
+  destination.num_neurons = source.num_neurons;
+  destination.num_ticks = source.num_ticks;
+  std::copy_n(source.firing.begin(), num_firing_words(source.num_neurons),
+              destination.firing.begin());
+  std::copy_n(source.charge.begin(), source.num_neurons,
+              destination.charge.begin());
+}
+
+int ActivityFeed::num_firing_words(int num_neurons) {
+  return (num_neurons + 63) / 64;
+}
@@ -0,0 +1,76 @@
+/*
+ * ActivityFeed.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../WellNeurons/Brain.hpp"
+#include <array>
+#include <vector>
+
+class FiringHistory;
+
+/*
+ * Activity Frame
+ *
+ * What the network looked like on a tick: which neurons fired, as a bitset,
+ * and how charged each neuron is, as its state quantized to a fraction of its
+ * threshold (full_charge at or over it). A frame the writer had to fold
+ * several ticks into covers all of them, and says how many there were.
+ */
+
+struct ActivityFrame {
+  static constexpr int max_neurons{1024};
+  static constexpr uint8 full_charge{255};
+
+  int num_neurons{0};
+  int num_ticks{1};
+  std::array<uint64, max_neurons / 64> firing{};
+  std::array<uint8, max_neurons> charge{};
+
+  bool has_fired(int neuron_idx) const;
+  static uint8 quantize_charge(int state, int threshold);
+};
+
+/*
+ * Activity Feed
+ *
+ * Sends activity frames from the audio thread to the editor without locking.
+ * There is one writer (the audio thread, once per tick) and one reader (the
+ * editor, at its own frame rate), sharing a fixed ring of frames through an
+ * AbstractFifo.
+ *
+ * The writer never waits. When the ring is full the tick is folded into a
+ * pending frame, keeping every neuron that fired and the latest charges, and
+ * that frame is sent once the reader has made room. Only the neurons in use
+ * are copied, so a tick costs a few bytes per neuron.
+ */
+
+class ActivityFeed {
+public:
+  ActivityFeed();
+  ~ActivityFeed();
+
+  static constexpr int capacity{32};
+
+  // Audio Thread
+  void write_tick(Brain &brain);
+
+  // GUI Thread
+  bool read(ActivityFrame &activity, FiringHistory *history = nullptr);
+
+private:
+  AbstractFifo fifo;
+  std::vector<ActivityFrame> frames;
+  ActivityFrame pending;
+
+  static void copy_frame(const ActivityFrame &source,
+                         ActivityFrame &destination);
+  static int num_firing_words(int num_neurons);
+
+  JUCE_DECLARE_NON_COPYABLE(ActivityFeed)
+};
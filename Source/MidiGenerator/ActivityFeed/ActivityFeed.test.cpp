@@ -0,0 +1,132 @@
+/*
+ * ActivityFeed.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "ActivityFeed.hpp"
+#include "../../Utils/AllocationCounter.hpp"
+
+class ActivityFeedTests : public UnitTest {
+public:
+  ActivityFeedTests() : UnitTest("ActivityFeed Testing") {}
+
+  void runTest() override {
+    // == quantize_charge ==
+    beginTest("quantize_charge");
+
+    expect(ActivityFrame::quantize_charge(0, 10) == 0, "empty should be 0");
+    expect(ActivityFrame::quantize_charge(5, 10) == 127, "half way");
+    expect(ActivityFrame::quantize_charge(20, 10) == ActivityFrame::full_charge,
+           "over the threshold should be full");
+    expect(ActivityFrame::quantize_charge(-5, 10) == 0,
+           "negative states should be empty");
+    expect(ActivityFrame::quantize_charge(1, 0) == ActivityFrame::full_charge,
+           "over a zero threshold should be full");
+    expect(ActivityFrame::quantize_charge(-3, -2) == 0,
+           "under a negative threshold should be empty");
+
+    Brain brain(3);
+    brain.set_input_weights(std::vector<int>{1, 1, 1});
+    brain.set_threshold_for_neuron(0, 5);
+    brain.set_threshold_for_neuron(1, 10);
+    brain.set_threshold_for_neuron(2, 1000);
+    std::vector<int> input{10, 5, 0};
+
+    ActivityFeed feed;
+    ActivityFrame activity;
+
+    // == write_tick, read ==
+    beginTest("write_tick / read");
+
+    expect(!feed.read(activity), "nothing has been written");
+
+    brain.process_next(input);
+    feed.write_tick(brain);
+    expect(feed.read(activity), "a tick has been written");
+    expect(activity.num_neurons == 3, "wrong number of neurons");
+    expect(activity.num_ticks == 1, "the frame should be for one tick");
+    expect(activity.has_fired(0), "neuron 0 should have fired");
+    expect(!activity.has_fired(1), "neuron 1 should not have fired");
+    expect(activity.charge[0] == ActivityFrame::full_charge,
+           "neuron 0 should be fully charged");
+    expect(activity.charge[1] == 127, "neuron 1 should be half charged");
+    expect(activity.charge[2] == 0, "neuron 2 should be empty");
+    expect(!feed.read(activity), "the tick has already been read");
+
+    beginTest("read - ticks are combined");
+
+    brain.set_threshold_for_neuron(0, 1000);
+    brain.set_threshold_for_neuron(1, -1000);
+    brain.process_next(input);
+    feed.write_tick(brain);
+    brain.set_threshold_for_neuron(1, 1000);
+    brain.process_next(input);
+    feed.write_tick(brain);
+    feed.read(activity);
+    expect(activity.has_fired(1), "neuron 1 fired on one of the ticks");
+    expect(!activity.has_fired(0), "neuron 0 didn't fire");
+    expect(activity.charge[1] == ActivityFrame::quantize_charge(
+                                     brain.get_state_for_neuron(1), 1000),
+           "charges should be the latest");
+
+    beginTest("write_tick - a full feed keeps the ticks until there's room");
+
+    for (int i = 0; i < ActivityFeed::capacity - 1; ++i) {
+      brain.process_next(input);
+      feed.write_tick(brain);
+    }
+    brain.set_threshold_for_neuron(2, -1000);
+    brain.process_next(input);
+    feed.write_tick(brain);
+    brain.set_threshold_for_neuron(2, 1000);
+
+    feed.read(activity);
+    expect(!activity.has_fired(2), "the overflowing tick should be pending");
+    brain.process_next(input);
+    feed.write_tick(brain);
+    feed.read(activity);
+    expect(activity.has_fired(2), "the overflowing tick should not be lost");
+    expect(activity.num_ticks == 2,
+           "the frame should cover the tick folded into it");
+
+    beginTest("write_tick - neurons added");
+
+    brain.add_neuron();
+    brain.set_threshold_for_neuron(3, -1000);
+    input.push_back(0);
+    brain.process_next(input);
+    feed.write_tick(brain);
+    feed.read(activity);
+    expect(activity.num_neurons == 4, "the new neuron should be sent");
+    expect(activity.has_fired(3), "the new neuron should have fired");
+
+    beginTest("write_tick - charge is against the morphed threshold");
+
+    Brain morphed(1);
+    morphed.set_input_weights(std::vector<int>{1});
+    morphed.set_threshold_for_neuron(0, 1000);
+    morphed.set_morphed_thresholds(std::vector<int>{20});
+    morphed.process_next(std::vector<int>{10});
+    ActivityFeed morph_feed;
+    morph_feed.write_tick(morphed);
+    morph_feed.read(activity);
+    expect(activity.charge[0] == 127,
+           "the charge should be against the threshold played");
+
+    beginTest("write_tick doesn't allocate");
+
+    int num_allocations{0};
+    {
+      AllocationCounter counter;
+      for (int i = 0; i < 2 * ActivityFeed::capacity; ++i) {
+        feed.write_tick(brain);
+      }
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "writing a tick should not allocate");
+  };
+};
+
+static ActivityFeedTests test;
@@ -0,0 +1,69 @@
+/*
+ * FiringHistory.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "FiringHistory.hpp"
+
+FiringHistory::FiringHistory() : ticks(max_ticks), num_ticks{0} {}
+FiringHistory::~FiringHistory() {}
+
+// Which tick the neurons in a frame covering several ticks fired on isn't
+// known, so they are drawn on the latest and the ticks before it are empty.
+void FiringHistory::push(const ActivityFrame &frame) {
+  int64 num_empty_ticks = jmax(0, frame.num_ticks - 1);
+  // only the latest max_ticks are kept, the rest are just counted
+  num_ticks += jmax<int64>(0, num_empty_ticks - max_ticks);
+  for (int64 i = jmin<int64>(num_empty_ticks, max_ticks); i > 0; --i) {
+    Tick &empty = ticks[num_ticks % max_ticks];
+    empty.num_neurons = frame.num_neurons;
+    empty.firing.fill(0);
+    ++num_ticks;
+  }
+
+  Tick &tick = ticks[num_ticks % max_ticks];
+  tick.num_neurons = frame.num_neurons;
+  tick.firing = frame.firing;
+  ++num_ticks;
+}
+
+// every tick ever pushed, including those that have since been overwritten
+int64 FiringHistory::get_num_ticks() const { return num_ticks; }
+int FiringHistory::get_num_stored_ticks() const {
+  return static_cast<int>(jmin<int64>(num_ticks, max_ticks));
+}
+
+int FiringHistory::get_num_neurons(int ticks_ago) const {
+  return get_tick(ticks_ago).num_neurons;
+}
+
+bool FiringHistory::has_fired(int ticks_ago, int neuron_idx) const {
+  const Tick &tick = get_tick(ticks_ago);
+  if (neuron_idx >= tick.num_neurons) {
+    return false;
+  }
+  return (tick.firing[neuron_idx / 64] >> (neuron_idx % 64)) & 1;
+}
+
+// The first neuron from `first_neuron` on that fired on the tick, or -1.
+int FiringHistory::next_fired(int ticks_ago, int first_neuron) const {
+  const Tick &tick = get_tick(ticks_ago);
+  for (int i = first_neuron; i < tick.num_neurons; i = (i | 63) + 1) {
+    uint64 word = tick.firing[i / 64] >> (i % 64);
+    if (word != 0) {
+      int neuron_idx = i + __builtin_ctzll(word);
+      return neuron_idx < tick.num_neurons ? neuron_idx : -1;
+    }
+  }
+  return -1;
+}
+
+// Private Methods
+
+// 0 is the latest tick
+const FiringHistory::Tick &FiringHistory::get_tick(int ticks_ago) const {
+  jassert(ticks_ago >= 0 && ticks_ago < get_num_stored_ticks());
+  return ticks[(num_ticks - 1 - ticks_ago) % max_ticks];
+}
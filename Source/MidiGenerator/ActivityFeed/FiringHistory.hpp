@@ -0,0 +1,50 @@
+/*
+ * FiringHistory.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "ActivityFeed.hpp"
+#include <array>
+#include <vector>
+
+/*
+ * Firing History
+ *
+ * Which neurons fired on each of the last `max_ticks` ticks, kept as a ring of
+ * firing bitsets. The ring is allocated once, and pushing a tick overwrites
+ * the oldest one, so keeping a history costs the same however long it runs.
+ * A frame covering several ticks moves the history on by all of them, so it
+ * keeps time with the song even when the feed has fallen behind.
+ */
+
+class FiringHistory {
+public:
+  FiringHistory();
+  ~FiringHistory();
+
+  static constexpr int max_ticks{512};
+
+  void push(const ActivityFrame &frame);
+
+  int64 get_num_ticks() const;
+  int get_num_stored_ticks() const;
+  int get_num_neurons(int ticks_ago) const;
+  bool has_fired(int ticks_ago, int neuron_idx) const;
+  int next_fired(int ticks_ago, int first_neuron) const;
+
+private:
+  struct Tick {
+    int num_neurons{0};
+    std::array<uint64, ActivityFrame::max_neurons / 64> firing{};
+  };
+
+  std::vector<Tick> ticks;
+  int64 num_ticks;
+
+  const Tick &get_tick(int ticks_ago) const;
+};
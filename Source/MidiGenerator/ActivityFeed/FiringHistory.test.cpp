@@ -0,0 +1,120 @@
+/*
+ * FiringHistory.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "FiringHistory.hpp"
+#include "../../Utils/AllocationCounter.hpp"
+
+class FiringHistoryTests : public UnitTest {
+public:
+  FiringHistoryTests() : UnitTest("FiringHistory Testing") {}
+
+  void runTest() override {
+    FiringHistory history;
+    ActivityFrame frame;
+    frame.num_neurons = 70;
+
+    // == push ==
+    beginTest("push");
+
+    expect(history.get_num_ticks() == 0, "history should start empty");
+
+    frame.firing[0] = 1;              // neuron 0
+    frame.firing[1] = uint64{1} << 5; // neuron 69
+    history.push(frame);
+    frame.firing.fill(0);
+    frame.firing[0] = 2; // neuron 1
+    history.push(frame);
+
+    expect(history.get_num_ticks() == 2, "two ticks have been pushed");
+    expect(history.get_num_stored_ticks() == 2, "two ticks should be stored");
+    expect(history.has_fired(0, 1), "neuron 1 fired on the latest tick");
+    expect(!history.has_fired(0, 0), "neuron 0 didn't fire on the latest tick");
+    expect(history.has_fired(1, 0), "neuron 0 fired the tick before");
+    expect(history.has_fired(1, 69), "neuron 69 fired the tick before");
+    expect(!history.has_fired(1, 100), "neuron 100 doesn't exist");
+    expect(history.get_num_neurons(1) == 70, "wrong number of neurons");
+
+    beginTest("push - the oldest ticks are overwritten");
+
+    frame.firing.fill(0);
+    int num_allocations{0};
+    {
+      AllocationCounter counter;
+      for (int i = 0; i < FiringHistory::max_ticks; ++i) {
+        history.push(frame);
+      }
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "pushing a tick should not allocate");
+    expect(history.get_num_ticks() == FiringHistory::max_ticks + 2,
+           "every tick should be counted");
+    expect(history.get_num_stored_ticks() == FiringHistory::max_ticks,
+           "only max_ticks should be stored");
+    expect(!history.has_fired(FiringHistory::max_ticks - 1, 1),
+           "the old ticks should have been overwritten");
+
+    beginTest("push - frames covering several ticks");
+
+    frame.firing.fill(0);
+    frame.firing[1] = uint64{1} << 2; // neuron 66
+    frame.num_ticks = 3;
+    int64 ticks_before = history.get_num_ticks();
+    history.push(frame);
+    expect(history.get_num_ticks() == ticks_before + 3,
+           "the history should move on by every tick in the frame");
+    expect(history.has_fired(0, 66), "the firing should be on the latest");
+    expect(!history.has_fired(1, 66) && !history.has_fired(2, 66),
+           "the ticks before should be empty");
+
+    frame.num_ticks = 3 * FiringHistory::max_ticks;
+    ticks_before = history.get_num_ticks();
+    history.push(frame);
+    expect(history.get_num_ticks() == ticks_before + frame.num_ticks,
+           "ticks that can't be stored should still be counted");
+    expect(history.has_fired(0, 66) &&
+               !history.has_fired(FiringHistory::max_ticks - 1, 66),
+           "only the latest tick should have fired");
+    frame.num_ticks = 1;
+
+    // == next_fired ==
+    beginTest("next_fired");
+
+    frame.firing.fill(0);
+    frame.firing[0] = (uint64{1} << 3) | (uint64{1} << 63); // neurons 3, 63
+    frame.firing[1] = uint64{1} << 4;                       // neuron 68
+    history.push(frame);
+    expect(history.next_fired(0, 0) == 3, "neuron 3 fired first");
+    expect(history.next_fired(0, 4) == 63, "neuron 63 fired next");
+    expect(history.next_fired(0, 64) == 68, "neuron 68 fired after that");
+    expect(history.next_fired(0, 69) == -1, "no neurons fired after 68");
+    expect(history.next_fired(1, 0) == 66, "neuron 66 fired the tick before");
+
+    // == ActivityFeed::read ==
+    beginTest("ActivityFeed::read pushes every tick");
+
+    Brain brain(2);
+    brain.set_input_weights(std::vector<int>{1, 1});
+    brain.set_threshold_for_neuron(0, -1000);
+    brain.set_threshold_for_neuron(1, 1000);
+    std::vector<int> input{0, 0};
+    ActivityFeed feed;
+    for (int i = 0; i < 3; ++i) {
+      brain.process_next(input);
+      feed.write_tick(brain);
+    }
+    int64 num_ticks = history.get_num_ticks();
+    ActivityFrame activity;
+    feed.read(activity, &history);
+    expect(history.get_num_ticks() == num_ticks + 3,
+           "every tick should be pushed");
+    expect(history.has_fired(0, 0) && history.has_fired(2, 0),
+           "neuron 0 fired on every tick");
+    expect(!history.has_fired(1, 1), "neuron 1 never fired");
+  };
+};
+
+static FiringHistoryTests test;
@@ -10,6 +10,9 @@
 BeatClock::BeatClock() {
   subdivision = 1;
   _is_configured = false;
+  _follows_ppq = false;
+  block_tick = 0;
+  prepare(44100);
 };
 BeatClock::~BeatClock(){};
 
@@ -17,8 +20,18 @@ BeatClock::~BeatClock(){};
  * Getters
  */
 
+int BeatClock::get_max_ticks_per_block(double sample_rate, int block_size) {
+  double min_samples_per_tick =
+      ((60.0 / max_bpm) / max_subdivision) * sample_rate;
+  if (min_samples_per_tick < 1) {
+    return block_size;
+  }
+  return static_cast<int>(std::ceil(block_size / min_samples_per_tick)) + 1;
+}
+
 int BeatClock::get_subdivision() { return subdivision; }
 bool BeatClock::is_configured() { return _is_configured; }
+bool BeatClock::follows_ppq() { return _follows_ppq; }
 float BeatClock::get_samples_per_subdivision() {
   return samples_per_subdivision;
 }
@@ -34,12 +47,38 @@ void BeatClock::set_subdivision(int new_subdiv) { subdivision = new_subdiv; }
  * Public Methods
  */
 
+void BeatClock::prepare(double sample_rate) {
+  prepared_sample_rate = sample_rate;
+  samples_per_minute = 60.0 * sample_rate;
+}
+
+// Ticks are counted in the host's beats where it gives them, so they stay put
+// when the tempo changes. A host that doesn't (it leaves the beat position at
+// 0 once it has moved from the start) has them counted in samples at the
+// block's tempo.
 void BeatClock::configure(double sample_rate, const posinfo &pos) {
+  if (sample_rate != prepared_sample_rate) {
+    prepare(sample_rate);
+  }
   float bpm = (float)pos.bpm;
-  double current_sample_num = (double)pos.timeInSamples;
   samples_per_subdivision = get_samples_per_subdivision(bpm, sample_rate);
-  sample_num_remainder =
-      get_sample_num_remainder(samples_per_subdivision, current_sample_num);
+  _follows_ppq = pos.ppqPosition != 0 || pos.timeInSamples == 0;
+  double start_tick;
+  if (_follows_ppq) {
+    start_tick = pos.ppqPosition * subdivision;
+  } else {
+    start_tick = pos.timeInSamples / (double)samples_per_subdivision;
+  }
+  double tick = std::floor(start_tick);
+  double remainder = (start_tick - tick) * samples_per_subdivision;
+  // a beat position from the host is rounded, so one a hair before a tick is
+  // taken as on it
+  if (samples_per_subdivision - remainder < tick_tolerance) {
+    tick += 1;
+    remainder = 0;
+  }
+  block_tick = static_cast<int64>(tick);
+  sample_num_remainder = static_cast<float>(remainder);
   _is_configured = true;
 }
 
@@ -53,6 +92,17 @@ bool BeatClock::should_play(int buffer_sample_num) {
   }
 }
 
+// The number of the tick at (or just before) the sample, counting from the
+// start of the song. A tick plays less than a sample after its start, so half
+// a sample is added to keep rounding from putting it in the tick before.
+int64 BeatClock::get_tick(int buffer_sample_num) {
+  assert(_is_configured);
+  return block_tick +
+         static_cast<int64>(
+             std::floor((sample_num_remainder + buffer_sample_num + 0.5) /
+                        samples_per_subdivision));
+}
+
 void BeatClock::reset() { _is_configured = false; }
 
 /*
@@ -60,10 +110,6 @@ void BeatClock::reset() { _is_configured = false; }
  */
 
 float BeatClock::get_samples_per_subdivision(float bpm, double sample_rate) {
-  return ((60.0 / bpm) / (float)subdivision) * sample_rate;
-}
-
-float BeatClock::get_sample_num_remainder(float samples_per_subdivision,
-                                          double current_sample_num) {
-  return fmod(current_sample_num, samples_per_subdivision);
+  assert(sample_rate == prepared_sample_rate);
+  return samples_per_minute / (bpm * subdivision);
 }
@@ -16,24 +16,38 @@ public:
   BeatClock();
   ~BeatClock();
 
+  // the fastest the clock is expected to tick, used to size audio buffers
+  static constexpr float max_bpm{999.0f};
+  static constexpr int max_subdivision{256};
+  static int get_max_ticks_per_block(double sample_rate, int block_size);
+
   int get_subdivision();
   bool is_configured();
+  bool follows_ppq();
   float get_samples_per_subdivision();
   float get_sample_num_remainder();
 
   void set_subdivision(int new_subdivision);
 
+  void prepare(double sample_rate);
   void configure(double sample_rate, const posinfo &pos);
   bool should_play(int buffer_sample_num);
+  int64 get_tick(int buffer_sample_num);
   void reset();
 
 private:
+  // how close (in samples) to a tick the block can start and be on it
+  static constexpr double tick_tolerance{0.001};
+
   int subdivision;
   bool _is_configured;
+  bool _follows_ppq;
   float samples_per_subdivision;
   float sample_num_remainder;
+  double prepared_sample_rate;
+  // the tick the block starts in
+  int64 block_tick;
+  double samples_per_minute;
 
   float get_samples_per_subdivision(float bpm, double sample_rate);
-  float get_sample_num_remainder(float samples_per_subdivision,
-                                 double current_sample_num);
 };
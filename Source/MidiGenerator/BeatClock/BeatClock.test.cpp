@@ -128,6 +128,54 @@ public:
     expect(!clock.should_play(1830), "clock shouldn't play on sample 1830");
     expect(!clock.should_play(1831), "clock shouldn't play on sample 1831");
 
+    // == prepare ==
+    beginTest("prepare");
+
+    clock.set_subdivision(1);
+    clock.prepare(48000);
+    pos.bpm = 120;
+    clock.configure(48000, pos);
+    expectWithinAbsoluteError<float>(clock.get_samples_per_subdivision(),
+                                     24000.0, 0.01,
+                                     "samples_per_subdivision is not correct");
+    clock.configure(sample_rate, pos);
+    expectWithinAbsoluteError<float>(clock.get_samples_per_subdivision(),
+                                     22050.0, 0.01,
+                                     "a new sample rate should be prepared");
+
+    expect(BeatClock::get_max_ticks_per_block(44100, 512) == 51,
+           "wrong max ticks per block");
+
+    // == get_tick ==
+    beginTest("get_tick");
+
+    // a tick is 22050 samples
+    pos.timeInSamples = 22050 * 3 - 10;
+    clock.configure(sample_rate, pos);
+    expect(clock.get_tick(0) == 2, "should be in the tick before");
+    expect(clock.should_play(10) && clock.get_tick(10) == 3,
+           "a tick that plays should have its own number");
+    expect(clock.get_tick(511) == 3, "should still be in the same tick");
+
+    beginTest("get_tick - counts the host's beats");
+
+    // the samples played don't match the beats at this tempo, as after a
+    // tempo change
+    clock.set_subdivision(4);
+    pos.bpm = 90;
+    pos.timeInSamples = 12345;
+    pos.ppqPosition = 10.0 - 1e-12;
+    clock.configure(sample_rate, pos);
+    expect(clock.follows_ppq(), "the clock should follow the beats");
+    expect(clock.should_play(0) && clock.get_tick(0) == 40,
+           "a beat a hair away should be on the tick");
+    expect(clock.should_play(7350) && clock.get_tick(7350) == 41,
+           "the next tick should be a sixteenth later");
+    pos.ppqPosition = 0;
+    clock.configure(sample_rate, pos);
+    expect(!clock.follows_ppq() && clock.get_tick(0) == 12345 / 7350,
+           "without beats the clock should count samples");
+
     // == reset ==
     beginTest("reset");
     clock.reset();
@@ -0,0 +1,114 @@
+/*
+ * BrainCheckpoints.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "BrainCheckpoints.hpp"
+
+namespace {
+constexpr int64 no_tick{-1};
+}
+
+BrainCheckpoints::BrainCheckpoints()
+    : max_neurons{0}, next_slot{0}, is_invalid{false} {}
+BrainCheckpoints::BrainCheckpoints(const BrainCheckpoints &other)
+    : max_neurons{other.max_neurons}, next_slot{other.next_slot},
+      checkpoints(other.checkpoints), states(other.states),
+      is_invalid{other.is_invalid.load()} {}
+BrainCheckpoints::~BrainCheckpoints() {}
+
+/*
+ * Getters
+ */
+
+int BrainCheckpoints::get_capacity() {
+  return static_cast<int>(checkpoints.size());
+}
+
+int BrainCheckpoints::get_num_checkpoints() {
+  return static_cast<int>(
+      std::count_if(checkpoints.begin(), checkpoints.end(),
+                    [](const Checkpoint &c) { return c.tick != no_tick; }));
+}
+
+bool BrainCheckpoints::has_checkpoint(int64 tick) { return find(tick) >= 0; }
+
+/*
+ * Methods
+ */
+
+// Called off the audio thread. Any checkpoints are cleared.
+void BrainCheckpoints::prepare(int neurons, int capacity) {
+  jassert(capacity > 0);
+  max_neurons = neurons;
+  checkpoints.assign(static_cast<size_t>(capacity), {no_tick, 0});
+  states.assign(static_cast<size_t>(capacity) * max_neurons, 0);
+  next_slot = 0;
+}
+
+// A brain bigger than the checkpoints were prepared for isn't recorded.
+void BrainCheckpoints::record(int64 tick, Brain &brain) {
+  clear_if_invalid();
+  int n = brain.num_neurons();
+  if (checkpoints.empty() || n > max_neurons) {
+    return;
+  }
+  int slot = find(tick);
+  if (slot < 0) {
+    slot = next_slot;
+    next_slot = (next_slot + 1) % get_capacity();
+  }
+  checkpoints[slot] = {tick, n};
+  int *slot_states = &states[static_cast<size_t>(slot) * max_neurons];
+  for (int i = 0; i < n; ++i) {
+    slot_states[i] = brain.get_state_for_neuron(i);
+  }
+}
+
+// Returns false, leaving the brain alone, if there's no checkpoint for the
+// tick or it was recorded with a different number of neurons.
+bool BrainCheckpoints::restore(int64 tick, Brain &brain) {
+  clear_if_invalid();
+  int slot = find(tick);
+  if (slot < 0 || checkpoints[slot].num_neurons != brain.num_neurons()) {
+    return false;
+  }
+  const int *slot_states = &states[static_cast<size_t>(slot) * max_neurons];
+  for (int i = 0; i < checkpoints[slot].num_neurons; ++i) {
+    brain.set_state_for_neuron(i, slot_states[i]);
+  }
+  return true;
+}
+
+void BrainCheckpoints::clear() {
+  std::fill(checkpoints.begin(), checkpoints.end(), Checkpoint{no_tick, 0});
+  next_slot = 0;
+}
+
+// Called on the message thread when the parameters change. The checkpoints
+// are cleared by the next record or restore.
+void BrainCheckpoints::invalidate() { is_invalid = true; }
+
+/*
+ * Private Methods
+ */
+
+int BrainCheckpoints::find(int64 tick) {
+  if (tick == no_tick) {
+    return -1;
+  }
+  for (int slot = 0; slot < get_capacity(); ++slot) {
+    if (checkpoints[slot].tick == tick) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+void BrainCheckpoints::clear_if_invalid() {
+  if (is_invalid.exchange(false)) {
+    clear();
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * BrainCheckpoints.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../WellNeurons/Brain.hpp"
+#include <atomic>
+#include <vector>
+
+/*
+ * Brain Checkpoints
+ *
+ * A ring of the brain's neuron states, each recorded at the start of a tick
+ * and keyed by the tick's number from the start of the song. When the host
+ * loops or jumps back, the generator restores the checkpoint at the start of
+ * the bar and steps forward to the tick it has jumped to, so each pass of a
+ * loop plays what the first pass played.
+ *
+ * Recording a tick that already has a checkpoint overwrites it, so a loop
+ * keeps using the same slots. Otherwise the oldest checkpoint is replaced.
+ * The weights aren't recorded - they are the parameters - so a checkpoint is
+ * only good while they stay the same. Whenever the parameters change, the
+ * generator invalidates the checkpoints on the message thread, and they are
+ * cleared on the audio thread the next time they are used. A change made
+ * while looping is heard straight away, and a loop repeats again once its
+ * bars have been recorded with the new parameters.
+ *
+ * Everything is reserved by prepare, so recording and restoring can be done
+ * on the audio thread.
+ */
+
+class BrainCheckpoints {
+public:
+  BrainCheckpoints();
+  BrainCheckpoints(const BrainCheckpoints &other);
+  ~BrainCheckpoints();
+
+  static constexpr int default_capacity{64};
+
+  // Getters
+  int get_capacity();
+  int get_num_checkpoints();
+  bool has_checkpoint(int64 tick);
+
+  // Methods
+  void prepare(int neurons, int capacity = default_capacity);
+  void record(int64 tick, Brain &brain);
+  bool restore(int64 tick, Brain &brain);
+  void clear();
+  void invalidate();
+
+private:
+  struct Checkpoint {
+    int64 tick;
+    int num_neurons;
+  };
+
+  int max_neurons;
+  int next_slot;
+  std::vector<Checkpoint> checkpoints;
+  // max_neurons states for each checkpoint
+  std::vector<int> states;
+  // set by invalidate, on any thread
+  std::atomic<bool> is_invalid;
+
+  int find(int64 tick);
+  void clear_if_invalid();
+};
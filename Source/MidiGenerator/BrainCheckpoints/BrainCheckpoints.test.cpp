@@ -0,0 +1,91 @@
+/*
+ * BrainCheckpoints.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "BrainCheckpoints.hpp"
+
+class BrainCheckpointsTests : public UnitTest {
+public:
+  BrainCheckpointsTests() : UnitTest("BrainCheckpoints Testing") {}
+
+  void runTest() override {
+    Brain brain(3);
+    brain.set_input_weights(std::vector<int>{1, 2, 3});
+    std::vector<int> input{1, 1, 1};
+    BrainCheckpoints checkpoints;
+
+    // == record / restore ==
+    beginTest("record / restore");
+
+    checkpoints.prepare(4, 2);
+    expect(checkpoints.get_capacity() == 2 &&
+               checkpoints.get_num_checkpoints() == 0,
+           "prepared checkpoints should be empty");
+    expect(!checkpoints.restore(0, brain),
+           "there should be nothing to restore");
+
+    checkpoints.record(16, brain);
+    brain.process_next(input);
+    brain.process_next(input);
+    expect(brain.get_state_for_neuron(2) == 6, "the brain should have moved");
+    expect(checkpoints.restore(16, brain), "the checkpoint should restore");
+    for (int i = 0; i < 3; ++i) {
+      expect(brain.get_state_for_neuron(i) == 0,
+             "the states should be as they were recorded");
+    }
+
+    beginTest("record - overwrites the same tick");
+
+    brain.process_next(input);
+    checkpoints.record(16, brain);
+    expect(checkpoints.get_num_checkpoints() == 1,
+           "recording a tick again shouldn't take another slot");
+    brain.process_next(input);
+    checkpoints.restore(16, brain);
+    expect(brain.get_state_for_neuron(2) == 3,
+           "the checkpoint should hold the latest recording");
+
+    beginTest("record - replaces the oldest");
+
+    checkpoints.record(32, brain);
+    checkpoints.record(48, brain);
+    expect(checkpoints.get_num_checkpoints() == 2, "the ring should be full");
+    expect(!checkpoints.has_checkpoint(16) && checkpoints.has_checkpoint(32) &&
+               checkpoints.has_checkpoint(48),
+           "the oldest checkpoint should have been replaced");
+
+    beginTest("restore - needs the same neurons");
+
+    Brain bigger(4);
+    expect(!checkpoints.restore(32, bigger),
+           "a checkpoint shouldn't restore into a different sized brain");
+    Brain too_big(5);
+    checkpoints.record(64, too_big);
+    expect(!checkpoints.has_checkpoint(64),
+           "a brain bigger than prepared for shouldn't be recorded");
+
+    beginTest("clear");
+
+    checkpoints.clear();
+    expect(checkpoints.get_num_checkpoints() == 0 &&
+               !checkpoints.restore(32, brain),
+           "cleared checkpoints should be empty");
+
+    beginTest("invalidate");
+
+    checkpoints.record(32, brain);
+    checkpoints.invalidate();
+    expect(checkpoints.get_num_checkpoints() == 1,
+           "checkpoints should be kept until they're next used");
+    expect(!checkpoints.restore(32, brain),
+           "an invalidated checkpoint shouldn't restore");
+    checkpoints.record(32, brain);
+    expect(checkpoints.restore(32, brain),
+           "checkpoints recorded afterwards should restore");
+  };
+};
+
+static BrainCheckpointsTests test;
@@ -0,0 +1,148 @@
+/*
+ * BrainMorph.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "BrainMorph.hpp"
+
+// amounts are interpolated in 16.16 fixed point, so that rounding is exact
+// and the same on every platform
+static constexpr int fixed_point_bits{16};
+static constexpr int64 fixed_point_one{int64{1} << fixed_point_bits};
+
+// nothing has been written yet
+static constexpr float not_written{-1.0f};
+
+BrainMorph::BrainMorph()
+    : n{0}, amount{0.0f}, writing_amount{not_written}, next_row{0},
+      written_amount{not_written} {}
+BrainMorph::BrainMorph(const BrainMorph &other)
+    : n{other.n}, input_weights_a(other.input_weights_a),
+      input_weights_b(other.input_weights_b),
+      thresholds_a(other.thresholds_a), thresholds_b(other.thresholds_b),
+      connection_weights_a(other.connection_weights_a),
+      connection_weights_b(other.connection_weights_b), row(other.row),
+      amount{other.amount}, writing_amount{not_written}, next_row{0},
+      written_amount{not_written} {}
+BrainMorph::~BrainMorph() {}
+
+/*
+ * Getters & Setters
+ */
+
+bool BrainMorph::is_active() { return n > 0; }
+int BrainMorph::num_neurons() { return n; }
+
+float BrainMorph::get_amount() { return amount; }
+// Audio thread - just records the amount, which apply writes over the next
+// ticks.
+void BrainMorph::set_amount(float new_amount) {
+  amount = jlimit(0.0f, 1.0f, new_amount);
+}
+
+bool BrainMorph::is_settled() { return written_amount == amount; }
+
+/*
+ * Methods
+ */
+
+// Called off the audio thread. Returns false, leaving the morph off, if the
+// states aren't the same size.
+bool BrainMorph::set_states(const EngineSnapshot &a, const EngineSnapshot &b) {
+  clear();
+  if (a.num_neurons() != b.num_neurons() || a.num_neurons() == 0) {
+    return false;
+  }
+  n = a.num_neurons();
+  input_weights_a = a.input_weights;
+  input_weights_b = b.input_weights;
+  thresholds_a = a.thresholds;
+  thresholds_b = b.thresholds;
+  flatten(a, connection_weights_a);
+  flatten(b, connection_weights_b);
+  row.assign(n, 0);
+  return true;
+}
+
+void BrainMorph::clear() {
+  n = 0;
+  input_weights_a.clear();
+  input_weights_b.clear();
+  thresholds_a.clear();
+  thresholds_b.clear();
+  connection_weights_a.clear();
+  connection_weights_b.clear();
+  row.clear();
+  writing_amount = not_written;
+  written_amount = not_written;
+}
+
+// Audio thread - called before each tick. Writes up to `max_rows` rows of
+// connection weights for the current amount, after the input weights and
+// thresholds. Does nothing once the amount has been written in full, or if
+// the brain is no longer the size of the states. Returns whether anything was
+// written.
+bool BrainMorph::apply(Brain &brain, int max_rows) {
+  if (n == 0 || brain.num_neurons() != n || is_settled()) {
+    return false;
+  }
+  if (writing_amount != amount) {
+    writing_amount = amount;
+    next_row = -1;
+  }
+  int64 fixed_amount = to_fixed_point(writing_amount);
+
+  if (next_row == -1) {
+    lerp(input_weights_a.data(), input_weights_b.data(), fixed_amount,
+         row.data(), n);
+    brain.set_morphed_input_weights(row);
+    lerp(thresholds_a.data(), thresholds_b.data(), fixed_amount, row.data(),
+         n);
+    brain.set_morphed_thresholds(row);
+    next_row = 0;
+  }
+
+  for (int rows = 0; rows < max_rows && next_row < n; ++rows, ++next_row) {
+    int offset = next_row * n;
+    lerp(connection_weights_a.data() + offset,
+         connection_weights_b.data() + offset, fixed_amount, row.data(), n);
+    brain.set_morphed_connection_weights_from(next_row, row);
+  }
+  if (next_row == n) {
+    written_amount = writing_amount;
+  }
+  return true;
+}
+
+// destination[i] = a[i] + (b[i] - a[i]) * amount, rounded half up, with
+// `amount` in 16.16 fixed point. A plain loop with no branches, so it is
+// vectorised.
+void BrainMorph::lerp(const int *a, const int *b, int64 amount,
+                      int *destination, int size) {
+  constexpr int64 half{fixed_point_one / 2};
+  for (int i = 0; i < size; ++i) {
+    int64 difference = static_cast<int64>(b[i]) - a[i];
+    destination[i] = static_cast<int>(
+        a[i] + ((difference * amount + half) >> fixed_point_bits));
+  }
+}
+
+int64 BrainMorph::to_fixed_point(float amount) {
+  return static_cast<int64>(std::round(amount * fixed_point_one));
+}
+
+/*
+ * Private Methods
+ */
+
+void BrainMorph::flatten(const EngineSnapshot &state,
+                         std::vector<int> &weights) {
+  int size = state.num_neurons();
+  weights.resize(size * size);
+  for (int from = 0; from < size; ++from) {
+    const std::vector<int> &source = state.get_connection_row(from);
+    std::copy(source.begin(), source.end(), weights.begin() + (from * size));
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * BrainMorph.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../EngineSnapshot/EngineSnapshot.hpp"
+#include "../WellNeurons/Brain.hpp"
+#include <vector>
+
+/*
+ * Brain Morph
+ *
+ * Morphs the brain between two states, A and B, taken from snapshots of the
+ * same sized network. At an amount of 0 the input weights, thresholds and
+ * connection weights are A's, at 1 they are B's, and in between each is
+ * linearly interpolated and rounded to the nearest whole number. The values
+ * are written as the brain's morph (see Brain), which it plays in place of
+ * its own, never into the weight blocks it may share with a copy.
+ *
+ * The morph only changes what is played. The generator's parameters - what
+ * the editor shows, what is saved and what undo goes back to - stay as they
+ * are. A fast forward plays the morph at the amount it was requested with,
+ * and as the weights played change with the amount, the generator drops its
+ * loop checkpoints whenever a new amount is written.
+ *
+ * Both states are stored as flat arrays, so interpolating a row is a single
+ * loop over contiguous ints the compiler can vectorise. Nothing is written
+ * until the amount changes, and then the new values are written a few rows
+ * per tick, so a large network is morphed over several ticks rather than all
+ * at once. If the amount changes again part way through, the rows are written
+ * again from the start with the latest amount. A copy starts writing again
+ * too, as the copy of the brain it morphs doesn't have the morph.
+ */
+
+class BrainMorph {
+public:
+  BrainMorph();
+  BrainMorph(const BrainMorph &other);
+  ~BrainMorph();
+
+  // connection rows written per tick
+  static constexpr int default_rows_per_tick{16};
+
+  // Getters & Setters
+  bool is_active();
+  int num_neurons();
+  float get_amount();
+  void set_amount(float amount);
+  bool is_settled();
+
+  // Methods
+  bool set_states(const EngineSnapshot &a, const EngineSnapshot &b);
+  void clear();
+  bool apply(Brain &brain, int max_rows);
+
+  static void lerp(const int *a, const int *b, int64 amount, int *destination,
+                   int size);
+  static int64 to_fixed_point(float amount);
+
+private:
+  int n;
+  std::vector<int> input_weights_a, input_weights_b;
+  std::vector<int> thresholds_a, thresholds_b;
+  // n x n, row by row
+  std::vector<int> connection_weights_a, connection_weights_b;
+  // one row of interpolated values, sized with the network
+  std::vector<int> row;
+
+  float amount;
+  // the amount being written, the row to write next (-1 for the input
+  // weights and thresholds) and the amount last written in full
+  float writing_amount;
+  int next_row;
+  float written_amount;
+
+  static void flatten(const EngineSnapshot &state, std::vector<int> &weights);
+};
@@ -0,0 +1,242 @@
+/*
+ * BrainMorph.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "BrainMorph.hpp"
+#include "../../Utils/AllocationCounter.hpp"
+#include "../MidiGenerator.hpp"
+
+class BrainMorphTests : public UnitTest {
+public:
+  BrainMorphTests() : UnitTest("BrainMorph Testing") {}
+
+  void runTest() override {
+    // == lerp ==
+    beginTest("lerp");
+
+    std::vector<int> a{0, 10, -10, 5, 100};
+    std::vector<int> b{10, 0, 10, 6, -100};
+    std::vector<int> result(5);
+
+    BrainMorph::lerp(a.data(), b.data(), BrainMorph::to_fixed_point(0.0f),
+                     result.data(), 5);
+    expect(result == a, "an amount of 0 should give A");
+    BrainMorph::lerp(a.data(), b.data(), BrainMorph::to_fixed_point(1.0f),
+                     result.data(), 5);
+    expect(result == b, "an amount of 1 should give B");
+    BrainMorph::lerp(a.data(), b.data(), BrainMorph::to_fixed_point(0.5f),
+                     result.data(), 5);
+    expect(result == std::vector<int>{5, 5, 0, 6, 0},
+           "halfway should round to the nearest, halves up");
+    BrainMorph::lerp(a.data(), b.data(), BrainMorph::to_fixed_point(0.25f),
+                     result.data(), 5);
+    expect(result == std::vector<int>{3, 8, -5, 5, 50},
+           "a quarter of the way is wrong");
+
+    // == set_states ==
+    beginTest("set_states");
+
+    MidiGenerator generator_a(4);
+    MidiGenerator generator_b(4);
+    for (int i = 0; i < 4; ++i) {
+      generator_a.set_neuron_input_weight(i, 0);
+      generator_b.set_neuron_input_weight(i, 100);
+      generator_a.set_neuron_threshold(i, 10);
+      generator_b.set_neuron_threshold(i, 20);
+      for (int j = 0; j < 4; ++j) {
+        generator_a.set_neuron_connection_weight(i, j, -8);
+        generator_b.set_neuron_connection_weight(i, j, 8);
+      }
+    }
+    auto state_a = generator_a.get_snapshot();
+    auto state_b = generator_b.get_snapshot();
+
+    BrainMorph morph;
+    expect(!morph.is_active(), "the morph should start off");
+    expect(!morph.set_states(*state_a, *MidiGenerator(3).get_snapshot()),
+           "states of different sizes can't be morphed");
+    expect(!morph.is_active(), "the morph should still be off");
+    expect(morph.set_states(*state_a, *state_b), "the states should be set");
+    expect(morph.is_active() && morph.num_neurons() == 4,
+           "the morph should be on");
+
+    // == apply ==
+    beginTest("apply - a few rows per tick");
+
+    Brain brain(4);
+    brain.prepare(4);
+    morph.set_amount(0.5f);
+    int num_allocations{0};
+    {
+      AllocationCounter counter;
+      morph.apply(brain, 2);
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "applying the morph should not allocate");
+    expect(brain.is_morphed(), "the brain should be morphed");
+    expect(brain.get_played_input_weight(3) == 50,
+           "the input weights should be written first");
+    expect(brain.get_played_threshold(0) == 15,
+           "the thresholds should be written first");
+    expect(brain.get_played_connection_weight(1, 3) == 0,
+           "the first rows should be written");
+    expect(brain.get_played_connection_weight(3, 0) == 0 &&
+               brain.get_connection_weight_for_neurons(3, 0) == 0,
+           "the rows not written yet should be the brain's own");
+    expect(!morph.is_settled(), "the morph should be part way through");
+
+    morph.apply(brain, 2);
+    expect(brain.get_played_connection_weight(3, 0) == 0,
+           "the rest of the rows should be written on the next tick");
+    expect(morph.is_settled(), "the morph should be settled");
+
+    beginTest("apply - the brain's own values are left alone");
+
+    expect(brain.get_input_weight_for_neuron(3) == 0 &&
+               brain.get_threshold_for_neuron(0) == 0,
+           "the morph shouldn't change the brain's own values");
+    brain.set_threshold_for_neuron(0, 7);
+    expect(brain.get_played_threshold(0) == 15,
+           "a morphed brain should play the morph's thresholds");
+    brain.clear_morph();
+    expect(brain.get_played_threshold(0) == 7,
+           "a brain should play its own values once the morph is cleared");
+
+    beginTest("apply - nothing is written until the amount changes");
+
+    Brain unmorphed(4);
+    morph.apply(unmorphed, 4);
+    expect(!unmorphed.is_morphed(), "a settled morph shouldn't write anything");
+
+    beginTest("apply - a new amount starts again from the first row");
+
+    morph.set_amount(1.0f);
+    morph.apply(brain, 1);
+    morph.set_amount(0.0f);
+    morph.apply(brain, 4);
+    expect(morph.is_settled(), "the morph should be settled");
+    expect(brain.get_played_connection_weight(0, 0) == -8 &&
+               brain.get_played_input_weight(0) == 0,
+           "every value should be at the latest amount");
+
+    beginTest("apply - blocks shared with a copy aren't copied");
+
+    Brain shared(4);
+    shared.prepare(4);
+    Brain copy(shared);
+    morph.set_amount(1.0f);
+    {
+      AllocationCounter counter;
+      morph.apply(shared, 4);
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "morphing a shared brain should not allocate");
+    expect(shared.shares_connection_weights_from(copy, 0) &&
+               shared.shares_input_weights(copy),
+           "the morph shouldn't copy the shared blocks");
+    expect(!copy.is_morphed() && copy.get_played_input_weight(0) == 0,
+           "the copy shouldn't be morphed");
+
+    beginTest("copy - a copy of a morphed brain plays its own values");
+
+    Brain morphed_copy(shared);
+    expect(!morphed_copy.is_morphed() &&
+               morphed_copy.get_played_threshold(0) == 0,
+           "the copy shouldn't take the morph");
+
+    beginTest("apply - a brain of a different size is left alone");
+
+    Brain bigger(5);
+    morph.set_amount(1.0f);
+    morph.apply(bigger, 4);
+    expect(!bigger.is_morphed(),
+           "a different sized brain shouldn't be changed");
+
+    // == MidiGenerator ==
+    beginTest("MidiGenerator - the morph is applied on each tick");
+
+    MidiGenerator generator(*state_a);
+    expect(generator.set_morph_states(*state_a, *state_b),
+           "the generator should take the states");
+    generator.set_morph_amount(1.0f);
+    MidiBuffer buffer;
+    MidiBuffer no_input;
+    AudioPlayHead::CurrentPositionInfo pos;
+    pos.bpm = 120;
+    pos.timeInSamples = 0;
+    generator.toggleOnOff();
+    generator.generate_next_midi_buffer(buffer, no_input, pos, 44100, 64);
+    // A's neurons have no input and never fire, B's fire on the first tick
+    expect(!buffer.isEmpty(), "the brain should play B");
+    expect(generator.get_neuron_connection_weight(2, 2) == -8 &&
+               generator.get_neuron_threshold(0) == 10,
+           "the morph shouldn't change the generator's parameters");
+    auto published = generator.get_snapshot();
+    expect(published->get_connection_row(2) == state_a->get_connection_row(2) &&
+               published->input_weights == state_a->input_weights,
+           "the morph shouldn't be published");
+    generator.clear_morph();
+    expect(!generator.has_morph(), "the morph should be cleared");
+
+    beginTest("MidiGenerator - a fast forward plays the morph");
+
+    // two networks whose neurons fire at different times
+    MidiGenerator network_a(3), network_b(3);
+    for (int i = 0; i < 3; ++i) {
+      network_a.set_neuron_midi_note(i, 60 + i);
+      network_a.set_neuron_input_weight(i, i + 1);
+      network_a.set_neuron_threshold(i, 3 + i);
+      network_b.set_neuron_input_weight(i, 1);
+      network_b.set_neuron_threshold(i, 10 + 2 * i);
+      for (int j = 0; j < 3; ++j) {
+        network_a.set_neuron_connection_weight(i, j, i == j ? -5 : 2 + j);
+        network_b.set_neuron_connection_weight(i, j, i == j ? -8 : -6);
+      }
+    }
+    FastForward fast_forward;
+    fast_forward.set_synchronous(true);
+    auto state_c = network_a.get_snapshot();
+    auto state_d = network_b.get_snapshot();
+    auto make_follower = [&]() {
+      auto follower = std::make_unique<MidiGenerator>(*state_c);
+      follower->set_subdivision(4);
+      follower->toggleFollowsSongPosition();
+      follower->toggleOnOff();
+      follower->set_fast_forward(&fast_forward);
+      follower->set_morph_states(*state_c, *state_d);
+      follower->set_morph_amount(0.5f);
+      return follower;
+    };
+    auto play_from = [&](MidiGenerator &follower, int64 from, int64 record_from,
+                         int64 to) {
+      std::vector<std::pair<int64, int>> notes;
+      MidiBuffer block;
+      MidiMessage m;
+      int time;
+      for (int64 t = from; t < to; t += 512) {
+        block.clear();
+        pos.timeInSamples = t;
+        follower.generate_next_midi_buffer(block, no_input, pos, 44100, 512);
+        for (MidiBuffer::Iterator i(block); i.getNextEvent(m, time);) {
+          if (m.isNoteOn() && t + time >= record_from) {
+            notes.push_back({t + time, m.getNoteNumber()});
+          }
+        }
+      }
+      return notes;
+    };
+    // far enough in for the worker
+    int64 start = static_cast<int64>(300 * 5512.5) - 100;
+    auto from_zero = make_follower();
+    auto jumped = make_follower();
+    auto heard = play_from(*from_zero, 0, start, start + 88200);
+    expect(!heard.empty(), "the morphed follower should have played notes");
+    expect(play_from(*jumped, start, start, start + 88200) == heard,
+           "a jump should play what playing the morph from 0 plays there");
+  };
+};
+
+static BrainMorphTests test;
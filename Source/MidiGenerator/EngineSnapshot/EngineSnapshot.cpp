@@ -0,0 +1,20 @@
+/*
+ * EngineSnapshot.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "EngineSnapshot.hpp"
+
+int EngineSnapshot::num_neurons() const {
+  return static_cast<int>(thresholds.size());
+}
+
+const std::vector<int> &EngineSnapshot::get_connection_row(int from) const {
+  return *connection_weights.at(from);
+}
+
+int EngineSnapshot::get_connection_weight(int from, int to) const {
+  return connection_weights.at(from)->at(to);
+}
@@ -0,0 +1,64 @@
+/*
+ * EngineSnapshot.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../MidiProcessor/MidiProcessor.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+
+/*
+ * Engine Snapshot
+ *
+ * A read-only copy of every parameter of a MidiGenerator. The generator
+ * publishes a new snapshot after each change, and it is only ever handed out
+ * as a pointer to const. Readers keep the snapshot alive for as long as they
+ * hold the pointer, so the UI, logging and saving can read it on any thread
+ * without copying anything or racing with the next change.
+ *
+ * The connection weights are stored one row per pointer. Each snapshot reuses
+ * the rows of the one before that haven't changed, so publishing after a
+ * single weight change copies one row rather than the whole matrix.
+ */
+
+struct EngineSnapshot {
+  using Row = std::shared_ptr<const std::vector<int>>;
+
+  uint32 version{0};
+
+  // Settings
+  bool is_on{false};
+  bool receives_midi{false};
+  bool midi_through{false};
+  bool follows_song_position{false};
+  int subdivision{0};
+  float volume{0.0f};
+  int volume_clip_min{0};
+  int volume_clip_max{0};
+  int max_neuron_output{0};
+  GateLength gate_length;
+  NotePolicy note_policy;
+
+  // Neurons
+  std::vector<int> midi_notes;
+  std::vector<int> midi_channels;
+  std::vector<GateLength> gate_lengths;
+  std::vector<int> input_weights;
+  std::vector<int> thresholds;
+  std::vector<Row> connection_weights;
+  std::vector<uint32> connection_row_versions;
+
+  // MIDI Input
+  std::array<int, 128> input_note_neurons;
+  std::array<int, 128> input_cc_neurons;
+
+  int num_neurons() const;
+  const std::vector<int> &get_connection_row(int from) const;
+  int get_connection_weight(int from, int to) const;
+};
@@ -0,0 +1,170 @@
+/*
+ * FastForward.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "FastForward.hpp"
+
+FastForward::FastForward()
+    : Thread("Wells Fast Forward"), synchronous{false}, following{false},
+      requested_number{0}, requested_tick{0}, requested_neurons{0},
+      requested_midi{false}, requested_morph_amount{0.0f}, worker_busy{false},
+      done_number{0}, result_tick{0}, result_ok{false} {
+  startThread();
+}
+FastForward::~FastForward() { stopThread(1000); }
+
+// Message Thread
+
+// The parameters the next request is worked out with, which the generator
+// sets whenever it publishes a snapshot.
+void FastForward::set_parameters(std::shared_ptr<const EngineSnapshot> state) {
+  bool follows = state != nullptr && state->follows_song_position;
+  {
+    const ScopedLock lock(parameters_lock);
+    parameters = std::move(state);
+  }
+  // the worker sleeps while nothing follows the song
+  if (!following.exchange(follows) && follows) {
+    notify();
+  }
+}
+
+// The generator's morph, if it has one, which it sets along with it.
+void FastForward::set_morph(std::shared_ptr<const BrainMorph> new_morph) {
+  const ScopedLock lock(parameters_lock);
+  morph = std::move(new_morph);
+}
+
+// e.g. while the host renders offline. The worker sleeps while it is, so is
+// woken when it stops being.
+void FastForward::set_synchronous(bool should_be_synchronous) {
+  if (synchronous.exchange(should_be_synchronous) && !should_be_synchronous) {
+    notify();
+  }
+}
+
+// Audio Thread
+
+// Returns the request's number, to take its result with.
+uint32 FastForward::request(int64 tick, int num_neurons, bool receives_midi,
+                            float morph_amount) {
+  requested_tick = tick;
+  requested_neurons = num_neurons;
+  requested_midi = receives_midi;
+  requested_morph_amount = morph_amount;
+  uint32 number = requested_number.load() + 1;
+  requested_number = number;
+
+  // the worker finds it on its next look, waking it would take a lock
+  if (synchronous) {
+    // the worker may be finishing a request made before it was synchronous
+    while (worker_busy.load()) {
+      Thread::yield();
+    }
+    work_out(number);
+  }
+  return number;
+}
+
+// Once the request is worked out, sets the brain's states to those at the
+// start of `tick`. Fails when the parameters had a different number of
+// neurons, as they do while a new generator is being handed over.
+FastForward::Result FastForward::take(uint32 request_number, Brain &brain,
+                                      int64 &tick) {
+  if (done_number.load() != request_number) {
+    return not_ready;
+  }
+  if (!result_ok || static_cast<int>(result_states.size()) !=
+                        brain.num_neurons()) {
+    return failed;
+  }
+  for (int i = 0; i < brain.num_neurons(); ++i) {
+    brain.set_state_for_neuron(i, result_states[i]);
+  }
+  tick = result_tick;
+  return ready;
+}
+
+// Any Thread
+
+// The states of a brain built from `state` after `num_ticks` ticks from the
+// start, with the input it has when nothing is played, playing `morph` (if
+// it's for a network of the same size) at `morph_amount`.
+bool FastForward::run_from_start(const EngineSnapshot &state,
+                                 bool receives_midi, int64 num_ticks,
+                                 std::vector<int> &states,
+                                 const BrainMorph *morph, float morph_amount) {
+  int n = state.num_neurons();
+  if (n == 0 || num_ticks < 0) {
+    return false;
+  }
+  Brain brain(n);
+  brain.set_input_weights(state.input_weights);
+  for (int i = 0; i < n; ++i) {
+    brain.set_threshold_for_neuron(i, state.thresholds[i]);
+    brain.set_connection_weights_from(i, state.get_connection_row(i));
+  }
+  if (morph != nullptr) {
+    BrainMorph played(*morph);
+    played.set_amount(morph_amount);
+    played.apply(brain, n);
+  }
+  brain.fast_forward(std::vector<int>(n, receives_midi ? 0 : 1), num_ticks);
+
+  states.resize(n);
+  for (int i = 0; i < n; ++i) {
+    states[i] = brain.get_state_for_neuron(i);
+  }
+  return true;
+}
+
+/*
+ * Private Methods
+ */
+
+void FastForward::run() {
+  uint32 worked_out{0};
+  while (!threadShouldExit()) {
+    uint32 number = requested_number.load();
+    if (number != worked_out) {
+      // busy is set before synchronous is checked, so a synchronous request
+      // either waits for this or is left to the thread that made it
+      worker_busy = true;
+      if (!synchronous.load()) {
+        work_out(number);
+      }
+      worker_busy = false;
+      worked_out = number;
+    } else if (following.load() && !synchronous.load()) {
+      wait(poll_interval_ms);
+    } else {
+      wait(-1); // until there may be requests to look for
+    }
+  }
+}
+
+void FastForward::work_out(uint32 number) {
+  int64 tick = requested_tick.load();
+  int num_neurons = requested_neurons.load();
+  bool receives_midi = requested_midi.load();
+  float morph_amount = requested_morph_amount.load();
+  if (requested_number.load() != number) {
+    return; // replaced while it was being read, the next one is waiting
+  }
+
+  std::shared_ptr<const EngineSnapshot> state;
+  std::shared_ptr<const BrainMorph> played_morph;
+  {
+    const ScopedLock lock(parameters_lock);
+    state = parameters;
+    played_morph = morph;
+  }
+  result_ok = state != nullptr && state->num_neurons() == num_neurons &&
+              run_from_start(*state, receives_midi, tick, result_states,
+                             played_morph.get(), morph_amount);
+  result_tick = tick;
+  done_number = number;
+}
@@ -0,0 +1,98 @@
+/*
+ * FastForward.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../BrainMorph/BrainMorph.hpp"
+#include "../EngineSnapshot/EngineSnapshot.hpp"
+#include "../WellNeurons/Brain.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * Fast Forward
+ *
+ * Works out, off the audio thread, the state a fresh brain would be in after
+ * playing from the start of the song to a tick, so that a generator following
+ * the song position plays the same at any position however it got there.
+ *
+ * The audio thread requests a tick and carries on with its blocks. A worker
+ * thread builds a brain from the latest parameters (set by the generator on
+ * the message thread whenever it publishes a snapshot) and fast forwards it,
+ * jumping over the ticks where no neuron's output changes. If the generator
+ * has a morph, the brain plays it at the amount the request was made with, as
+ * the generator's brain does. The audio thread takes the states once they're
+ * ready, and steps its brain through the few ticks that have gone by since.
+ *
+ * Waking the worker would take a lock, so it looks for requests every couple
+ * of milliseconds instead, but only while the parameters follow the song
+ * position, as requests aren't made otherwise. The rest of the time it
+ * sleeps until they do.
+ *
+ * There is one request at a time. A new request replaces the one before, and
+ * a result is only taken by the request it was worked out for. When rendering
+ * offline there is no hurry, so requests can be worked out straight away on
+ * the thread that makes them instead, and the worker leaves them alone.
+ */
+
+class FastForward : private Thread {
+public:
+  FastForward();
+  ~FastForward();
+
+  enum Result { not_ready, ready, failed };
+
+  // Message Thread
+  void set_parameters(std::shared_ptr<const EngineSnapshot> state);
+  void set_morph(std::shared_ptr<const BrainMorph> new_morph);
+  void set_synchronous(bool should_be_synchronous);
+
+  // Audio Thread
+  uint32 request(int64 tick, int num_neurons, bool receives_midi,
+                 float morph_amount = 0.0f);
+  Result take(uint32 request_number, Brain &brain, int64 &tick);
+
+  // Any Thread
+  static bool run_from_start(const EngineSnapshot &state, bool receives_midi,
+                             int64 num_ticks, std::vector<int> &states,
+                             const BrainMorph *morph = nullptr,
+                             float morph_amount = 0.0f);
+
+private:
+  CriticalSection parameters_lock;
+  std::shared_ptr<const EngineSnapshot> parameters;
+  std::shared_ptr<const BrainMorph> morph;
+  std::atomic<bool> synchronous;
+  // whether the latest parameters follow the song position
+  std::atomic<bool> following;
+
+  // the request, written by the audio thread before its number
+  std::atomic<uint32> requested_number;
+  std::atomic<int64> requested_tick;
+  std::atomic<int> requested_neurons;
+  std::atomic<bool> requested_midi;
+  std::atomic<float> requested_morph_amount;
+
+  // set while the worker may be working a request out
+  std::atomic<bool> worker_busy;
+
+  // the result, written by the worker before its number
+  std::atomic<uint32> done_number;
+  std::vector<int> result_states;
+  int64 result_tick;
+  bool result_ok;
+
+  // how often the worker looks for a request
+  static constexpr int poll_interval_ms{2};
+
+  void run() override;
+  void work_out(uint32 number);
+
+  JUCE_DECLARE_NON_COPYABLE(FastForward)
+};
@@ -0,0 +1,135 @@
+/*
+ * FastForward.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "FastForward.hpp"
+#include "../MidiGenerator.hpp"
+
+class FastForwardTests : public UnitTest {
+public:
+  FastForwardTests() : UnitTest("FastForward Testing") {}
+
+  void runTest() override {
+    MidiGenerator generator(4);
+    generator.toggleFollowsSongPosition();
+    for (int i = 0; i < 4; ++i) {
+      generator.set_neuron_input_weight(i, i + 1);
+      generator.set_neuron_threshold(i, 10 * i);
+      for (int j = 0; j < 4; ++j) {
+        generator.set_neuron_connection_weight(i, j, i == j ? -6 : 2);
+      }
+    }
+    std::shared_ptr<const EngineSnapshot> state = generator.get_snapshot();
+
+    // the same network, stepped through every tick
+    Brain stepped(4);
+    stepped.set_input_weights(state->input_weights);
+    for (int i = 0; i < 4; ++i) {
+      stepped.set_threshold_for_neuron(i, state->thresholds[i]);
+      stepped.set_connection_weights_from(i, state->get_connection_row(i));
+    }
+    std::vector<int> input(4, 1);
+    for (int t = 0; t < 1000; ++t) {
+      stepped.process_next(input);
+    }
+
+    // == run_from_start ==
+    beginTest("run_from_start");
+
+    std::vector<int> states;
+    expect(FastForward::run_from_start(*state, false, 1000, states),
+           "should fast forward");
+    expect(states.size() == 4, "should have a state for each neuron");
+    bool matches{true};
+    for (int i = 0; i < 4; ++i) {
+      matches = matches && states[i] == stepped.get_state_for_neuron(i);
+    }
+    expect(matches, "should match playing every tick from the start");
+
+    // == request / take ==
+    beginTest("request / take - synchronous");
+
+    FastForward worker;
+    worker.set_parameters(state);
+    worker.set_synchronous(true);
+    Brain brain(4);
+    int64 tick{0};
+    uint32 request = worker.request(1000, 4, false);
+    expect(worker.take(request, brain, tick) == FastForward::ready,
+           "a synchronous request should be ready straight away");
+    expect(tick == 1000 &&
+               brain.get_state_for_neuron(3) == stepped.get_state_for_neuron(3),
+           "the brain should be at the requested tick");
+
+    beginTest("request / take - on the worker thread");
+
+    worker.set_synchronous(false);
+    Brain threaded(4);
+    request = worker.request(1000, 4, false);
+    FastForward::Result result{FastForward::not_ready};
+    for (int i = 0; i < 1000 && result == FastForward::not_ready; ++i) {
+      result = worker.take(request, threaded, tick);
+      if (result == FastForward::not_ready) {
+        Thread::sleep(1);
+      }
+    }
+    expect(result == FastForward::ready, "the worker should have finished");
+    expect(threaded.get_state_for_neuron(2) == stepped.get_state_for_neuron(2),
+           "the worker should give the same states");
+
+    beginTest("take - a replaced request isn't taken");
+
+    worker.set_synchronous(true);
+    uint32 replaced = worker.request(10, 4, false);
+    worker.request(20, 4, false);
+    expect(worker.take(replaced, brain, tick) == FastForward::not_ready,
+           "a replaced request should never be ready");
+
+    beginTest("take - fails for other sized parameters");
+
+    request = worker.request(10, 5, false);
+    expect(worker.take(request, brain, tick) == FastForward::failed,
+           "a request for a different network should fail");
+
+    beginTest("request - synchronous requests are left to their caller");
+
+    // if the worker worked it out as well, it would fail with these
+    request = worker.request(1000, 4, false);
+    worker.set_parameters(MidiGenerator(5).get_snapshot());
+    Thread::sleep(20);
+    Brain synchronous(4);
+    expect(worker.take(request, synchronous, tick) == FastForward::ready,
+           "the worker shouldn't work out a synchronous request again");
+    expect(synchronous.get_state_for_neuron(3) ==
+               stepped.get_state_for_neuron(3),
+           "the caller's result should be kept");
+
+    beginTest("request - the worker sleeps while the song isn't followed");
+
+    FastForward sleeper;
+    EngineSnapshot unfollowed(*state);
+    unfollowed.follows_song_position = false;
+    sleeper.set_parameters(std::make_shared<const EngineSnapshot>(unfollowed));
+    Thread::sleep(20); // the worker has started, and gone to sleep
+    request = sleeper.request(1000, 4, false);
+    Brain asleep(4);
+    Thread::sleep(20);
+    expect(sleeper.take(request, asleep, tick) == FastForward::not_ready,
+           "nothing should look for requests while the song isn't followed");
+    sleeper.set_parameters(state);
+    result = FastForward::not_ready;
+    for (int i = 0; i < 1000 && result == FastForward::not_ready; ++i) {
+      result = sleeper.take(request, asleep, tick);
+      if (result == FastForward::not_ready) {
+        Thread::sleep(1);
+      }
+    }
+    expect(result == FastForward::ready,
+           "the worker should wake once the song is followed");
+  };
+};
+
+static FastForwardTests test;
@@ -0,0 +1,71 @@
+/*
+ * GeneratorHandoff.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "GeneratorHandoff.hpp"
+#include <algorithm>
+
+GeneratorHandoff::GeneratorHandoff(std::unique_ptr<MidiGenerator> first)
+    : num_handoffs{0}, pending{nullptr}, playing_number{0} {
+  entries.push_back(std::make_unique<Entry>(Entry{std::move(first), 0}));
+  playing = entries.back().get();
+}
+GeneratorHandoff::~GeneratorHandoff() {}
+
+// Message Thread
+
+// The generator the editor changes, which the audio thread plays from its
+// next block.
+MidiGenerator *GeneratorHandoff::get_latest() {
+  return entries.back()->generator.get();
+}
+
+void GeneratorHandoff::hand_off(std::unique_ptr<MidiGenerator> next) {
+  entries.push_back(
+      std::make_unique<Entry>(Entry{std::move(next), ++num_handoffs}));
+
+  Entry *skipped = pending.exchange(entries.back().get());
+  if (skipped != nullptr) {
+    // the audio thread never picked this one up, and now it never will
+    entries.erase(std::find_if(entries.begin(), entries.end(),
+                               [skipped](const std::unique_ptr<Entry> &e) {
+                                 return e.get() == skipped;
+                               }));
+  }
+  release_retired();
+}
+
+void GeneratorHandoff::release_retired() {
+  uint32 in_use = playing_number.load();
+  entries.erase(std::remove_if(entries.begin(), entries.end() - 1,
+                               [in_use](const std::unique_ptr<Entry> &e) {
+                                 return e->number < in_use;
+                               }),
+                entries.end() - 1);
+}
+
+int GeneratorHandoff::get_num_generators() {
+  return static_cast<int>(entries.size());
+}
+
+// Audio Thread
+
+MidiGenerator *GeneratorHandoff::get_playing() {
+  return playing->generator.get();
+}
+
+bool GeneratorHandoff::has_pending() { return pending.load() != nullptr; }
+
+// Switches to the generator handed off last, if there is one, and returns the
+// generator that is now playing.
+MidiGenerator *GeneratorHandoff::switch_to_pending() {
+  Entry *next = pending.exchange(nullptr);
+  if (next != nullptr) {
+    playing = next;
+    playing_number.store(next->number);
+  }
+  return get_playing();
+}
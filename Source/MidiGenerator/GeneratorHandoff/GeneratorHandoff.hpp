@@ -0,0 +1,64 @@
+/*
+ * GeneratorHandoff.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../MidiGenerator.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * Generator Handoff
+ *
+ * Owns the MidiGenerators and hands new ones to the audio thread without
+ * locking. A generator is built and prepared off the audio thread (e.g. with
+ * a neuron added, restored from a saved state, or a program from the preset
+ * bank) and handed off. The audio thread switches to it with one atomic
+ * exchange, on the playing generator's next tick, so nothing is built, parsed
+ * or copied on the audio thread.
+ *
+ * The generator being replaced may still be playing, so it is retired rather
+ * than deleted. Each generator is numbered as it is handed off, and the audio
+ * thread publishes the number of the one it is playing. Generators with a
+ * lower number can no longer be reached by the audio thread, so they are
+ * deleted on the next handoff (or release_retired call). A generator that was
+ * replaced before the audio thread ever picked it up is deleted straight away.
+ */
+
+class GeneratorHandoff {
+public:
+  GeneratorHandoff(std::unique_ptr<MidiGenerator> first);
+  ~GeneratorHandoff();
+
+  // Message Thread
+  MidiGenerator *get_latest();
+  void hand_off(std::unique_ptr<MidiGenerator> next);
+  void release_retired();
+  int get_num_generators();
+
+  // Audio Thread
+  MidiGenerator *get_playing();
+  bool has_pending();
+  MidiGenerator *switch_to_pending();
+
+private:
+  struct Entry {
+    std::unique_ptr<MidiGenerator> generator;
+    uint32 number;
+  };
+
+  // oldest first, the last is the latest
+  std::vector<std::unique_ptr<Entry>> entries;
+  uint32 num_handoffs;
+  std::atomic<Entry *> pending;
+  std::atomic<uint32> playing_number;
+  Entry *playing;
+
+  JUCE_DECLARE_NON_COPYABLE(GeneratorHandoff)
+};
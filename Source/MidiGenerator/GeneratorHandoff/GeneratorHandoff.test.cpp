@@ -0,0 +1,73 @@
+/*
+ * GeneratorHandoff.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "GeneratorHandoff.hpp"
+#include "../../Utils/AllocationCounter.hpp"
+
+class GeneratorHandoffTests : public UnitTest {
+public:
+  GeneratorHandoffTests() : UnitTest("GeneratorHandoff Testing") {}
+
+  void runTest() override {
+    auto first = std::make_unique<MidiGenerator>(3);
+    MidiGenerator *first_ptr = first.get();
+    GeneratorHandoff handoff(std::move(first));
+
+    // == get_latest / get_playing ==
+    beginTest("the first generator plays straight away");
+
+    expect(handoff.get_latest() == first_ptr, "first should be the latest");
+    expect(handoff.get_playing() == first_ptr, "first should be playing");
+
+    // == hand_off ==
+    beginTest("hand_off - switched to by the audio thread");
+
+    auto second = std::make_unique<MidiGenerator>(4);
+    MidiGenerator *second_ptr = second.get();
+    handoff.hand_off(std::move(second));
+    expect(handoff.get_latest() == second_ptr,
+           "the editor should see the new generator straight away");
+    expect(handoff.get_num_generators() == 2,
+           "the playing generator should be kept until it is replaced");
+    expect(handoff.has_pending(), "the new generator should be pending");
+    expect(handoff.get_playing() == first_ptr,
+           "the old generator should play until the audio thread switches");
+
+    MidiGenerator *playing{nullptr};
+    int num_allocations{0};
+    {
+      AllocationCounter counter;
+      playing = handoff.switch_to_pending();
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "switching should not allocate");
+    expect(playing == second_ptr, "the new generator should be playing");
+    expect(!handoff.has_pending(), "nothing should be pending");
+
+    handoff.release_retired();
+    expect(handoff.get_num_generators() == 1,
+           "the replaced generator should be released");
+    expect(handoff.get_latest() == second_ptr, "the latest should be kept");
+
+    beginTest("hand_off - generators that never played are released");
+
+    handoff.hand_off(std::make_unique<MidiGenerator>(5));
+    auto fourth = std::make_unique<MidiGenerator>(6);
+    MidiGenerator *fourth_ptr = fourth.get();
+    handoff.hand_off(std::move(fourth));
+    expect(handoff.get_num_generators() == 2,
+           "only the playing and the latest generators should be kept");
+    expect(handoff.switch_to_pending() == fourth_ptr,
+           "the audio thread should skip straight to the latest");
+    handoff.release_retired();
+    expect(handoff.get_num_generators() == 1, "only the latest should remain");
+    expect(handoff.switch_to_pending() == fourth_ptr,
+           "the generator should keep playing until it is replaced");
+  };
+};
+
+static GeneratorHandoffTests test;
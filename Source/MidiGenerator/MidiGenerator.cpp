@@ -6,26 +6,88 @@
  */
 
 #include "MidiGenerator.hpp"
+#include <atomic>
+
+// Versions come from one counter shared by every generator, so a generator
+// that replaces another never reuses a version the editor has already seen.
+static uint32 next_version() {
+  static std::atomic<uint32> counter{0};
+  return ++counter;
+}
 
 MidiGenerator::MidiGenerator(int num_neurons)
-    : is_on{false}, receives_midi{false}, brain(num_neurons),
-      midiProcessor(num_neurons) {}
+    : is_on{false}, receives_midi{false}, midi_through{false},
+      follows_song_position{false},
+      prepared_sample_rate{44100}, prepared_block_size{512},
+      prepared_max_neurons{num_neurons}, brain_input(num_neurons, 1),
+      no_input(num_neurons, 0), connection_row_versions(num_neurons),
+      activity_feed{nullptr}, brain(num_neurons),
+      midiProcessor(num_neurons), midiReceiver(num_neurons),
+      midiScheduler(MidiProcessor::max_note_offs), last_tick{-1},
+      ticks_per_checkpoint{0}, checkpoint_samples_per_tick{0},
+      fast_forward{nullptr}, pending_fast_forward{0} {
+  checkpoints.prepare(num_neurons);
+  touch_all();
+}
+// Builds a generator with every parameter taken from `state`, e.g. a saved
+// state being restored.
+MidiGenerator::MidiGenerator(const EngineSnapshot &state)
+    : MidiGenerator(state.num_neurons()) {
+  apply_state(state);
+}
 MidiGenerator::~MidiGenerator() {}
 
 /*
  * Getters & Setters
  */
 
-void MidiGenerator::toggleOnOff() { is_on = !is_on; };
+void MidiGenerator::toggleOnOff() {
+  is_on = !is_on;
+  touch(settings);
+};
 bool MidiGenerator::get_is_on() { return is_on; };
-void MidiGenerator::toggleReceivesMidi() { receives_midi = receives_midi; };
+void MidiGenerator::toggleReceivesMidi() {
+  receives_midi = !receives_midi;
+  checkpoints.invalidate();
+  touch(settings);
+};
 bool MidiGenerator::get_receives_midi() { return receives_midi; };
+void MidiGenerator::toggleMidiThrough() {
+  midi_through = !midi_through;
+  touch(settings);
+};
+bool MidiGenerator::get_midi_through() { return midi_through; };
+// Takes effect the next time the transport starts or jumps. Bars played
+// before then weren't following the song position, so aren't rewound to.
+void MidiGenerator::toggleFollowsSongPosition() {
+  follows_song_position = !follows_song_position;
+  checkpoints.invalidate();
+  touch(settings);
+};
+bool MidiGenerator::get_follows_song_position() {
+  return follows_song_position;
+};
+// On/off, MIDI in/through and follow belong to the session rather than to a
+// program, so a generator that replaces another takes them from it.
+void MidiGenerator::keep_transport_settings(MidiGenerator &replaced) {
+  is_on = replaced.is_on;
+  receives_midi = replaced.receives_midi;
+  midi_through = replaced.midi_through;
+  follows_song_position = replaced.follows_song_position;
+  touch(settings);
+}
 
 int MidiGenerator::get_subdivision() { return beatClock.get_subdivision(); }
-void MidiGenerator::set_subdivision(int s) { beatClock.set_subdivision(s); }
+void MidiGenerator::set_subdivision(int s) {
+  beatClock.set_subdivision(s);
+  touch(settings);
+}
 
 float MidiGenerator::get_volume() { return midiProcessor.get_global_volume(); };
-void MidiGenerator::set_volume(float v) { midiProcessor.set_global_volume(v); };
+void MidiGenerator::set_volume(float v) {
+  midiProcessor.set_global_volume(v);
+  touch(settings);
+};
 int MidiGenerator::get_volume_clip_min() {
   return midiProcessor.get_volume_clip_min();
 };
@@ -34,7 +96,29 @@ int MidiGenerator::get_volume_clip_max() {
 };
 void MidiGenerator::set_volume_clip(int min, int max) {
   midiProcessor.set_volume_clip(min, max);
+  touch(settings);
 };
+int MidiGenerator::get_max_neuron_output() {
+  return midiProcessor.get_max_brain_output();
+};
+void MidiGenerator::set_max_neuron_output(int max_output) {
+  midiProcessor.set_max_brain_output(max_output);
+  touch(settings);
+};
+GateLength MidiGenerator::get_gate_length() {
+  return midiProcessor.get_gate_length();
+}
+void MidiGenerator::set_gate_length(GateLength gate) {
+  midiProcessor.set_gate_length(gate);
+  touch(settings);
+}
+NotePolicy MidiGenerator::get_note_policy() {
+  return midiProcessor.get_note_policy();
+}
+void MidiGenerator::set_note_policy(NotePolicy policy) {
+  midiProcessor.set_note_policy(policy);
+  touch(settings);
+}
 
 // MIDI Notes
 int MidiGenerator::get_neuron_midi_note(int neuron_idx) {
@@ -42,17 +126,34 @@ int MidiGenerator::get_neuron_midi_note(int neuron_idx) {
 }
 void MidiGenerator::set_neuron_midi_note(int neuron_idx, int new_note_number) {
   midiProcessor.set_note_at(neuron_idx, new_note_number);
+  touch(midi_notes);
+}
+int MidiGenerator::get_neuron_midi_channel(int neuron_idx) {
+  return midiProcessor.get_channel_at(neuron_idx);
+}
+void MidiGenerator::set_neuron_midi_channel(int neuron_idx, int new_channel) {
+  midiProcessor.set_channel_at(neuron_idx, new_channel);
+  touch(midi_notes);
+}
+
+// Gate Length
+GateLength MidiGenerator::get_neuron_gate_length(int neuron_idx) {
+  return midiProcessor.get_gate_length_at(neuron_idx);
+}
+void MidiGenerator::set_neuron_gate_length(int neuron_idx, GateLength gate) {
+  midiProcessor.set_gate_length_at(neuron_idx, gate);
+  touch(midi_notes);
 }
 
 // Input Weight
 int MidiGenerator::get_neuron_input_weight(int neuron_idx) {
-  PluginLogger::logger.log_vec("input weights", brain.get_input_weights());
   return brain.get_input_weight_for_neuron(neuron_idx);
 }
 void MidiGenerator::set_neuron_input_weight(int neuron_idx,
                                             int new_input_weight) {
   brain.set_input_weight_for_neuron(neuron_idx, new_input_weight);
-  PluginLogger::logger.log_vec("input weights", brain.get_input_weights());
+  touch(input_weights);
+  PluginLogger::logger.log_vec("input weights", get_snapshot()->input_weights);
 }
 
 // Threshold
@@ -61,11 +162,8 @@ int MidiGenerator::get_neuron_threshold(int neuron_idx) {
 }
 void MidiGenerator::set_neuron_threshold(int neuron_idx, int new_threshold) {
   brain.set_threshold_for_neuron(neuron_idx, new_threshold);
-  std::vector<int> thresholds(num_neurons(), 0);
-  std::vector<Neuron> neurons = brain.get_neurons();
-  std::transform(neurons.begin(), neurons.end(), thresholds.begin(),
-                 [](Neuron n) { return n.get_threshold(); });
-  PluginLogger::logger.log_vec("thresholds", thresholds);
+  touch(thresholds);
+  PluginLogger::logger.log_vec("thresholds", get_snapshot()->thresholds);
 }
 
 // Connection Weights
@@ -75,48 +173,474 @@ int MidiGenerator::get_neuron_connection_weight(int from, int to) {
 void MidiGenerator::set_neuron_connection_weight(int from, int to,
                                                  int new_connection_weight) {
   brain.set_connection_weight_for_neurons(from, to, new_connection_weight);
+  touch_connection_row(from);
   PluginLogger::logger.log_vec("Connection weights from " + String(from),
-                               brain.get_connection_weights().at(from));
+                               get_snapshot()->get_connection_row(from));
+}
+
+// MIDI Input
+int MidiGenerator::get_input_note_neuron(int note) {
+  return midiReceiver.get_note_neuron(note);
+}
+void MidiGenerator::set_input_note_neuron(int note, int neuron_idx) {
+  midiReceiver.set_note_neuron(note, neuron_idx);
+  touch(settings);
+}
+int MidiGenerator::get_input_cc_neuron(int cc) {
+  return midiReceiver.get_cc_neuron(cc);
+}
+void MidiGenerator::set_input_cc_neuron(int cc, int neuron_idx) {
+  midiReceiver.set_cc_neuron(cc, neuron_idx);
+  touch(settings);
+}
+
+// Parameter Versions
+uint32 MidiGenerator::get_version(ParameterGroup group) {
+  return versions.at(group);
+}
+uint32 MidiGenerator::get_connection_row_version(int from) {
+  return connection_row_versions.at(from);
 }
 
+// Snapshot
+std::shared_ptr<const EngineSnapshot> MidiGenerator::get_snapshot() {
+  return std::atomic_load(&snapshot);
+}
+
+// Sets every parameter from `state`, which must have as many neurons as the
+// generator, leaving the neurons' states alone. Rows of connection weights
+// the state shares with the current snapshot are already in place, so only
+// the rows that differ are written. Nothing is published until the end, so a
+// large network is set in one pass.
+void MidiGenerator::apply_state(const EngineSnapshot &state) {
+  int n = num_neurons();
+  jassert(state.num_neurons() == n);
+  std::shared_ptr<const EngineSnapshot> current = get_snapshot();
+
+  is_on = state.is_on;
+  receives_midi = state.receives_midi;
+  midi_through = state.midi_through;
+  follows_song_position = state.follows_song_position;
+  beatClock.set_subdivision(state.subdivision);
+  midiProcessor.set_global_volume(state.volume);
+  midiProcessor.set_volume_clip(state.volume_clip_min, state.volume_clip_max);
+  midiProcessor.set_max_brain_output(state.max_neuron_output);
+  midiProcessor.set_gate_length(state.gate_length);
+  midiProcessor.set_note_policy(state.note_policy);
+
+  for (int i = 0; i < n; ++i) {
+    midiProcessor.set_note_at(i, state.midi_notes[i]);
+    midiProcessor.set_channel_at(i, state.midi_channels[i]);
+    midiProcessor.set_gate_length_at(i, state.gate_lengths[i]);
+    brain.set_input_weight_for_neuron(i, state.input_weights[i]);
+    brain.set_threshold_for_neuron(i, state.thresholds[i]);
+  }
+  for (int from = 0; from < n; ++from) {
+    if (current->connection_weights.at(from) ==
+        state.connection_weights.at(from)) {
+      continue;
+    }
+    brain.set_connection_weights_from(from, state.get_connection_row(from));
+    connection_row_versions.at(from) = next_version();
+  }
+
+  for (int i = 0; i < 128; ++i) {
+    midiReceiver.set_note_neuron(i, state.input_note_neurons[i]);
+    midiReceiver.set_cc_neuron(i, state.input_cc_neurons[i]);
+  }
+  for (uint32 &version : versions) {
+    version = next_version();
+  }
+  checkpoints.invalidate();
+  publish_snapshot();
+}
+
+// Morph
+bool MidiGenerator::set_morph_states(const EngineSnapshot &a,
+                                     const EngineSnapshot &b) {
+  checkpoints.invalidate();
+  bool is_set = brainMorph.set_states(a, b);
+  publish_morph();
+  return is_set;
+}
+void MidiGenerator::clear_morph() {
+  checkpoints.invalidate();
+  brainMorph.clear();
+  brain.clear_morph();
+  publish_morph();
+}
+bool MidiGenerator::has_morph() { return brainMorph.is_active(); }
+
 /*
  * Neuron Model Methods
  */
 
 int MidiGenerator::num_neurons() { return brain.num_neurons(); };
 
+// Whether the row is the same block of weights in both, as it is in a copy
+// until one of them changes it.
+bool MidiGenerator::shares_connection_weights_from(MidiGenerator &other,
+                                                   int from) {
+  return brain.shares_connection_weights_from(other.brain, from);
+}
+
 void MidiGenerator::add_neuron() {
   brain.add_neuron();
   midiProcessor.add_midi_note(1);
+  midiReceiver.add_neuron();
+  brain_input.push_back(1);
+  no_input.push_back(0);
+  connection_row_versions.push_back(0);
+  touch_all();
 }
 void MidiGenerator::remove_neuron() {
   brain.remove_neuron();
   midiProcessor.remove_midi_note();
+  midiReceiver.remove_neuron();
+  brain_input.pop_back();
+  no_input.pop_back();
+  connection_row_versions.pop_back();
+  touch_all();
 }
 void MidiGenerator::remove_neuron_at(int index) {
   brain.remove_neuron_at(index);
   midiProcessor.remove_midi_note_at(index);
+  midiReceiver.remove_neuron_at(index);
+  brain_input.erase(brain_input.begin() + index);
+  no_input.erase(no_input.begin() + index);
+  connection_row_versions.erase(connection_row_versions.begin() + index);
+  touch_all();
 }
 
 /*
  * Audio Thread
  */
 
+// Called before playback starts (off the audio thread) to reserve everything
+// the generator needs, so that generating MIDI never resizes anything.
+void MidiGenerator::prepare(double sample_rate, int max_block_size,
+                            int max_neurons) {
+  prepared_sample_rate = sample_rate;
+  prepared_block_size = max_block_size;
+  prepared_max_neurons = jmax(max_neurons, num_neurons());
+
+  brain.prepare(prepared_max_neurons);
+  midiProcessor.prepare(sample_rate, prepared_max_neurons);
+  midiReceiver.prepare(prepared_max_neurons);
+  beatClock.prepare(sample_rate);
+  brain_input.reserve(prepared_max_neurons);
+  no_input.reserve(prepared_max_neurons);
+  checkpoints.prepare(prepared_max_neurons);
+}
+
+// Worst case size of one block of MIDI: every neuron retriggering (note off +
+// note on) on every tick, plus the scheduled note offs and a flush.
+int MidiGenerator::get_max_midi_buffer_bytes() {
+  int max_ticks = BeatClock::get_max_ticks_per_block(prepared_sample_rate,
+                                                     prepared_block_size);
+  int max_neurons = jmax(prepared_max_neurons, num_neurons());
+  int max_events = (2 * max_neurons * max_ticks) + max_neurons + 16;
+  return max_events * MidiProcessor::bytes_per_event;
+}
+
+// Generates the block from `start_sample` on, which is only after the start
+// when this generator takes over from another part way through the block.
 void MidiGenerator::generate_next_midi_buffer(
-    MidiBuffer &midiBuffer, const AudioPlayHead::CurrentPositionInfo &pos,
-    double sample_rate, int num_samples) {
+    MidiBuffer &midiBuffer, const MidiBuffer &midi_input,
+    const AudioPlayHead::CurrentPositionInfo &pos, double sample_rate,
+    int num_samples, int start_sample) {
+
+  // the host has jumped (looped, relocated etc.) so anything still scheduled
+  // belongs to the old position
+  int64 start_time = pos.timeInSamples + start_sample;
+  if (start_time != midiScheduler.get_current_time()) {
+    midiScheduler.flush(midiBuffer, start_sample);
+    midiScheduler.reset(start_time);
+  }
 
   beatClock.configure(sample_rate, pos);
+  midiProcessor.configure(sample_rate, beatClock.get_samples_per_subdivision());
+  configure_checkpoints(pos);
+  midiReceiver.start_block(receives_midi);
+  MidiBuffer::Iterator input_events(midi_input);
 
-  for (int time = 0; time < num_samples; ++time) {
+  for (int time = start_sample; time < num_samples; ++time) {
     if (beatClock.should_play(time)) {
-      brain.process_next(std::vector<int>(num_neurons(), 1));
-      std::vector<int> output = brain.get_output();
-      PluginLogger::logger.log_vec("model output", output);
+      // events due on this tick go out before the tick's own notes
+      midiScheduler.render_buffer(midiBuffer, pos.timeInSamples, time + 1);
+
+      int64 tick = beatClock.get_tick(time);
+      if (tick != last_tick + 1) {
+        jump_to(tick);
+      }
+      last_tick = tick;
+      if (pending_fast_forward != 0 && !catch_up(tick)) {
+        continue; // silent until the brain has caught up with the song
+      }
+      if (tick >= 0 && tick % ticks_per_checkpoint == 0) {
+        checkpoints.record(tick, brain);
+      }
 
-      midiProcessor.render_buffer(midiBuffer, output, time);
+      if (brainMorph.apply(brain, BrainMorph::default_rows_per_tick)) {
+        // the bars recorded were played with other weights
+        checkpoints.clear();
+      }
+      if (receives_midi) {
+        midiReceiver.read_events(input_events, time + 1);
+        brain.process_next(midiReceiver.get_input());
+        midiReceiver.clear_input();
+      } else {
+        brain.process_next(brain_input);
+      }
+      if (activity_feed != nullptr) {
+        activity_feed->write_tick(brain);
+      }
+      const std::vector<int> &output = brain.get_output_levels();
+      if (PluginLogger::logger.is_logging()) {
+        PluginLogger::logger.log_vec("model output", output);
+      }
+
+      midiProcessor.render_buffer(midiBuffer, midiScheduler, output,
+                                  pos.timeInSamples, time);
     }
   }
 
+  // anything after the last tick excites the first tick of the next block
+  if (receives_midi) {
+    midiReceiver.read_events(input_events, MidiReceiver::end_of_block);
+  }
+  midiScheduler.render_buffer(midiBuffer, pos.timeInSamples, num_samples);
   beatClock.reset();
 };
+
+void MidiGenerator::flush_scheduled_midi(MidiBuffer &midiBuffer) {
+  midiScheduler.flush(midiBuffer, 0);
+}
+
+// The sample of the first tick in the block, or `num_samples` if the clock
+// doesn't tick in this block.
+int MidiGenerator::get_next_tick(const AudioPlayHead::CurrentPositionInfo &pos,
+                                 double sample_rate, int num_samples) {
+  beatClock.configure(sample_rate, pos);
+  int time{0};
+  while (time < num_samples && !beatClock.should_play(time)) {
+    ++time;
+  }
+  beatClock.reset();
+  return time;
+}
+
+// Called when another generator takes over at `sample_num`. Events scheduled
+// before then still play, and every note still held is ended there.
+void MidiGenerator::stop_at(MidiBuffer &midiBuffer,
+                            const AudioPlayHead::CurrentPositionInfo &pos,
+                            int sample_num) {
+  if (pos.timeInSamples == midiScheduler.get_current_time()) {
+    midiScheduler.render_buffer(midiBuffer, pos.timeInSamples, sample_num);
+  }
+  midiScheduler.flush(midiBuffer, sample_num);
+}
+
+// Each tick's activity is written to the feed for the editor to show. The
+// feed is owned elsewhere, so copies of the generator keep writing to it.
+void MidiGenerator::set_activity_feed(ActivityFeed *feed) {
+  activity_feed = feed;
+}
+
+// The worker that fast forwards the brain when following the song position,
+// shared by every generator. It's given the parameters with each snapshot.
+void MidiGenerator::set_fast_forward(FastForward *worker) {
+  fast_forward = worker;
+  publish_morph();
+  if (fast_forward != nullptr) {
+    fast_forward->set_parameters(get_snapshot());
+  }
+}
+
+// The morph amount comes from an automatable parameter, so it is set on the
+// audio thread before each block. The brain follows it over the next ticks.
+void MidiGenerator::set_morph_amount(float amount) {
+  brainMorph.set_amount(amount);
+}
+
+/*
+ * Private Methods
+ */
+
+// The brain plays differently once its weights or thresholds change, so the
+// states recorded for loops and jumps are no good.
+void MidiGenerator::touch(ParameterGroup group) {
+  if (group == input_weights || group == thresholds ||
+      group == connection_weights) {
+    checkpoints.invalidate();
+  }
+  versions.at(group) = next_version();
+  publish_snapshot();
+}
+void MidiGenerator::touch_connection_row(int from) {
+  connection_row_versions.at(from) = next_version();
+  touch(connection_weights);
+}
+// the number of neurons changed, so every control needs refreshing
+void MidiGenerator::touch_all() {
+  for (uint32 &version : versions) {
+    version = next_version();
+  }
+  for (uint32 &version : connection_row_versions) {
+    version = next_version();
+  }
+  checkpoints.invalidate();
+  publish_snapshot();
+}
+
+// Called on the message thread after every change. Rows of connection weights
+// whose version hasn't changed are shared with the previous snapshot.
+void MidiGenerator::publish_snapshot() {
+  std::shared_ptr<const EngineSnapshot> previous = get_snapshot();
+  auto next = std::make_shared<EngineSnapshot>();
+  int n = num_neurons();
+
+  next->version = next_version();
+  next->is_on = is_on;
+  next->receives_midi = receives_midi;
+  next->midi_through = midi_through;
+  next->follows_song_position = follows_song_position;
+  next->subdivision = beatClock.get_subdivision();
+  next->volume = midiProcessor.get_global_volume();
+  next->volume_clip_min = midiProcessor.get_volume_clip_min();
+  next->volume_clip_max = midiProcessor.get_volume_clip_max();
+  next->max_neuron_output = midiProcessor.get_max_brain_output();
+  next->gate_length = midiProcessor.get_gate_length();
+  next->note_policy = midiProcessor.get_note_policy();
+
+  next->input_weights = brain.get_input_weights();
+  for (int i = 0; i < n; ++i) {
+    next->midi_notes.push_back(midiProcessor.get_note_at(i));
+    next->midi_channels.push_back(midiProcessor.get_channel_at(i));
+    next->gate_lengths.push_back(midiProcessor.get_gate_length_at(i));
+    next->thresholds.push_back(brain.get_threshold_for_neuron(i));
+  }
+
+  bool can_share_rows = previous != nullptr && previous->num_neurons() == n;
+  for (int from = 0; from < n; ++from) {
+    if (can_share_rows && previous->connection_row_versions.at(from) ==
+                              connection_row_versions.at(from)) {
+      next->connection_weights.push_back(previous->connection_weights[from]);
+      continue;
+    }
+    auto row = std::make_shared<std::vector<int>>(n);
+    for (int to = 0; to < n; ++to) {
+      row->at(to) = brain.get_connection_weight_for_neurons(from, to);
+    }
+    next->connection_weights.push_back(std::move(row));
+  }
+  next->connection_row_versions = connection_row_versions;
+
+  for (int i = 0; i < 128; ++i) {
+    next->input_note_neurons[i] = midiReceiver.get_note_neuron(i);
+    next->input_cc_neurons[i] = midiReceiver.get_cc_neuron(i);
+  }
+
+  std::atomic_store(&snapshot,
+                    std::shared_ptr<const EngineSnapshot>(std::move(next)));
+  if (fast_forward != nullptr) {
+    fast_forward->set_parameters(get_snapshot());
+  }
+}
+
+// The fast forward worker plays the morph as the brain does. Called on the
+// message thread when the morph is set or cleared.
+void MidiGenerator::publish_morph() {
+  if (fast_forward == nullptr) {
+    return;
+  }
+  if (brainMorph.is_active()) {
+    fast_forward->set_morph(std::make_shared<const BrainMorph>(brainMorph));
+  } else {
+    fast_forward->set_morph(nullptr);
+  }
+}
+
+// Checkpoints are a bar apart. Tick numbers depend on the subdivision, and on
+// the tempo when the host gives no beat position and they're counted in
+// samples, so the checkpoints are cleared when either changes.
+void MidiGenerator::configure_checkpoints(
+    const AudioPlayHead::CurrentPositionInfo &pos) {
+  int64 bar_ticks = static_cast<int64>(beatClock.get_subdivision()) *
+                    jmax(1, pos.timeSigNumerator);
+  float samples_per_tick =
+      beatClock.follows_ppq() ? 0 : beatClock.get_samples_per_subdivision();
+  if (bar_ticks != ticks_per_checkpoint ||
+      samples_per_tick != checkpoint_samples_per_tick) {
+    checkpoints.clear();
+    ticks_per_checkpoint = bar_ticks;
+    checkpoint_samples_per_tick = samples_per_tick;
+  }
+}
+
+const std::vector<int> &MidiGenerator::get_idle_input() {
+  return receives_midi ? no_input : brain_input;
+}
+
+// The host has looped, jumped or started playing somewhere new. A bar that has
+// been played is rewound to. Otherwise, when following the song position, the
+// brain is put in the state it would have reached playing from the start:
+// straight away near the start, otherwise by the fast forward worker, while
+// the generator stays silent.
+void MidiGenerator::jump_to(int64 tick) {
+  pending_fast_forward = 0;
+  if (rewind_to(tick) || !follows_song_position || tick < 0) {
+    return;
+  }
+  if (tick <= max_inline_ticks) {
+    for (int i = 0; i < num_neurons(); ++i) {
+      brain.set_state_for_neuron(i, 0);
+    }
+    brain.fast_forward(get_idle_input(), tick);
+  } else if (fast_forward != nullptr) {
+    pending_fast_forward =
+        fast_forward->request(tick, num_neurons(), receives_midi,
+                              brainMorph.get_amount());
+  }
+}
+
+// The host has looped or jumped. If the bar with the tick in it has been
+// played with the parameters as they are, the brain goes back to its state at
+// the start of the bar and steps forward to the tick with no input played, so
+// it plays what it played there before. The MIDI played into the bar isn't
+// recorded, so with MIDI in on only a jump to the start of a bar is rewound.
+// Otherwise it carries on from where it is.
+bool MidiGenerator::rewind_to(int64 tick) {
+  if (tick < 0) {
+    return false;
+  }
+  int64 bar_start = tick - (tick % ticks_per_checkpoint);
+  if ((receives_midi && tick != bar_start) ||
+      !checkpoints.restore(bar_start, brain)) {
+    return false;
+  }
+  brain.fast_forward(get_idle_input(), tick - bar_start);
+  return true;
+}
+
+// Whether the brain is at `tick`, taking the fast forward once it's ready
+// and stepping through the ticks that went by while it was worked out. If it
+// couldn't be worked out, or the song is no longer followed (so the worker
+// may not look for it), the brain carries on from where it is.
+bool MidiGenerator::catch_up(int64 tick) {
+  if (!follows_song_position) {
+    pending_fast_forward = 0;
+    return true;
+  }
+  int64 from{0};
+  FastForward::Result result =
+      fast_forward->take(pending_fast_forward, brain, from);
+  if (result == FastForward::not_ready) {
+    return false;
+  }
+  pending_fast_forward = 0;
+  if (result == FastForward::ready) {
+    brain.fast_forward(get_idle_input(), tick - from);
+  }
+  return true;
+}
@@ -9,21 +9,38 @@
 
 #include "../../JuceLibraryCode/JuceHeader.h"
 #include "../Utils/PluginLogger.hpp"
+#include "ActivityFeed/ActivityFeed.hpp"
 #include "BeatClock/BeatClock.hpp"
+#include "BrainCheckpoints/BrainCheckpoints.hpp"
+#include "BrainMorph/BrainMorph.hpp"
+#include "EngineSnapshot/EngineSnapshot.hpp"
+#include "FastForward/FastForward.hpp"
 #include "MidiProcessor/MidiProcessor.hpp"
+#include "MidiReceiver/MidiReceiver.hpp"
+#include "MidiScheduler/MidiScheduler.hpp"
 #include "WellNeurons/Brain.hpp"
+#include <array>
 #include <memory>
 
 class MidiGenerator {
 public:
   MidiGenerator(int num_neurons);
+  MidiGenerator(const EngineSnapshot &state);
   ~MidiGenerator();
 
+  // the largest network the generator reserves room for by default
+  static constexpr int default_max_neurons{64};
+
   // Getters & Setters - mostly called on the GUI thread
   void toggleOnOff();
   bool get_is_on();
   void toggleReceivesMidi();
   bool get_receives_midi();
+  void toggleMidiThrough();
+  bool get_midi_through();
+  void toggleFollowsSongPosition();
+  bool get_follows_song_position();
+  void keep_transport_settings(MidiGenerator &replaced);
 
   int get_subdivision();
   void set_subdivision(int s);
@@ -33,9 +50,19 @@ public:
   int get_volume_clip_min();
   int get_volume_clip_max();
   void set_volume_clip(int min, int max);
+  int get_max_neuron_output();
+  void set_max_neuron_output(int max_output);
+  GateLength get_gate_length();
+  void set_gate_length(GateLength gate);
+  NotePolicy get_note_policy();
+  void set_note_policy(NotePolicy policy);
 
   int get_neuron_midi_note(int neuron_idx);
   void set_neuron_midi_note(int neuron_idx, int new_note_number);
+  int get_neuron_midi_channel(int neuron_idx);
+  void set_neuron_midi_channel(int neuron_idx, int new_channel);
+  GateLength get_neuron_gate_length(int neuron_idx);
+  void set_neuron_gate_length(int neuron_idx, GateLength gate);
   int get_neuron_input_weight(int neuron_idx);
   void set_neuron_input_weight(int neuron_idx, int new_input_weight);
   int get_neuron_threshold(int neuron_idx);
@@ -43,22 +70,97 @@ public:
   int get_neuron_connection_weight(int from, int to);
   void set_neuron_connection_weight(int from, int to,
                                     int new_connection_weight);
+  int get_input_note_neuron(int note);
+  void set_input_note_neuron(int note, int neuron_idx);
+  int get_input_cc_neuron(int cc);
+  void set_input_cc_neuron(int cc, int neuron_idx);
+
+  // Parameter Versions - bumped by every setter so the editor can tell which
+  // groups of controls need refreshing without reading every value
+  enum ParameterGroup {
+    settings,
+    midi_notes,
+    input_weights,
+    thresholds,
+    connection_weights,
+    num_parameter_groups
+  };
+  uint32 get_version(ParameterGroup group);
+  uint32 get_connection_row_version(int from);
+
+  // Snapshot - a read-only copy of the parameters, safe to read on any thread
+  std::shared_ptr<const EngineSnapshot> get_snapshot();
+  void apply_state(const EngineSnapshot &state);
+
+  // Morph - between two states of the network, played over the parameters
+  // without changing them, see BrainMorph. Set on a copy before it is handed
+  // to the audio thread.
+  bool set_morph_states(const EngineSnapshot &a, const EngineSnapshot &b);
+  void clear_morph();
+  bool has_morph();
 
   // Neuron Model Methods
   int num_neurons();
   void add_neuron();
   void remove_neuron();
   void remove_neuron_at(int index);
+  bool shares_connection_weights_from(MidiGenerator &other, int from);
 
   // Audio Thread
-  void generate_next_midi_buffer(MidiBuffer &b,
+  void prepare(double sample_rate, int max_block_size, int max_neurons);
+  int get_max_midi_buffer_bytes();
+  void generate_next_midi_buffer(MidiBuffer &b, const MidiBuffer &midi_input,
                                  const AudioPlayHead::CurrentPositionInfo &pos,
-                                 double sample_rate, int num_samples);
+                                 double sample_rate, int num_samples,
+                                 int start_sample = 0);
+  void flush_scheduled_midi(MidiBuffer &b);
+  int get_next_tick(const AudioPlayHead::CurrentPositionInfo &pos,
+                    double sample_rate, int num_samples);
+  void stop_at(MidiBuffer &b, const AudioPlayHead::CurrentPositionInfo &pos,
+               int sample_num);
+  void set_activity_feed(ActivityFeed *feed);
+  void set_fast_forward(FastForward *worker);
+  void set_morph_amount(float amount);
 
 private:
-  bool is_on, receives_midi;
+  bool is_on, receives_midi, midi_through, follows_song_position;
+  double prepared_sample_rate;
+  int prepared_block_size, prepared_max_neurons;
+  std::vector<int> brain_input;
+  // the input when MIDI In is on and nothing has been played
+  std::vector<int> no_input;
+  std::array<uint32, num_parameter_groups> versions;
+  std::vector<uint32> connection_row_versions;
+  ActivityFeed *activity_feed;
+  std::shared_ptr<const EngineSnapshot> snapshot;
 
   Brain brain;
+  BrainMorph brainMorph;
   MidiProcessor midiProcessor;
+  MidiReceiver midiReceiver;
   BeatClock beatClock;
+  MidiScheduler midiScheduler;
+
+  // Loops & Jumps - a checkpoint is recorded at the start of every bar
+  BrainCheckpoints checkpoints;
+  int64 last_tick;
+  int64 ticks_per_checkpoint;
+  float checkpoint_samples_per_tick;
+
+  // Song Position - when following it, a jump to a bar that hasn't been
+  // played is fast forwarded from the start of the song
+  FastForward *fast_forward;
+  uint32 pending_fast_forward;
+  static constexpr int64 max_inline_ticks{64};
+
+  void touch(ParameterGroup group);
+  void touch_connection_row(int from);
+  void touch_all();
+  void publish_snapshot();
+  void publish_morph();
+  void configure_checkpoints(const AudioPlayHead::CurrentPositionInfo &pos);
+  const std::vector<int> &get_idle_input();
+  void jump_to(int64 tick);
+  bool rewind_to(int64 tick);
+  bool catch_up(int64 tick);
 };
@@ -6,6 +6,8 @@
  */
 
 #include "MidiGenerator.hpp"
+#include "../Utils/AllocationCounter.hpp"
+#include "../Utils/RealtimeChecker.hpp"
 
 class MidiGeneratorTests : public UnitTest {
 public:
@@ -30,15 +32,40 @@ public:
 
     beginTest("toggleReceivesMidi");
 
-    // the component can't currently process midi so this should always be false
-    generator.toggleReceivesMidi();
     expect(!generator.get_receives_midi(),
-           "midi generator should not receive midi");
+           "midi generator should not receive midi by default");
+
+    generator.toggleReceivesMidi();
+    expect(generator.get_receives_midi(), "midi generator should receive midi");
 
     generator.toggleReceivesMidi();
     expect(!generator.get_receives_midi(),
            "midi generator should not receive midi");
 
+    beginTest("toggleMidiThrough");
+
+    expect(!generator.get_midi_through(), "midi through should be off");
+    generator.toggleMidiThrough();
+    expect(generator.get_midi_through(), "midi through should be on");
+    generator.toggleMidiThrough();
+    expect(!generator.get_midi_through(), "midi through should be off");
+
+    beginTest("MIDI input maps - get / set");
+
+    expect(generator.get_input_note_neuron(60) == 0, "C4 should excite 0");
+    expect(generator.get_input_note_neuron(62) == 2, "D4 should excite 2");
+    expect(generator.get_input_note_neuron(63) == MidiReceiver::unmapped,
+           "D#4 should not excite a neuron");
+    generator.set_input_note_neuron(36, 1);
+    expect(generator.get_input_note_neuron(36) == 1, "note map not set");
+    generator.set_input_note_neuron(36, MidiReceiver::unmapped);
+
+    expect(generator.get_input_cc_neuron(1) == MidiReceiver::unmapped,
+           "CCs should not be mapped by default");
+    generator.set_input_cc_neuron(1, 2);
+    expect(generator.get_input_cc_neuron(1) == 2, "cc map not set");
+    generator.set_input_cc_neuron(1, MidiReceiver::unmapped);
+
     // == getters and setters ==
     beginTest("subdivision - get / set");
 
@@ -73,7 +100,42 @@ public:
     expect(generator.get_volume_clip_min() == 1, "vol clip should be 1");
     expect(generator.get_volume_clip_max() == 45, "vol clip should be 45");
 
+    expect(generator.get_max_neuron_output() == 1, "default max output wrong");
+    generator.set_max_neuron_output(16);
+    expect(generator.get_max_neuron_output() == 16, "max output should be 16");
+    generator.set_max_neuron_output(1);
+
+    beginTest("gate length - get / set");
+
+    expect(generator.get_gate_length().unit == GateLength::subdivision_fraction,
+           "default gate length unit is wrong");
+    generator.set_gate_length(GateLength{GateLength::milliseconds, 100});
+    expect(generator.get_gate_length().unit == GateLength::milliseconds,
+           "gate length unit was not set correctly");
+    expectWithinAbsoluteError<float>(generator.get_gate_length().value, 100,
+                                     0.01, "gate length was not set correctly");
+
+    generator.set_neuron_gate_length(1, GateLength{GateLength::ticks, 2});
+    expect(generator.get_neuron_gate_length(1).unit == GateLength::ticks,
+           "neuron gate length unit was not set correctly");
+    expectWithinAbsoluteError<float>(generator.get_neuron_gate_length(1).value,
+                                     2, 0.01,
+                                     "neuron gate length was not set");
+
+    generator.set_gate_length(GateLength{});
+    generator.set_neuron_gate_length(1, GateLength{GateLength::ticks, 0});
+
     // == MIDI getters and setters ==
+    beginTest("note policy - get / set");
+
+    generator.set_note_policy(
+        NotePolicy{NotePolicy::sum_velocity, NotePolicy::hold});
+    expect(generator.get_note_policy().velocity == NotePolicy::sum_velocity,
+           "velocity policy was not set");
+    expect(generator.get_note_policy().repeat == NotePolicy::hold,
+           "repeat policy was not set");
+    generator.set_note_policy(NotePolicy{});
+
     beginTest("midi getters and setters");
 
     expect(generator.get_neuron_midi_note(0) == 1, "default should be 1");
@@ -88,6 +150,11 @@ public:
     expect(generator.get_neuron_midi_note(1) == 74, "midi note should be 74");
     expect(generator.get_neuron_midi_note(2) == 100, "midi note should be 100");
 
+    expect(generator.get_neuron_midi_channel(0) == 1, "default should be 1");
+    generator.set_neuron_midi_channel(0, 16);
+    expect(generator.get_neuron_midi_channel(0) == 16, "channel should be 16");
+    generator.set_neuron_midi_channel(0, 1);
+
     // == Neuron input getters and setters ==
     beginTest("neuron input weights get/set");
 
@@ -253,13 +320,15 @@ public:
     generator.set_neuron_connection_weight(2, 2, -7);
 
     MidiBuffer buffer;
+    MidiBuffer no_input;
     double sample_rate{44100};
     int num_samples{64};
     AudioPlayHead::CurrentPositionInfo pos;
     pos.bpm = 100;
     pos.timeInSamples = 0;
 
-    generator.generate_next_midi_buffer(buffer, pos, sample_rate, num_samples);
+    generator.generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                        num_samples);
 
     expect(buffer.getNumEvents() == 3, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 0,
@@ -273,6 +342,562 @@ public:
       expect(m.getNoteNumber() == expected_notes.at(j),
              "note number is incorrect");
     }
+
+    beginTest("generate_next_midi_buffer host jumps release held notes");
+
+    buffer.clear();
+    pos.timeInSamples = 44100;
+    generator.generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                        num_samples);
+
+    expect(buffer.getNumEvents() == 3, "Wrong number of MIDI events");
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.isNoteOff(), "held notes should have been released");
+      expect(time == 0, "held notes should be released straight away");
+    }
+
+    beginTest("flush_scheduled_midi");
+
+    // make sure every neuron fires
+    generator.set_neuron_threshold(0, -1000);
+    generator.set_neuron_threshold(1, -1000);
+    generator.set_neuron_threshold(2, -1000);
+
+    buffer.clear();
+    pos.timeInSamples = 0;
+    generator.generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                        num_samples);
+    int num_held_notes = buffer.getNumEvents();
+    buffer.clear();
+    generator.flush_scheduled_midi(buffer);
+
+    expect(num_held_notes == 3, "every neuron should have played a note");
+    expect(buffer.getNumEvents() == 3,
+           "held notes should have been released");
+    buffer.clear();
+    generator.flush_scheduled_midi(buffer);
+    expect(buffer.isEmpty(), "nothing should be left to release");
+
+    beginTest("generate_next_midi_buffer holds every note on every channel");
+
+    {
+      // a tick a block, with every note held on a new channel each tick
+      MidiGenerator every_note(128);
+      every_note.set_gate_length({GateLength::ticks, 1000});
+      for (int i = 0; i < 128; ++i) {
+        every_note.set_neuron_midi_note(i, i);
+        every_note.set_neuron_threshold(i, -1000);
+      }
+      AudioPlayHead::CurrentPositionInfo every_pos;
+      every_pos.bpm = 100;
+      int num_note_ons{0};
+      for (int channel = 1; channel <= 16; ++channel) {
+        for (int i = 0; i < 128; ++i) {
+          every_note.set_neuron_midi_channel(i, channel);
+        }
+        buffer.clear();
+        every_pos.timeInSamples = (channel - 1) * 26460;
+        every_note.generate_next_midi_buffer(buffer, no_input, every_pos,
+                                             sample_rate, 26460);
+        for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+          num_note_ons += m.isNoteOn() ? 1 : 0;
+        }
+      }
+      buffer.clear();
+      every_note.flush_scheduled_midi(buffer);
+      int num_note_offs{0}, num_all_notes_offs{0};
+      for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+        num_note_offs += m.isNoteOff() ? 1 : 0;
+        num_all_notes_offs += m.isAllNotesOff() ? 1 : 0;
+      }
+      expect(num_note_ons == 16 * 128, "every note should have been played");
+      expect(num_note_offs == num_note_ons,
+             "every held note should have its own note off");
+      expect(num_all_notes_offs == 0, "no note off should have been dropped");
+    }
+
+    beginTest("get_next_tick");
+
+    // a subdivision is 26460 samples at 100 bpm
+    expect(generator.get_next_tick(pos, sample_rate, num_samples) == 0,
+           "the clock should tick on the first sample");
+    pos.timeInSamples = 26450;
+    expect(generator.get_next_tick(pos, sample_rate, num_samples) == 10,
+           "the clock should tick 10 samples in");
+    pos.timeInSamples = 100;
+    expect(generator.get_next_tick(pos, sample_rate, num_samples) ==
+               num_samples,
+           "the clock shouldn't tick in this block");
+
+    beginTest("generate_next_midi_buffer from a start sample");
+
+    buffer.clear();
+    pos.timeInSamples = 26450;
+    generator.generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                        num_samples, 10);
+    expect(buffer.getNumEvents() == 3, "every neuron should have played");
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(time == 10, "the notes should start on the tick");
+    }
+
+    beginTest("stop_at");
+
+    buffer.clear();
+    pos.timeInSamples += num_samples;
+    generator.stop_at(buffer, pos, 5);
+    expect(buffer.getNumEvents() == 3, "held notes should have been released");
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.isNoteOff() && time == 5,
+             "held notes should be released where the generator stops");
+    }
+    buffer.clear();
+    generator.flush_scheduled_midi(buffer);
+    expect(buffer.isEmpty(), "nothing should be left to release");
+    pos.timeInSamples = 0;
+
+    generator.set_neuron_threshold(0, 0);
+    generator.set_neuron_threshold(1, 0);
+    generator.set_neuron_threshold(2, 0);
+
+    beginTest("generate_next_midi_buffer with MIDI input");
+
+    // only the neuron that is played should fire
+    MidiGenerator listener(3);
+    for (int i = 0; i < 3; ++i) {
+      listener.set_neuron_midi_note(i, expected_notes.at(i));
+      listener.set_neuron_input_weight(i, 1);
+      listener.set_neuron_threshold(i, 50);
+    }
+    listener.toggleReceivesMidi();
+
+    MidiBuffer input;
+    input.addEvent(MidiMessage::noteOn(1, 61, (uint8)100), 0);
+    buffer.clear();
+    pos.timeInSamples = 0;
+    listener.generate_next_midi_buffer(buffer, input, pos, sample_rate,
+                                       num_samples);
+
+    expect(buffer.getNumEvents() == 1, "only one neuron should fire");
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.getNoteNumber() == 64, "the wrong neuron fired");
+    }
+
+    beginTest("generate_next_midi_buffer grades velocity by neuron output");
+
+    // the neurons are 1, 4 and 8 over their thresholds on the first tick
+    std::vector<int> over_threshold{1, 4, 8};
+    auto play_velocities = [&](int max_output) {
+      MidiGenerator graded(3);
+      graded.set_max_neuron_output(max_output);
+      for (int i = 0; i < 3; ++i) {
+        graded.set_neuron_midi_note(i, expected_notes.at(i));
+        graded.set_neuron_threshold(i, -over_threshold.at(i));
+      }
+      std::vector<int> velocities;
+      buffer.clear();
+      pos.timeInSamples = 0;
+      graded.generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                       num_samples);
+      for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+        if (m.isNoteOn()) {
+          velocities.push_back(m.getVelocity());
+        }
+      }
+      return velocities;
+    };
+
+    std::vector<int> velocities = play_velocities(1);
+    expect(velocities.size() == 3, "every neuron should have played");
+    expect(velocities == std::vector<int>(3, 127),
+           "any output plays at full velocity by default");
+
+    velocities = play_velocities(8);
+    expect(velocities.size() == 3, "every neuron should have played");
+    if (velocities.size() == 3) {
+      expect(velocities.at(0) < velocities.at(1) &&
+                 velocities.at(1) < velocities.at(2),
+             "neurons further over their threshold should play louder");
+      expect(velocities.at(2) == 127,
+             "the maximum output should play at full velocity");
+    }
+
+    beginTest("prepare");
+
+    generator.prepare(sample_rate, 512, 3);
+    int bytes_for_3 = generator.get_max_midi_buffer_bytes();
+    generator.prepare(sample_rate, 512, 6);
+    int bytes_for_6 = generator.get_max_midi_buffer_bytes();
+    generator.prepare(sample_rate, 1024, 6);
+    int bytes_for_6_1024 = generator.get_max_midi_buffer_bytes();
+    expect(bytes_for_3 > 0, "should reserve room for MIDI");
+    expect(bytes_for_6 > bytes_for_3, "more neurons need more room");
+    expect(bytes_for_6_1024 > bytes_for_6, "bigger blocks need more room");
+
+    generator.prepare(sample_rate, 512, 1);
+    expect(generator.get_max_midi_buffer_bytes() == bytes_for_3,
+           "should always reserve room for the current neurons");
+
+    beginTest("generate_next_midi_buffer doesn't allocate");
+
+    // every neuron firing on a fast clock is the busiest the buffer can get
+    generator.set_neuron_threshold(0, -1000);
+    generator.set_neuron_threshold(1, -1000);
+    generator.set_neuron_threshold(2, -1000);
+    generator.set_subdivision(64);
+    pos.bpm = 180;
+    num_samples = 512;
+    buffer.clear();
+    generator.prepare(sample_rate, num_samples, 8);
+    buffer.ensureSize(generator.get_max_midi_buffer_bytes());
+    const uint8 *storage = buffer.data.begin();
+
+    // a dense stream of incoming MIDI, as an MPE controller might send
+    generator.toggleReceivesMidi();
+    MidiBuffer dense_input;
+    for (int sample = 0; sample < num_samples; ++sample) {
+      dense_input.addEvent(MidiMessage::noteOn(1 + sample % 16, 60 + sample % 3,
+                                               (uint8)(1 + sample % 127)),
+                           sample);
+      dense_input.addEvent(MidiMessage::controllerEvent(1, 74, sample % 128),
+                           sample);
+    }
+
+    int num_allocations{0};
+    for (int block = 0; block < 8; ++block) {
+      buffer.clear();
+      pos.timeInSamples = block * num_samples;
+      AllocationCounter counter;
+      generator.generate_next_midi_buffer(buffer, dense_input, pos,
+                                          sample_rate, num_samples);
+      num_allocations += counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "rendering MIDI should not allocate");
+    expect(!buffer.isEmpty(), "the generator should have played notes");
+    expect(buffer.data.begin() == storage,
+           "the MIDI buffer should not have been reallocated");
+
+    buffer.clear();
+    generator.flush_scheduled_midi(buffer);
+    generator.toggleReceivesMidi();
+    generator.set_subdivision(2);
+    generator.set_neuron_threshold(0, 0);
+    generator.set_neuron_threshold(1, 0);
+    generator.set_neuron_threshold(2, 0);
+
+    beginTest("generate_next_midi_buffer loops play the same each pass");
+
+    MidiGenerator looper(3);
+    looper.set_subdivision(4);
+    for (int i = 0; i < 3; ++i) {
+      looper.set_neuron_midi_note(i, 60 + i);
+      looper.set_neuron_input_weight(i, i + 1);
+      looper.set_neuron_threshold(i, 3 + i);
+      for (int j = 0; j < 3; ++j) {
+        looper.set_neuron_connection_weight(i, j, i == j ? -4 - i : 1 + j);
+      }
+    }
+    AudioPlayHead::CurrentPositionInfo loop_pos;
+    loop_pos.bpm = 120;
+    // a tick is 5512.5 samples, a bar 88200
+    int64 loop_start = 88200 + 5 * 5512.5 - 100;
+    int64 loop_end = loop_start + 88200;
+    auto play = [&](int64 from) {
+      std::vector<std::pair<int64, int>> notes;
+      MidiBuffer block;
+      for (int64 t = from; t < loop_end; t += 512) {
+        block.clear();
+        loop_pos.timeInSamples = t;
+        looper.generate_next_midi_buffer(block, no_input, loop_pos,
+                                         sample_rate, 512);
+        for (MidiBuffer::Iterator i(block); i.getNextEvent(m, time);) {
+          if (m.isNoteOn() && t + time >= loop_start) {
+            notes.push_back({t + time, m.getNoteNumber()});
+          }
+        }
+      }
+      return notes;
+    };
+    auto first_pass = play(0);
+    auto second_pass = play(loop_start);
+    auto third_pass = play(loop_start);
+    expect(!first_pass.empty(), "the looper should have played notes");
+    expect(second_pass == first_pass,
+           "a loop should play what was played there the first time");
+    expect(third_pass == first_pass, "every pass should play the same");
+
+    beginTest("generate_next_midi_buffer follows the song position");
+
+    FastForward fast_forward;
+    fast_forward.set_synchronous(true);
+    auto make_follower = [&]() {
+      auto follower = std::make_unique<MidiGenerator>(3);
+      follower->set_subdivision(4);
+      follower->toggleFollowsSongPosition();
+      for (int i = 0; i < 3; ++i) {
+        follower->set_neuron_midi_note(i, 60 + i);
+        follower->set_neuron_input_weight(i, i + 1);
+        follower->set_neuron_threshold(i, 3 + i);
+        for (int j = 0; j < 3; ++j) {
+          follower->set_neuron_connection_weight(i, j, i == j ? -5 : 2 + j);
+        }
+      }
+      follower->set_fast_forward(&fast_forward);
+      return follower;
+    };
+    auto play_from = [&](MidiGenerator &follower, int64 from, int64 record_from,
+                         int64 to) {
+      std::vector<std::pair<int64, int>> notes;
+      MidiBuffer block;
+      for (int64 t = from; t < to; t += 512) {
+        block.clear();
+        loop_pos.timeInSamples = t;
+        follower.generate_next_midi_buffer(block, no_input, loop_pos,
+                                           sample_rate, 512);
+        for (MidiBuffer::Iterator i(block); i.getNextEvent(m, time);) {
+          if (m.isNoteOn() && t + time >= record_from) {
+            notes.push_back({t + time, m.getNoteNumber()});
+          }
+        }
+      }
+      return notes;
+    };
+    // near the start, worked out inline, and far in, by the worker
+    for (int64 start_tick : {30, 300}) {
+      int64 start = static_cast<int64>(start_tick * 5512.5) - 100;
+      int64 end = start + 88200;
+      auto from_zero = make_follower();
+      auto from_start = make_follower();
+      auto heard = play_from(*from_zero, 0, start, end);
+      expect(!heard.empty(), "the follower should have played notes");
+      expect(play_from(*from_start, start, start, end) == heard,
+             "starting part way should play what playing from 0 plays there");
+    }
+
+    beginTest("generate_next_midi_buffer follows the song after edits");
+
+    // the bars played before the edit were played with other weights, so
+    // jumping back into them mustn't restore what was played there
+    {
+      auto edited = make_follower();
+      auto fresh = make_follower();
+      play_from(*edited, 0, 0, 3 * 88200);
+      for (auto *follower : {edited.get(), fresh.get()}) {
+        for (int i = 0; i < 3; ++i) {
+          follower->set_neuron_threshold(i, 10 + 2 * i);
+          for (int j = 0; j < 3; ++j) {
+            follower->set_neuron_connection_weight(i, j, i == j ? -8 : 0);
+          }
+        }
+      }
+      int64 start = static_cast<int64>(21 * 5512.5) - 100;
+      int64 end = start + 88200;
+      auto heard = play_from(*fresh, 0, start, end);
+      expect(!heard.empty(), "the follower should have played notes");
+      expect(play_from(*edited, start, start, end) == heard,
+             "a jump after an edit should play what the edit plays there");
+    }
+
+    beginTest("generate_next_midi_buffer follows the song through a ramp");
+
+    // the tempo speeds up a little every block, with the beat position
+    // reported as a host would. A tick is a sixteenth, wherever it falls, so
+    // the ramp should play the ticks a faster steady tempo plays.
+    {
+      const int ramp_blocks{1200};
+      auto get_bpm = [](int block, bool ramps) {
+        return ramps ? 100.0 + block * 0.1 : 240.0;
+      };
+      auto play_ramp = [&](MidiGenerator &follower, bool ramps, int from,
+                           int record_from) {
+        std::vector<std::pair<int64, int>> notes;
+        AudioPlayHead::CurrentPositionInfo ramp_pos;
+        double ppq{0};
+        MidiBuffer block;
+        for (int b = 0; b < ramp_blocks; ++b) {
+          double quarters_per_sample = get_bpm(b, ramps) / (60 * sample_rate);
+          if (b >= from) {
+            block.clear();
+            ramp_pos.bpm = get_bpm(b, ramps);
+            ramp_pos.ppqPosition = ppq;
+            ramp_pos.timeInSamples = static_cast<int64>(b) * 512;
+            follower.generate_next_midi_buffer(block, no_input, ramp_pos,
+                                               sample_rate, 512);
+            for (MidiBuffer::Iterator i(block); i.getNextEvent(m, time);) {
+              double tick = (ppq + time * quarters_per_sample) * 4;
+              if (m.isNoteOn() && b >= record_from) {
+                notes.push_back({std::llround(tick), m.getNoteNumber()});
+              }
+            }
+          }
+          ppq += 512 * quarters_per_sample;
+        }
+        return notes;
+      };
+      auto steady = make_follower();
+      auto ramping = make_follower();
+      auto on_the_beat = play_ramp(*steady, false, 0, 0);
+      auto heard = play_ramp(*ramping, true, 0, 0);
+      expect(!heard.empty(), "the follower should have played notes");
+      on_the_beat.resize(heard.size());
+      expect(heard == on_the_beat,
+             "a ramp should play each tick as a steady tempo plays it");
+
+      // far enough in for the worker to fast forward
+      auto from_zero = make_follower();
+      auto from_start = make_follower();
+      auto heard_from = play_ramp(*from_zero, true, 0, 800);
+      expect(!heard_from.empty(), "the follower should have played notes");
+      expect(play_ramp(*from_start, true, 800, 800) == heard_from,
+             "starting part way through a ramp should play what playing "
+             "from 0 plays there");
+    }
+
+    beginTest("generate_next_midi_buffer is real time safe through a session");
+
+    if (!RealtimeChecker::is_available()) {
+      logMessage("real time checks need a debug build with glibc, skipping");
+    } else {
+      // what a host might do: play from the start, change its block size and
+      // tempo, loop back, jump far ahead (for the worker to fast forward)
+      // and stop, with MIDI coming in all the while
+      FastForward worker;
+      ActivityFeed feed;
+      auto session = make_follower();
+      session->set_fast_forward(&worker);
+      session->set_activity_feed(&feed);
+      session->toggleReceivesMidi();
+      session->prepare(sample_rate, 512, 8);
+      MidiBuffer session_buffer, session_input;
+      session_buffer.ensureSize(session->get_max_midi_buffer_bytes());
+      for (int sample : {0, 99, 300}) {
+        session_input.addEvent(
+            MidiMessage::noteOn(1, 60 + sample % 3, (uint8)100), sample);
+      }
+      AudioPlayHead::CurrentPositionInfo session_pos;
+      session_pos.bpm = 120;
+      session_pos.isPlaying = true;
+
+      int num_violations{0}, num_events{0};
+      std::string report;
+      auto play_blocks = [&](int64 from, int num_blocks, int block_size) {
+        for (int b = 0; b < num_blocks; ++b) {
+          session_buffer.clear();
+          session_pos.timeInSamples = from + b * block_size;
+          RealtimeChecker checker;
+          session->generate_next_midi_buffer(session_buffer, session_input,
+                                             session_pos, sample_rate,
+                                             block_size);
+          checker.stop();
+          num_violations += checker.get_num_violations();
+          if (report.empty()) {
+            report = checker.get_report();
+          }
+          num_events += session_buffer.getNumEvents();
+        }
+      };
+
+      play_blocks(0, 200, 512);
+      play_blocks(200 * 512, 64, 100);
+      play_blocks(200 * 512 + 6400, 200, 32);
+      session_pos.bpm = 174;
+      play_blocks(200 * 512 + 12800, 100, 512);
+      session_pos.bpm = 120;
+      play_blocks(88200, 100, 512);
+      // the worker takes a while, the blocks carry on silently meanwhile
+      int64 far = static_cast<int64>(300 * 5512.5);
+      for (int b = 0; b < 20; ++b) {
+        play_blocks(far + b * 512, 1, 512);
+        Thread::sleep(5);
+      }
+      {
+        RealtimeChecker checker;
+        session->flush_scheduled_midi(session_buffer);
+        checker.stop();
+        num_violations += checker.get_num_violations();
+        if (report.empty()) {
+          report = checker.get_report();
+        }
+      }
+      expect(num_events > 0, "the session should have played notes");
+      expect(num_violations == 0, "the audio thread mustn't allocate, lock "
+                                  "or touch files:\n" +
+                                      report);
+    }
+
+    // == Parameter Versions ==
+    beginTest("parameter versions");
+
+    uint32 settings_version = generator.get_version(MidiGenerator::settings);
+    uint32 thresholds_version =
+        generator.get_version(MidiGenerator::thresholds);
+    uint32 connections_version =
+        generator.get_version(MidiGenerator::connection_weights);
+    uint32 row_0_version = generator.get_connection_row_version(0);
+    uint32 row_1_version = generator.get_connection_row_version(1);
+
+    generator.set_neuron_connection_weight(1, 2, 5);
+    expect(generator.get_version(MidiGenerator::connection_weights) !=
+               connections_version,
+           "changing a connection weight should bump its group");
+    expect(generator.get_connection_row_version(1) != row_1_version,
+           "changing a connection weight should bump its row");
+    expect(generator.get_connection_row_version(0) == row_0_version,
+           "other rows should be left alone");
+    expect(generator.get_version(MidiGenerator::settings) == settings_version,
+           "other groups should be left alone");
+    expect(generator.get_version(MidiGenerator::thresholds) ==
+               thresholds_version,
+           "other groups should be left alone");
+    generator.set_neuron_connection_weight(1, 2, 0);
+
+    generator.set_volume(generator.get_volume());
+    expect(generator.get_version(MidiGenerator::settings) != settings_version,
+           "changing a setting should bump the settings group");
+
+    MidiGenerator other(generator.num_neurons());
+    expect(other.get_version(MidiGenerator::thresholds) !=
+               generator.get_version(MidiGenerator::thresholds),
+           "a new generator should not reuse another generator's versions");
+
+    thresholds_version = generator.get_version(MidiGenerator::thresholds);
+    row_0_version = generator.get_connection_row_version(0);
+    generator.add_neuron();
+    expect(generator.get_version(MidiGenerator::thresholds) !=
+               thresholds_version,
+           "adding a neuron should bump every group");
+    expect(generator.get_connection_row_version(0) != row_0_version,
+           "adding a neuron should bump every row");
+    generator.remove_neuron();
+
+    // == Snapshot ==
+    beginTest("get_snapshot");
+
+    generator.set_neuron_threshold(1, 7);
+    generator.set_neuron_connection_weight(2, 0, -3);
+    std::shared_ptr<const EngineSnapshot> before = generator.get_snapshot();
+    expect(before->num_neurons() == generator.num_neurons(),
+           "snapshot has the wrong number of neurons");
+    expect(before->thresholds.at(1) == 7, "snapshot threshold is wrong");
+    expect(before->get_connection_weight(2, 0) == -3,
+           "snapshot connection weight is wrong");
+    expect(before->volume == generator.get_volume(), "snapshot volume wrong");
+
+    int old_weight = generator.get_neuron_connection_weight(0, 1);
+    generator.set_neuron_connection_weight(0, 1, 9);
+    std::shared_ptr<const EngineSnapshot> after = generator.get_snapshot();
+    expect(after->version != before->version, "a change should republish");
+    expect(after->get_connection_weight(0, 1) == 9,
+           "the new snapshot should have the change");
+    expect(before->get_connection_weight(0, 1) == old_weight,
+           "the old snapshot should not change");
+    expect(&after->get_connection_row(2) == &before->get_connection_row(2),
+           "unchanged rows should be shared");
+    expect(&after->get_connection_row(0) != &before->get_connection_row(0),
+           "the changed row should be copied");
+
+    generator.set_neuron_threshold(1, 0);
+    generator.set_neuron_connection_weight(2, 0, 0);
+    generator.set_neuron_connection_weight(0, 1, old_weight);
   };
 };
 
@@ -0,0 +1,58 @@
+/*
+ * MidiMerger.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiMerger.hpp"
+
+// Events from `first` go before events from `second` at the same sample.
+void MidiMerger::merge(const MidiBuffer &first, const MidiBuffer &second,
+                       MidiBuffer &destination) {
+  jassert(&destination != &first && &destination != &second);
+  destination.clear();
+
+  MidiBuffer::Iterator first_events(first);
+  MidiBuffer::Iterator second_events(second);
+  const uint8 *first_data, *second_data;
+  int first_size, second_size, first_time, second_time;
+  bool has_first =
+      first_events.getNextEvent(first_data, first_size, first_time);
+  bool has_second =
+      second_events.getNextEvent(second_data, second_size, second_time);
+
+  while (has_first && has_second) {
+    if (first_time <= second_time) {
+      append_event(destination, first_data, first_size, first_time);
+      has_first = first_events.getNextEvent(first_data, first_size, first_time);
+    } else {
+      append_event(destination, second_data, second_size, second_time);
+      has_second =
+          second_events.getNextEvent(second_data, second_size, second_time);
+    }
+  }
+  while (has_first) {
+    append_event(destination, first_data, first_size, first_time);
+    has_first = first_events.getNextEvent(first_data, first_size, first_time);
+  }
+  while (has_second) {
+    append_event(destination, second_data, second_size, second_time);
+    has_second =
+        second_events.getNextEvent(second_data, second_size, second_time);
+  }
+}
+
+void MidiMerger::copy(const MidiBuffer &source, MidiBuffer &destination) {
+  destination.clear();
+  destination.data.addArray(source.data.begin(), source.data.size());
+}
+
+void MidiMerger::append_event(MidiBuffer &buffer, const uint8 *data,
+                              int num_bytes, int sample_num) {
+  int32 time = static_cast<int32>(sample_num);
+  uint16 size = static_cast<uint16>(num_bytes);
+  buffer.data.addArray(reinterpret_cast<const uint8 *>(&time), sizeof(time));
+  buffer.data.addArray(reinterpret_cast<const uint8 *>(&size), sizeof(size));
+  buffer.data.addArray(data, num_bytes);
+}
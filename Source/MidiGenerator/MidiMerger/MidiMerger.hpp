@@ -0,0 +1,32 @@
+/*
+ * MidiMerger.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+/*
+ * MIDI Merger
+ *
+ * Merges two time-ordered MidiBuffers into a third in a single linear pass.
+ * MidiBuffer::addEvent searches from the start of the buffer for every event,
+ * so instead events are appended straight onto the end of the destination's
+ * raw data. This relies on the MidiBuffer layout (time, size, bytes) and on
+ * the sources already being in sample order, which MidiBuffers always are.
+ *
+ * Nothing is allocated as long as the destination has been reserved with
+ * MidiBuffer::ensureSize.
+ */
+
+class MidiMerger {
+public:
+  static void merge(const MidiBuffer &first, const MidiBuffer &second,
+                    MidiBuffer &destination);
+  static void copy(const MidiBuffer &source, MidiBuffer &destination);
+  static void append_event(MidiBuffer &buffer, const uint8 *data, int num_bytes,
+                           int sample_num);
+};
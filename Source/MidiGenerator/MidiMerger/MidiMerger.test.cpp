@@ -0,0 +1,71 @@
+/*
+ * MidiMerger.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiMerger.hpp"
+#include "../../Utils/AllocationCounter.hpp"
+
+class MidiMergerTests : public UnitTest {
+public:
+  MidiMergerTests() : UnitTest("MidiMerger Testing") {}
+
+  void runTest() override {
+    MidiBuffer host, generated, merged;
+
+    host.addEvent(MidiMessage::noteOn(1, 40, (uint8)100), 0);
+    host.addEvent(MidiMessage::controllerEvent(1, 1, 64), 10);
+    host.addEvent(MidiMessage::noteOff(1, 40), 30);
+    generated.addEvent(MidiMessage::noteOn(2, 60, (uint8)100), 5);
+    generated.addEvent(MidiMessage::noteOn(2, 64, (uint8)100), 10);
+    generated.addEvent(MidiMessage::noteOff(2, 60), 50);
+
+    // == merge ==
+    beginTest("merge");
+
+    MidiMerger::merge(host, generated, merged);
+    expect(merged.getNumEvents() == 6, "Wrong number of MIDI events");
+
+    std::vector<int> expected_times{0, 5, 10, 10, 30, 50};
+    std::vector<int> expected_channels{1, 2, 1, 2, 1, 2};
+    int j{0};
+    int time;
+    MidiMessage m;
+    for (MidiBuffer::Iterator i(merged); i.getNextEvent(m, time); ++j) {
+      expect(time == expected_times.at(j), "event at the wrong sample");
+      expect(m.getChannel() == expected_channels.at(j),
+             "events are in the wrong order");
+    }
+
+    beginTest("merge - empty buffers");
+
+    MidiMerger::merge(host, MidiBuffer(), merged);
+    expect(merged.data.size() == host.data.size(), "host should be copied");
+    MidiMerger::merge(MidiBuffer(), MidiBuffer(), merged);
+    expect(merged.isEmpty(), "merged buffer should be empty");
+
+    beginTest("merge - doesn't allocate into a reserved buffer");
+
+    merged.ensureSize(host.data.size() + generated.data.size());
+    int num_allocations{0};
+    {
+      AllocationCounter counter;
+      MidiMerger::merge(host, generated, merged);
+      num_allocations = counter.get_num_allocations();
+    }
+    expect(num_allocations == 0, "merge should not allocate");
+
+    // == copy ==
+    beginTest("copy");
+
+    MidiBuffer destination;
+    destination.addEvent(MidiMessage::noteOn(3, 1, (uint8)1), 0);
+    MidiMerger::copy(merged, destination);
+    expect(destination.getNumEvents() == 6, "Wrong number of MIDI events");
+    expect(destination.getLastEventTime() == 50, "last event at wrong sample");
+  };
+};
+
+static MidiMergerTests test;
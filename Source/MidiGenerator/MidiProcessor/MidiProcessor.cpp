@@ -7,27 +7,45 @@
 
 #include "MidiProcessor.hpp"
 #include "assert.h"
+#include <algorithm>
 #include <cmath>
 
+static const GateLength follow_global_gate{GateLength::ticks, 0.0f};
+
 MidiProcessor::MidiProcessor(int num_notes)
-    : max_brain_output{1}, global_volume{1.0}, volume_clip{1, 127} {
+    : max_brain_output{1}, global_volume{1.0}, volume_clip{1, 127},
+      num_tick_slots{0}, sample_rate{44100}, samples_per_tick{22050} {
   midi_map = std::vector<int>(num_notes, 1);
+  channel_map = std::vector<int>(num_notes, 1);
+  neuron_gates = std::vector<GateLength>(num_notes, follow_global_gate);
+  tick_notes.fill(0);
+  update_velocity_table();
 };
 MidiProcessor::~MidiProcessor(){};
 
 // Getters & Setters
 
 float MidiProcessor::get_global_volume() { return global_volume; };
-void MidiProcessor::set_global_volume(float v) { global_volume = v; };
+void MidiProcessor::set_global_volume(float v) {
+  global_volume = v;
+  update_velocity_table();
+};
 int MidiProcessor::get_volume_clip_min() { return volume_clip.first; };
 int MidiProcessor::get_volume_clip_max() { return volume_clip.second; };
 void MidiProcessor::set_volume_clip(int min, int max) {
   assert(min <= max);
   volume_clip = std::make_pair(min, max);
+  update_velocity_table();
 };
 int MidiProcessor::get_volume_clip_range() {
   return volume_clip.second - volume_clip.first;
 }
+int MidiProcessor::get_max_brain_output() { return max_brain_output; }
+void MidiProcessor::set_max_brain_output(int max_output) {
+  assert(max_output > 0 && max_output < num_output_levels);
+  max_brain_output = max_output;
+  update_velocity_table();
+}
 
 std::vector<int> MidiProcessor::get_midi_map() { return midi_map; }
 int MidiProcessor::get_note_at(int neuron_idx) {
@@ -37,6 +55,30 @@ void MidiProcessor::set_note_at(int neuron_idx, int new_note_number) {
   midi_map.at(neuron_idx) = new_note_number;
   PluginLogger::logger.log_vec("midi notes", midi_map);
 }
+int MidiProcessor::get_channel_at(int neuron_idx) {
+  return channel_map.at(neuron_idx);
+}
+void MidiProcessor::set_channel_at(int neuron_idx, int new_channel) {
+  assert(new_channel >= 1 && new_channel <= 16);
+  channel_map.at(neuron_idx) = new_channel;
+}
+
+GateLength MidiProcessor::get_gate_length() { return global_gate; }
+void MidiProcessor::set_gate_length(GateLength gate) {
+  assert(gate.value > 0);
+  global_gate = gate;
+}
+GateLength MidiProcessor::get_gate_length_at(int neuron_idx) {
+  return neuron_gates.at(neuron_idx);
+}
+void MidiProcessor::set_gate_length_at(int neuron_idx, GateLength gate) {
+  neuron_gates.at(neuron_idx) = gate;
+}
+
+NotePolicy MidiProcessor::get_note_policy() { return note_policy; }
+void MidiProcessor::set_note_policy(NotePolicy policy) {
+  note_policy = policy;
+}
 
 // Methods
 
@@ -53,29 +95,136 @@ int MidiProcessor::get_clipped_midi_volume(float vel) {
 }
 
 uint8 MidiProcessor::get_note_velocity(int brain_output_value) {
+  if (brain_output_value <= 0) {
+    return 0;
+  }
+  return velocity_table[clip_brain_output(brain_output_value)];
+}
+
+uint8 MidiProcessor::calculate_note_velocity(int brain_output_value) {
   float output = as_percent_of_max(clip_brain_output(brain_output_value));
   return std::round(get_clipped_midi_volume(output) * global_volume);
 }
 
-void MidiProcessor::add_midi_note() { midi_map.push_back(1); }
+int MidiProcessor::get_gate_samples(int neuron_idx) {
+  GateLength gate = neuron_gates.at(neuron_idx);
+  if (gate.value <= 0) {
+    gate = global_gate;
+  }
+
+  float samples{0};
+  switch (gate.unit) {
+  case GateLength::ticks:
+    samples = std::max(1.0f, std::round(gate.value)) * samples_per_tick;
+    break;
+  case GateLength::subdivision_fraction:
+    samples = std::min(gate.value, 1.0f) * samples_per_tick;
+    break;
+  case GateLength::milliseconds:
+    samples = gate.value * 0.001f * sample_rate;
+    break;
+  }
+  return samples < 1 ? 1 : static_cast<int>(std::round(samples));
+}
+
+void MidiProcessor::add_midi_note() { add_midi_note(1); }
 void MidiProcessor::add_midi_note(int note_num) {
   midi_map.push_back(note_num);
+  channel_map.push_back(1);
+  neuron_gates.push_back(follow_global_gate);
+}
+void MidiProcessor::remove_midi_note() {
+  midi_map.pop_back();
+  channel_map.pop_back();
+  neuron_gates.pop_back();
 }
-void MidiProcessor::remove_midi_note() { midi_map.pop_back(); }
 void MidiProcessor::remove_midi_note_at(int index) {
   midi_map.erase(midi_map.begin() + index);
+  channel_map.erase(channel_map.begin() + index);
+  neuron_gates.erase(neuron_gates.begin() + index);
 }
 
-void MidiProcessor::render_buffer(MidiBuffer &buffer,
-                                  std::vector<int> new_output, int sample_num) {
+void MidiProcessor::prepare(double new_sample_rate, int max_neurons) {
+  sample_rate = new_sample_rate;
+  midi_map.reserve(max_neurons);
+  channel_map.reserve(max_neurons);
+  neuron_gates.reserve(max_neurons);
+}
+
+void MidiProcessor::configure(double new_sample_rate,
+                              float new_samples_per_tick) {
+  sample_rate = new_sample_rate;
+  samples_per_tick = new_samples_per_tick;
+}
+
+void MidiProcessor::render_buffer(MidiBuffer &buffer, MidiScheduler &scheduler,
+                                  const std::vector<int> &new_output,
+                                  int64 block_start, int sample_num) {
   assert(midi_map.size() == new_output.size());
 
   for (int i = 0; i < new_output.size(); ++i) {
-    if (new_output.at(i) == 1) {
-      uint8 vel = get_note_velocity(new_output.at(i));
-      int midi_note_num = midi_map.at(i);
-      MidiMessage m = MidiMessage::noteOn(1, midi_note_num, vel);
-      buffer.addEvent(m, sample_num);
+    if (new_output[i] > 0) {
+      uint8 vel = get_note_velocity(new_output[i]);
+      if (vel == 0) {
+        continue;
+      }
+      int slot = ((channel_map[i] - 1) * 128) + (midi_map[i] & 0x7f);
+      add_to_tick(slot, vel, get_gate_samples(i));
+    }
+  }
+
+  for (int s = 0; s < num_tick_slots; ++s) {
+    int slot = tick_slots[s];
+    int channel = (slot / 128) + 1;
+    int note = slot % 128;
+    tick_notes[slot / 64] &= ~(uint64{1} << (slot % 64));
+
+    MidiScheduler::EventId &note_off = note_offs[slot];
+    int64 note_off_time = block_start + sample_num + tick_gates[slot];
+    bool is_held = scheduler.cancel(note_off);
+
+    if (is_held && note_policy.repeat == NotePolicy::retrigger) {
+      buffer.addEvent(MidiMessage::noteOff(channel, note), sample_num);
+    }
+    if (!is_held || note_policy.repeat == NotePolicy::retrigger) {
+      buffer.addEvent(
+          MidiMessage::noteOn(channel, note, tick_velocities[slot]),
+          sample_num);
     }
+    note_off = scheduler.schedule(MidiMessage::noteOff(channel, note),
+                                  note_off_time);
+  }
+  num_tick_slots = 0;
+}
+
+// Private Methods
+
+void MidiProcessor::update_velocity_table() {
+  for (int level = 0; level < num_output_levels; ++level) {
+    velocity_table[level] = calculate_note_velocity(level);
+  }
+}
+
+// Neurons on the same note share one note on - the first one in claims the
+// slot, the rest are folded in according to the velocity policy.
+void MidiProcessor::add_to_tick(int slot, uint8 velocity, int gate_samples) {
+  uint64 bit = uint64{1} << (slot % 64);
+  uint64 &notes = tick_notes[slot / 64];
+  if ((notes & bit) == 0) {
+    notes |= bit;
+    tick_slots[num_tick_slots++] = slot;
+    tick_velocities[slot] = velocity;
+    tick_gates[slot] = gate_samples;
+    return;
+  }
+
+  uint8 &tick_velocity = tick_velocities[slot];
+  if (note_policy.velocity == NotePolicy::sum_velocity) {
+    tick_velocity = static_cast<uint8>(jmin(tick_velocity + velocity, 127));
+  } else if (velocity > tick_velocity) {
+    tick_velocity = velocity;
+  }
+  if (gate_samples > tick_gates[slot]) {
+    tick_gates[slot] = gate_samples;
   }
 }
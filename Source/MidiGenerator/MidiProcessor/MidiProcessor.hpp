@@ -9,9 +9,44 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../../Utils/PluginLogger.hpp"
+#include "../MidiScheduler/MidiScheduler.hpp"
+#include <array>
 #include <utility>
 #include <vector>
 
+/*
+ * Gate Length - how long a note is held before its note off is sent
+ *
+ * Measured in whole beat clock ticks (rounded, at least one), milliseconds,
+ * or as a fraction of the current subdivision (at most all of it, so the note
+ * has ended before the neuron can next fire). A neuron gate length with a
+ * value <= 0 means the neuron follows the global gate length.
+ */
+
+struct GateLength {
+  enum Unit { ticks, milliseconds, subdivision_fraction };
+
+  Unit unit{subdivision_fraction};
+  float value{0.5f};
+};
+
+/*
+ * Note Policy - what happens when a note is played more than once
+ *
+ * Neurons that fire the same note (and channel) on the same tick are merged
+ * into one note on, with either the loudest or the summed velocity. A note
+ * that is still held when it is played again is either retriggered (note off
+ * then note on) or held, in which case its note off is pushed back.
+ */
+
+struct NotePolicy {
+  enum Velocity { max_velocity, sum_velocity };
+  enum Repeat { retrigger, hold };
+
+  Velocity velocity{max_velocity};
+  Repeat repeat{retrigger};
+};
+
 class MidiProcessor {
 public:
   MidiProcessor(int num_notes);
@@ -24,27 +59,82 @@ public:
   int get_volume_clip_max();
   void set_volume_clip(int min, int max);
   int get_volume_clip_range();
+  int get_max_brain_output();
+  void set_max_brain_output(int max_output);
 
   std::vector<int> get_midi_map();
   int get_note_at(int neuron_idx);
   void set_note_at(int neuron_idx, int new_note_number);
+  int get_channel_at(int neuron_idx);
+  void set_channel_at(int neuron_idx, int new_channel);
+
+  GateLength get_gate_length();
+  void set_gate_length(GateLength gate);
+  GateLength get_gate_length_at(int neuron_idx);
+  void set_gate_length_at(int neuron_idx, GateLength gate);
+
+  NotePolicy get_note_policy();
+  void set_note_policy(NotePolicy policy);
 
   // Methods
   int clip_brain_output(int output);
   float as_percent_of_max(int output);
   int get_clipped_midi_volume(float vel);
   uint8 get_note_velocity(int brain_output_value);
+  uint8 calculate_note_velocity(int brain_output_value);
+  int get_gate_samples(int neuron_idx);
 
   void add_midi_note();
   void add_midi_note(int note_num);
   void remove_midi_note();
   void remove_midi_note_at(int index);
-  void render_buffer(MidiBuffer &buffer, std::vector<int> next_output,
+  void prepare(double sample_rate, int max_neurons);
+  void configure(double sample_rate, float samples_per_tick);
+  void render_buffer(MidiBuffer &buffer, MidiScheduler &scheduler,
+                     const std::vector<int> &next_output, int64 block_start,
                      int sample_num);
 
+  // bytes a short (<= 3 byte) MIDI event takes up in a MidiBuffer
+  static constexpr int bytes_per_event{sizeof(int32) + sizeof(uint16) + 3};
+
+  // a held note's note off is moved rather than added to when it is played
+  // again, so the scheduler never holds more than one for each note on each
+  // channel, however big the network or long the gates
+  static constexpr int max_note_offs{16 * 128};
+
 private:
+  // every note on every channel, indexed by (channel - 1) * 128 + note
+  static constexpr int num_note_slots{max_note_offs};
+
   int max_brain_output;
   float global_volume;
   std::pair<int, int> volume_clip;
   std::vector<int> midi_map;
+  std::vector<int> channel_map;
+
+  // note velocity for each graded brain output, rebuilt whenever the volume
+  // settings change so that playing a note is just a lookup
+  static constexpr int num_output_levels{128};
+  std::array<uint8, num_output_levels> velocity_table;
+  void update_velocity_table();
+
+  GateLength global_gate;
+  std::vector<GateLength> neuron_gates;
+  NotePolicy note_policy;
+
+  // the notes played on the current tick - a bitmap of which slots are in
+  // use plus the slots in the order they were first played, so collecting
+  // and rendering a tick only touches the notes that fired
+  std::array<uint64, num_note_slots / 64> tick_notes;
+  std::array<int, num_note_slots> tick_slots;
+  std::array<uint8, num_note_slots> tick_velocities;
+  std::array<int, num_note_slots> tick_gates;
+  int num_tick_slots;
+
+  // the note off for each held note
+  std::array<MidiScheduler::EventId, num_note_slots> note_offs;
+
+  void add_to_tick(int slot, uint8 velocity, int gate_samples);
+  double sample_rate;
+  float samples_per_tick;
 };
@@ -61,6 +61,14 @@ public:
     expect(processor.get_note_at(1) == 89, "new note is 89");
     expect(processor.get_note_at(2) == 111, "new note is 111");
 
+    // == MIDI Channels ==
+    beginTest("MIDI Channels");
+
+    expect(processor.get_channel_at(0) == 1, "default channel is 1");
+    processor.set_channel_at(1, 10);
+    expect(processor.get_channel_at(1) == 10, "new channel is 10");
+    processor.set_channel_at(1, 1);
+
     // == Clip Midi Volume ==
     beginTest("clip_brain_output");
 
@@ -105,6 +113,33 @@ public:
     processor.set_global_volume(1.0f);
     processor.set_volume_clip(1, 127);
 
+    beginTest("get_note_velocity - graded output");
+
+    expect(processor.get_max_brain_output() == 1, "default max output wrong");
+    processor.set_max_brain_output(4);
+    expect(processor.get_max_brain_output() == 4, "max output was not set");
+    expect(processor.get_note_velocity(0) == 0, "note vel should be 0");
+    expect(processor.get_note_velocity(1) == 33, "note vel should be 33");
+    expect(processor.get_note_velocity(2) == 64, "note vel should be 64");
+    expect(processor.get_note_velocity(4) == 127, "note vel should be 127");
+    expect(processor.get_note_velocity(200) == 127, "note vel should be 127");
+    expect(processor.get_note_velocity(-3) == 0, "note vel should be 0");
+
+    processor.set_volume_clip(51, 91);
+    expect(processor.get_note_velocity(2) == 71, "note vel should be 71");
+    processor.set_global_volume(0.5f);
+    expect(processor.get_note_velocity(2) == 36, "note vel should be 36");
+
+    for (int level = 0; level < 128; ++level) {
+      expect(processor.get_note_velocity(level) ==
+                 processor.calculate_note_velocity(level),
+             "velocity table is out of date");
+    }
+
+    processor.set_global_volume(1.0f);
+    processor.set_volume_clip(1, 127);
+    processor.set_max_brain_output(1);
+
     // == add_midi_note, remove_midi_note, remove_midi_note_at ==
     beginTest("add_midi_note");
 
@@ -141,17 +176,19 @@ public:
 
     std::vector<int> output{1, 1, 1};
     MidiBuffer buffer;
+    MidiScheduler scheduler;
     int sample_number = 100;
-    processor.render_buffer(buffer, output, sample_number);
+    processor.render_buffer(buffer, scheduler, output, 0, sample_number);
 
     expect(buffer.getNumEvents() == 3, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 100,
            "MIDI events have wrong sample number");
 
     output = std::vector<int>{1, 0, 1};
+    scheduler.flush(buffer, 0); // release the held notes
     buffer = MidiBuffer();
     sample_number = 167;
-    processor.render_buffer(buffer, output, sample_number);
+    processor.render_buffer(buffer, scheduler, output, 0, sample_number);
 
     expect(buffer.getNumEvents() == 2, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 167,
@@ -161,9 +198,10 @@ public:
     beginTest("render_buffer note numbers");
 
     output = std::vector<int>{1, 0, 0};
+    scheduler.flush(buffer, 0); // release the held notes
     buffer = MidiBuffer();
     sample_number = 17;
-    processor.render_buffer(buffer, output, sample_number);
+    processor.render_buffer(buffer, scheduler, output, 0, sample_number);
 
     expect(buffer.getNumEvents() == 1, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 17,
@@ -177,9 +215,10 @@ public:
     }
 
     output = std::vector<int>{0, 1, 0};
+    scheduler.flush(buffer, 0); // release the held notes
     buffer = MidiBuffer();
     sample_number = 45;
-    processor.render_buffer(buffer, output, sample_number);
+    processor.render_buffer(buffer, scheduler, output, 0, sample_number);
 
     expect(buffer.getNumEvents() == 1, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 45,
@@ -191,9 +230,10 @@ public:
     }
 
     output = std::vector<int>{0, 0, 1};
+    scheduler.flush(buffer, 0); // release the held notes
     buffer = MidiBuffer();
     sample_number = 229;
-    processor.render_buffer(buffer, output, sample_number);
+    processor.render_buffer(buffer, scheduler, output, 0, sample_number);
 
     expect(buffer.getNumEvents() == 1, "Wrong number of MIDI events");
     expect(buffer.getFirstEventTime() == 229,
@@ -203,6 +243,219 @@ public:
       expect(m.getNoteNumber() == 67, "note number is incorrect");
       expect(m.getVelocity() == 127, "note velocity is incorrect");
     }
+
+    beginTest("render_buffer channels");
+
+    processor.set_channel_at(2, 5);
+    output = std::vector<int>{1, 0, 1};
+    scheduler.flush(buffer, 0); // release the held notes
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+    scheduler.flush(buffer, 0);
+
+    int num_events{0};
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      int expected_channel = m.getNoteNumber() == 67 ? 5 : 1;
+      expect(m.getChannel() == expected_channel, "note on the wrong channel");
+      ++num_events;
+    }
+    expect(num_events == 4, "should be 2 note ons and 2 note offs");
+    processor.set_channel_at(2, 1);
+
+    beginTest("render_buffer graded velocities");
+
+    processor.set_max_brain_output(4);
+    output = std::vector<int>{4, 0, 2};
+    scheduler.flush(buffer, 0); // release the held notes
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+
+    expect(buffer.getNumEvents() == 2, "Wrong number of MIDI events");
+    std::vector<int> expected_velocities{127, 64};
+    int k{0};
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time); ++k) {
+      expect(m.getVelocity() == expected_velocities.at(k),
+             "note velocity is incorrect");
+    }
+    processor.set_max_brain_output(1);
+    scheduler.flush(buffer, 0);
+
+    // == Gate Length ==
+    beginTest("gate length get / set");
+
+    expect(processor.get_gate_length().unit == GateLength::subdivision_fraction,
+           "default gate length unit is wrong");
+    expectWithinAbsoluteError<float>(processor.get_gate_length().value, 0.5f,
+                                     0.01f, "default gate length is wrong");
+    expect(processor.get_gate_length_at(0).value <= 0,
+           "neurons should follow the global gate length by default");
+
+    processor.configure(48000, 1000);
+    expect(processor.get_gate_samples(0) == 500, "gate should be 500 samples");
+
+    processor.set_gate_length(GateLength{GateLength::ticks, 2});
+    expect(processor.get_gate_samples(0) == 2000, "gate should be 2 ticks");
+
+    processor.set_gate_length(GateLength{GateLength::milliseconds, 10});
+    expect(processor.get_gate_samples(0) == 480, "gate should be 10ms");
+
+    processor.set_gate_length_at(1, GateLength{GateLength::ticks, 1});
+    expect(processor.get_gate_samples(0) == 480, "neuron 0 follows global");
+    expect(processor.get_gate_samples(1) == 1000, "neuron 1 has own gate");
+
+    processor.set_gate_length(GateLength{GateLength::milliseconds, 0.0001f});
+    expect(processor.get_gate_samples(2) == 1, "gate is at least 1 sample");
+
+    beginTest("gate length - ticks and subdivision fractions differ");
+
+    // ticks are whole (at least one), a fraction is of one subdivision
+    processor.set_gate_length(GateLength{GateLength::ticks, 0.25f});
+    expect(processor.get_gate_samples(0) == 1000, "a gate is at least 1 tick");
+    processor.set_gate_length(
+        GateLength{GateLength::subdivision_fraction, 0.25f});
+    expect(processor.get_gate_samples(0) == 250,
+           "a gate should be a quarter of the subdivision");
+    processor.set_gate_length(GateLength{GateLength::ticks, 1.6f});
+    expect(processor.get_gate_samples(0) == 2000, "ticks should be rounded");
+    processor.set_gate_length(
+        GateLength{GateLength::subdivision_fraction, 1.6f});
+    expect(processor.get_gate_samples(0) == 1000,
+           "a fraction is at most the whole subdivision");
+
+    processor.set_gate_length(
+        GateLength{GateLength::subdivision_fraction, 0.5});
+    processor.set_gate_length_at(1, GateLength{GateLength::ticks, 0});
+
+    // == render_buffer note offs ==
+    beginTest("render_buffer note offs");
+
+    output = std::vector<int>{1, 0, 0};
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 10);
+
+    expect(buffer.getNumEvents() == 1, "only the note on is in the buffer");
+    expect(scheduler.num_pending() == 1, "note off should be scheduled");
+
+    scheduler.render_buffer(buffer, 0, 600);
+    expect(buffer.getNumEvents() == 2, "note off should be rendered");
+    expect(buffer.getLastEventTime() == 510, "note off at wrong sample");
+
+    int num_note_offs{0};
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      if (m.isNoteOff()) {
+        ++num_note_offs;
+        expect(m.getNoteNumber() == 60, "note off for wrong note");
+      }
+    }
+    expect(num_note_offs == 1, "should be one note off");
+
+    beginTest("render_buffer note offs in later blocks");
+
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 600, 400);
+    scheduler.render_buffer(buffer, 600, 512);
+    expect(buffer.getNumEvents() == 1, "note off falls in the next block");
+
+    buffer = MidiBuffer();
+    scheduler.render_buffer(buffer, 1112, 512);
+    expect(buffer.getNumEvents() == 1, "note off should be rendered");
+    expect(buffer.getFirstEventTime() == 1500 - 1112, "note off wrong sample");
+
+    beginTest("render_buffer retriggers close the previous note");
+
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 1624, 0);
+    processor.render_buffer(buffer, scheduler, output, 1624, 100);
+
+    expect(buffer.getNumEvents() == 3, "note on, note off, note on");
+    expect(scheduler.num_pending() == 1, "only one note off should remain");
+
+    std::vector<bool> expected_note_ons{true, false, true};
+    int j{0};
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time); ++j) {
+      expect(m.getNoteNumber() == 60, "wrong note number");
+      expect(m.isNoteOn() == expected_note_ons.at(j), "wrong note on/off");
+    }
+
+    beginTest("render_buffer held notes are tracked per note");
+
+    buffer = MidiBuffer();
+    processor.set_note_at(0, 62);
+    processor.render_buffer(buffer, scheduler, output, 1624, 200);
+    expect(buffer.getNumEvents() == 1, "a new note doesn't close the old one");
+    expect(scheduler.num_pending() == 2, "both notes should be held");
+    scheduler.flush(buffer, 0);
+    processor.set_note_at(0, 60);
+
+    // == Note Policy ==
+    beginTest("note policy get / set");
+
+    expect(processor.get_note_policy().velocity == NotePolicy::max_velocity,
+           "default velocity policy is wrong");
+    expect(processor.get_note_policy().repeat == NotePolicy::retrigger,
+           "default repeat policy is wrong");
+
+    beginTest("render_buffer merges neurons on the same note");
+
+    processor.set_note_at(1, 60);
+    processor.set_max_brain_output(4);
+    output = std::vector<int>{1, 2, 0};
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+
+    expect(buffer.getNumEvents() == 1, "same note should only play once");
+    expect(scheduler.num_pending() == 1, "same note should only be held once");
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.getVelocity() == 64, "should play the loudest velocity");
+    }
+
+    processor.set_note_policy(
+        NotePolicy{NotePolicy::sum_velocity, NotePolicy::retrigger});
+    scheduler.flush(buffer, 0);
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.getVelocity() == 97, "should play the summed velocity");
+    }
+
+    output = std::vector<int>{4, 4, 0};
+    scheduler.flush(buffer, 0);
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      expect(m.getVelocity() == 127, "summed velocity should be clipped");
+    }
+
+    processor.set_channel_at(1, 2);
+    scheduler.flush(buffer, 0);
+    buffer = MidiBuffer();
+    processor.render_buffer(buffer, scheduler, output, 0, 0);
+    expect(buffer.getNumEvents() == 2, "other channels are other notes");
+
+    processor.set_channel_at(1, 1);
+    processor.set_note_at(1, 64);
+    processor.set_max_brain_output(1);
+    scheduler.flush(buffer, 0);
+
+    beginTest("render_buffer holds repeated notes");
+
+    processor.set_note_policy(
+        NotePolicy{NotePolicy::max_velocity, NotePolicy::hold});
+    output = std::vector<int>{1, 0, 0};
+    buffer = MidiBuffer();
+    int64 now = scheduler.get_current_time();
+    processor.render_buffer(buffer, scheduler, output, now, 0);
+    processor.render_buffer(buffer, scheduler, output, now, 400);
+    expect(buffer.getNumEvents() == 1, "held note should not replay");
+    expect(scheduler.num_pending() == 1, "note should still be held");
+
+    scheduler.render_buffer(buffer, now, 800);
+    expect(buffer.getNumEvents() == 1, "note off should have moved back");
+    scheduler.render_buffer(buffer, now + 800, 200);
+    expect(buffer.getNumEvents() == 2, "note off should be rendered");
+    expect(buffer.getLastEventTime() == 900 - 800, "note off at wrong time");
+
+    processor.set_note_policy(NotePolicy{});
   };
 };
 
@@ -0,0 +1,125 @@
+/*
+ * MidiReceiver.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiReceiver.hpp"
+#include "assert.h"
+
+constexpr int MidiReceiver::unmapped;
+constexpr int MidiReceiver::default_base_note;
+constexpr int MidiReceiver::end_of_block;
+
+MidiReceiver::MidiReceiver(int num_neurons)
+    : next_event_data{nullptr}, next_event_size{0}, next_event_time{0},
+      has_next_event{false}, was_receiving{false} {
+  note_map.fill(unmapped);
+  cc_map.fill(unmapped);
+  for (int i = 0; i < num_neurons; ++i) {
+    add_neuron();
+  }
+};
+MidiReceiver::~MidiReceiver(){};
+
+// Getters & Setters
+
+int MidiReceiver::get_note_neuron(int note) { return note_map.at(note); }
+void MidiReceiver::set_note_neuron(int note, int neuron_idx) {
+  assert(neuron_idx >= unmapped && neuron_idx < (int)input.size());
+  note_map.at(note) = neuron_idx;
+}
+int MidiReceiver::get_cc_neuron(int cc) { return cc_map.at(cc); }
+void MidiReceiver::set_cc_neuron(int cc, int neuron_idx) {
+  assert(neuron_idx >= unmapped && neuron_idx < (int)input.size());
+  cc_map.at(cc) = neuron_idx;
+}
+const std::vector<int> &MidiReceiver::get_input() { return input; }
+
+// Methods
+
+void MidiReceiver::prepare(int max_neurons) { input.reserve(max_neurons); }
+
+// new neurons listen to the next note up from middle C, if it is free
+void MidiReceiver::add_neuron() {
+  int neuron_idx = static_cast<int>(input.size());
+  input.push_back(0);
+  int note = default_base_note + neuron_idx;
+  if (note < 128 && note_map.at(note) == unmapped) {
+    note_map.at(note) = neuron_idx;
+  }
+}
+void MidiReceiver::remove_neuron() { remove_neuron_at(input.size() - 1); }
+void MidiReceiver::remove_neuron_at(int index) {
+  input.erase(input.begin() + index);
+  for (auto *map : {&note_map, &cc_map}) {
+    for (int &neuron_idx : *map) {
+      if (neuron_idx == index) {
+        neuron_idx = unmapped;
+      } else if (neuron_idx > index) {
+        --neuron_idx;
+      }
+    }
+  }
+}
+
+// Called on the audio thread before a block is read. The host may have
+// reused the last block's buffer, so any event held from it is dropped. Input
+// left from before MIDI in was switched on or off is cleared here rather than
+// where it is switched, as the audio thread may be reading it.
+void MidiReceiver::start_block(bool is_receiving) {
+  has_next_event = false;
+  if (is_receiving != was_receiving) {
+    clear_input();
+    was_receiving = is_receiving;
+  }
+}
+
+// Reads the events before `end_sample` into the input. Call it with the
+// same iterator for each tick in the block, and with `end_of_block` once the
+// block is done so that late events carry over to the next tick.
+void MidiReceiver::read_events(MidiBuffer::Iterator &events, int end_sample) {
+  while (true) {
+    if (!has_next_event) {
+      if (!events.getNextEvent(next_event_data, next_event_size,
+                               next_event_time)) {
+        return;
+      }
+      has_next_event = true;
+    }
+    if (next_event_time >= end_sample) {
+      return;
+    }
+    read_event(next_event_data, next_event_size);
+    has_next_event = false;
+  }
+}
+
+void MidiReceiver::read_event(const uint8 *data, int num_bytes) {
+  if (num_bytes < 3) {
+    return;
+  }
+  int status = data[0] & 0xf0;
+  if (status == 0x90) {
+    excite(note_map[data[1] & 0x7f], data[2]);
+  } else if (status == 0xb0) {
+    excite(cc_map[data[1] & 0x7f], data[2]);
+  }
+}
+
+void MidiReceiver::clear_input() {
+  std::fill(input.begin(), input.end(), 0);
+}
+
+// Private Methods
+
+void MidiReceiver::excite(int neuron_idx, int value) {
+  if (neuron_idx == unmapped || value == 0) {
+    return;
+  }
+  int &neuron_input = input[neuron_idx];
+  if (value > neuron_input) {
+    neuron_input = value;
+  }
+}
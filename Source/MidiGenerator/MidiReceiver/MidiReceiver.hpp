@@ -0,0 +1,71 @@
+/*
+ * MidiReceiver.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include <array>
+#include <limits>
+#include <vector>
+
+/*
+ * MIDI Receiver
+ *
+ * Turns incoming MIDI into input for the brain. Note ons and CCs are mapped to
+ * neurons (any channel), and the note velocity or CC value becomes the input
+ * for that neuron. Events that arrive between two ticks are coalesced by
+ * keeping the largest value per neuron, and the input is cleared once the tick
+ * has used it.
+ *
+ * Events are read straight from the host's MidiBuffer as raw bytes, holding on
+ * to at most one event that is due after the current tick, so the block is read
+ * in a single pass without allocating. The held event points into the host's
+ * buffer, so it is let go at the start of every block, which is also when the
+ * audio thread clears the input if MIDI in has been switched on or off.
+ */
+
+class MidiReceiver {
+public:
+  MidiReceiver(int num_neurons);
+  ~MidiReceiver();
+
+  static constexpr int unmapped{-1};
+  static constexpr int default_base_note{60};
+  static constexpr int end_of_block{std::numeric_limits<int>::max()};
+
+  // Getters & Setters
+  int get_note_neuron(int note);
+  void set_note_neuron(int note, int neuron_idx);
+  int get_cc_neuron(int cc);
+  void set_cc_neuron(int cc, int neuron_idx);
+  const std::vector<int> &get_input();
+
+  // Methods
+  void prepare(int max_neurons);
+  void add_neuron();
+  void remove_neuron();
+  void remove_neuron_at(int index);
+
+  void start_block(bool is_receiving);
+  void read_events(MidiBuffer::Iterator &events, int end_sample);
+  void read_event(const uint8 *data, int num_bytes);
+  void clear_input();
+
+private:
+  std::array<int, 128> note_map;
+  std::array<int, 128> cc_map;
+  std::vector<int> input;
+
+  // the next event in the block, read but not yet due
+  const uint8 *next_event_data;
+  int next_event_size;
+  int next_event_time;
+  bool has_next_event;
+  bool was_receiving;
+
+  void excite(int neuron_idx, int value);
+};
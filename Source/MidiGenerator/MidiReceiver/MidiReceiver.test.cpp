@@ -0,0 +1,120 @@
+/*
+ * MidiReceiver.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiReceiver.hpp"
+
+class MidiReceiverTests : public UnitTest {
+public:
+  MidiReceiverTests() : UnitTest("MidiReceiver Testing") {}
+
+  void runTest() override {
+    MidiReceiver receiver(3);
+
+    // == Instantiation ==
+    beginTest("Instantiation");
+
+    expect(receiver.get_input() == std::vector<int>{0, 0, 0},
+           "input should start empty");
+    expect(receiver.get_note_neuron(60) == 0, "C4 should map to neuron 0");
+    expect(receiver.get_note_neuron(61) == 1, "C#4 should map to neuron 1");
+    expect(receiver.get_note_neuron(62) == 2, "D4 should map to neuron 2");
+    expect(receiver.get_note_neuron(63) == MidiReceiver::unmapped,
+           "D#4 should not be mapped");
+    expect(receiver.get_cc_neuron(1) == MidiReceiver::unmapped,
+           "CCs should not be mapped");
+
+    // == read_event ==
+    beginTest("read_event - notes and CCs");
+
+    receiver.set_cc_neuron(74, 2);
+    MidiMessage note_on = MidiMessage::noteOn(1, 61, (uint8)90);
+    MidiMessage cc = MidiMessage::controllerEvent(5, 74, 40);
+    MidiMessage note_off = MidiMessage::noteOff(1, 60, (uint8)90);
+    receiver.read_event(note_on.getRawData(), note_on.getRawDataSize());
+    receiver.read_event(cc.getRawData(), cc.getRawDataSize());
+    receiver.read_event(note_off.getRawData(), note_off.getRawDataSize());
+    expect(receiver.get_input() == std::vector<int>{0, 90, 40},
+           "velocity and CC value should be the input");
+
+    receiver.clear_input();
+    expect(receiver.get_input() == std::vector<int>{0, 0, 0},
+           "input should have been cleared");
+
+    beginTest("read_events - events are coalesced between ticks");
+
+    MidiBuffer events;
+    events.addEvent(MidiMessage::noteOn(1, 60, (uint8)30), 3);
+    events.addEvent(MidiMessage::noteOn(2, 60, (uint8)80), 5);
+    events.addEvent(MidiMessage::noteOn(3, 60, (uint8)50), 9);
+    events.addEvent(MidiMessage::noteOn(1, 62, (uint8)20), 10);
+    events.addEvent(MidiMessage::noteOn(1, 61, (uint8)70), 40);
+
+    MidiBuffer::Iterator iterator(events);
+    receiver.read_events(iterator, 11);
+    expect(receiver.get_input() == std::vector<int>{80, 0, 20},
+           "loudest event before the tick should win");
+    receiver.clear_input();
+
+    receiver.read_events(iterator, 20);
+    expect(receiver.get_input() == std::vector<int>{0, 0, 0},
+           "event after the tick should wait");
+    receiver.read_events(iterator, MidiReceiver::end_of_block);
+    expect(receiver.get_input() == std::vector<int>{0, 70, 0},
+           "late event should carry over to the next tick");
+    receiver.clear_input();
+
+    beginTest("start_block - the last block's events are let go");
+
+    // the host reuses its buffer, and the event held from it is gone
+    receiver.start_block(true);
+    MidiBuffer block;
+    block.addEvent(MidiMessage::noteOn(1, 60, (uint8)30), 3);
+    block.addEvent(MidiMessage::noteOn(1, 61, (uint8)70), 40);
+    MidiBuffer::Iterator block_events(block);
+    receiver.read_events(block_events, 20);
+    receiver.clear_input();
+    block.clear();
+    block.addEvent(MidiMessage::noteOn(1, 62, (uint8)50), 8);
+
+    receiver.start_block(true);
+    MidiBuffer::Iterator next_block_events(block);
+    receiver.read_events(next_block_events, MidiReceiver::end_of_block);
+    expect(receiver.get_input() == std::vector<int>{0, 0, 50},
+           "only the new block's events should be read");
+
+    beginTest("start_block - input is cleared when MIDI in is switched");
+
+    receiver.start_block(true);
+    expect(receiver.get_input() == std::vector<int>{0, 0, 50},
+           "input should carry over while MIDI in stays on");
+    receiver.start_block(false);
+    expect(receiver.get_input() == std::vector<int>{0, 0, 0},
+           "input should be cleared when MIDI in is switched off");
+
+    // == add_neuron, remove_neuron_at ==
+    beginTest("add_neuron / remove_neuron_at");
+
+    receiver.add_neuron();
+    expect(receiver.get_input().size() == 4, "input should have grown");
+    expect(receiver.get_note_neuron(63) == 3, "D#4 should map to neuron 3");
+
+    receiver.remove_neuron_at(1);
+    expect(receiver.get_input().size() == 3, "input should have shrunk");
+    expect(receiver.get_note_neuron(60) == 0, "C4 should still map to 0");
+    expect(receiver.get_note_neuron(61) == MidiReceiver::unmapped,
+           "C#4's neuron was removed");
+    expect(receiver.get_note_neuron(62) == 1, "D4 should follow its neuron");
+    expect(receiver.get_note_neuron(63) == 2, "D#4 should follow its neuron");
+    expect(receiver.get_cc_neuron(74) == 1, "CC should follow its neuron");
+
+    receiver.remove_neuron();
+    expect(receiver.get_note_neuron(63) == MidiReceiver::unmapped,
+           "D#4's neuron was removed");
+  };
+};
+
+static MidiReceiverTests test;
@@ -0,0 +1,261 @@
+/*
+ * MidiScheduler.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiScheduler.hpp"
+
+MidiScheduler::MidiScheduler(int capacity)
+    : current_time{0}, pending{0}, free_list{-1}, lost_channels{0},
+      events(capacity) {
+  occupied.fill(0);
+  for (int i = capacity - 1; i >= 0; --i) {
+    events.at(i).next = free_list;
+    free_list = i;
+  }
+};
+MidiScheduler::~MidiScheduler(){};
+
+/*
+ * Getters
+ */
+
+int MidiScheduler::get_capacity() { return static_cast<int>(events.size()); }
+int MidiScheduler::num_pending() { return pending; }
+int64 MidiScheduler::get_current_time() { return current_time; }
+
+bool MidiScheduler::is_pending(EventId id) {
+  if (id.index < 0 || id.index >= get_capacity()) {
+    return false;
+  }
+  const Event &e = events[id.index];
+  return e.bucket != free_bucket && e.generation == id.generation;
+}
+
+/*
+ * Methods
+ */
+
+MidiScheduler::EventId MidiScheduler::schedule(const MidiMessage &m,
+                                               int64 sample_time) {
+  jassert(m.getRawDataSize() <= 3);
+  if (free_list < 0) {
+    int channel = m.getChannel();
+    if (channel > 0) {
+      lost_channels |= static_cast<uint16>(1 << (channel - 1));
+    }
+    return EventId{};
+  }
+
+  int index = free_list;
+  Event &e = events[index];
+  free_list = e.next;
+
+  e.time = sample_time < current_time ? current_time : sample_time;
+  e.size = static_cast<uint8>(jmin(m.getRawDataSize(), 3));
+  std::copy(m.getRawData(), m.getRawData() + e.size, e.data);
+  link(index);
+  ++pending;
+
+  return EventId{index, e.generation};
+}
+
+bool MidiScheduler::cancel(EventId id) {
+  if (!is_pending(id)) {
+    return false;
+  }
+  unlink(id.index);
+  release(id.index);
+  return true;
+}
+
+void MidiScheduler::render_buffer(MidiBuffer &buffer, int64 block_start,
+                                  int end_sample) {
+  int64 end_time = block_start + end_sample;
+  while (current_time < end_time) {
+    if (pending == 0) {
+      current_time = end_time;
+      return;
+    }
+    if ((current_time & slot_mask) == 0) {
+      for (int level = num_levels; level > 0; --level) {
+        int64 level_mask = (static_cast<int64>(1) << (slot_bits * level)) - 1;
+        if ((current_time & level_mask) == 0) {
+          cascade(level);
+        }
+      }
+    }
+    expire(buffer, block_start);
+    current_time = jmin(next_due_time(), end_time);
+  }
+}
+
+void MidiScheduler::flush(MidiBuffer &buffer, int sample_num) {
+  if (pending > 0) {
+    for (int i = 0; i < get_capacity(); ++i) {
+      Event &e = events[i];
+      if (e.bucket == free_bucket) {
+        continue;
+      }
+      MidiMessage m(e.data, e.size);
+      if (m.isNoteOff()) {
+        buffer.addEvent(m, sample_num);
+      }
+      unlink(i);
+      release(i);
+    }
+  }
+
+  for (int channel = 1; channel <= 16; ++channel) {
+    if (lost_channels & (1 << (channel - 1))) {
+      buffer.addEvent(MidiMessage::allNotesOff(channel), sample_num);
+    }
+  }
+  lost_channels = 0;
+}
+
+void MidiScheduler::reset(int64 new_time) {
+  jassert(pending == 0);
+  current_time = new_time;
+}
+
+/*
+ * Private Methods
+ */
+
+int MidiScheduler::bucket_for(int64 time) {
+  uint64 diff = static_cast<uint64>(time ^ current_time);
+  for (int level = 0; level < num_levels; ++level) {
+    if ((diff >> (slot_bits * (level + 1))) == 0) {
+      int slot = static_cast<int>(time >> (slot_bits * level)) & slot_mask;
+      return level * num_slots + slot;
+    }
+  }
+  return overflow_bucket;
+}
+
+void MidiScheduler::link(int index) {
+  Event &e = events[index];
+  e.bucket = bucket_for(e.time);
+  Bucket &b = buckets[e.bucket];
+  e.prev = b.tail;
+  e.next = -1;
+  if (b.tail >= 0) {
+    events[b.tail].next = index;
+  } else {
+    b.head = index;
+  }
+  b.tail = index;
+  set_occupied(e.bucket, true);
+}
+
+void MidiScheduler::unlink(int index) {
+  Event &e = events[index];
+  Bucket &b = buckets[e.bucket];
+  if (e.prev >= 0) {
+    events[e.prev].next = e.next;
+  } else {
+    b.head = e.next;
+  }
+  if (e.next >= 0) {
+    events[e.next].prev = e.prev;
+  } else {
+    b.tail = e.prev;
+  }
+  if (b.head < 0) {
+    set_occupied(e.bucket, false);
+  }
+  e.prev = -1;
+  e.next = -1;
+}
+
+void MidiScheduler::release(int index) {
+  Event &e = events[index];
+  ++e.generation;
+  e.bucket = free_bucket;
+  e.prev = -1;
+  e.next = free_list;
+  free_list = index;
+  --pending;
+}
+
+void MidiScheduler::set_occupied(int bucket, bool is_occupied) {
+  if (bucket == overflow_bucket) {
+    return;
+  }
+  uint64 bit = uint64{1} << (bucket % 64);
+  if (is_occupied) {
+    occupied[bucket / 64] |= bit;
+  } else {
+    occupied[bucket / 64] &= ~bit;
+  }
+}
+
+// The first slot of `level` from `first_slot` on that holds events, or -1.
+int MidiScheduler::next_occupied(int level, int first_slot) {
+  for (int slot = first_slot; slot < num_slots; slot = (slot | 63) + 1) {
+    int bucket = level * num_slots + slot;
+    uint64 word = occupied[bucket / 64] >> (bucket % 64);
+    if (word != 0) {
+      return slot + __builtin_ctzll(word);
+    }
+  }
+  return -1;
+}
+
+// The next time after the current time that an event expires, or that a
+// coarser slot holding events is cascaded. Events at level 0 are in the
+// current level 0 rotation, events at level 1 in later slots of the current
+// level 1 rotation and so on, so the first occupied slot found going up the
+// levels is the soonest.
+int64 MidiScheduler::next_due_time() {
+  for (int level = 0; level < num_levels; ++level) {
+    int shift = slot_bits * level;
+    int slot = static_cast<int>(current_time >> shift) & slot_mask;
+    int next_slot = next_occupied(level, slot + 1);
+    if (next_slot >= 0) {
+      int64 rotation = (current_time >> (shift + slot_bits))
+                       << (shift + slot_bits);
+      return rotation + (static_cast<int64>(next_slot) << shift);
+    }
+  }
+  // only overflowed events, which are looked at as the top level turns
+  int shift = slot_bits * num_levels;
+  return ((current_time >> shift) + 1) << shift;
+}
+
+// Re-files the events in the current slot of `level` relative to the current
+// time, which moves them to a finer level (or leaves them in the overflow
+// bucket if they are still too far away).
+void MidiScheduler::cascade(int level) {
+  int bucket = overflow_bucket;
+  if (level < num_levels) {
+    int slot =
+        static_cast<int>(current_time >> (slot_bits * level)) & slot_mask;
+    bucket = level * num_slots + slot;
+  }
+
+  int index = buckets[bucket].head;
+  buckets[bucket] = Bucket{};
+  set_occupied(bucket, false);
+  while (index >= 0) {
+    int next = events[index].next;
+    link(index);
+    index = next;
+  }
+}
+
+void MidiScheduler::expire(MidiBuffer &buffer, int64 block_start) {
+  Bucket &b = buckets[static_cast<int>(current_time & slot_mask)];
+  while (b.head >= 0) {
+    int index = b.head;
+    Event &e = events[index];
+    jassert(e.time == current_time);
+    int sample_num = static_cast<int>(jmax(e.time - block_start, int64{0}));
+    buffer.addEvent(e.data, e.size, sample_num);
+    unlink(index);
+    release(index);
+  }
+}
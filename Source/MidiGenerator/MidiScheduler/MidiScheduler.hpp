@@ -0,0 +1,97 @@
+/*
+ * MidiScheduler.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include <array>
+#include <vector>
+
+/*
+ * MIDI Scheduler
+ *
+ * Holds MIDI events that are due in the future (e.g. note offs) and renders
+ * them into the MidiBuffer of the block they fall in. Events are keyed by
+ * absolute sample time (the host's `timeInSamples`) and stored in a
+ * hierarchical timing wheel: 4 levels of 256 slots, where each level is 256
+ * times coarser than the one below it. Events are moved down a level as the
+ * wheel turns, so scheduling and expiring an event are both O(1). A bitmap of
+ * the slots holding events lets rendering jump straight to the next slot that
+ * is due, rather than stepping through every sample of the block.
+ *
+ * All event storage is preallocated, the scheduler never allocates once it is
+ * constructed. If the pool runs out the event is dropped and the channel is
+ * remembered so that `flush` can send an all-notes-off for it.
+ */
+
+class MidiScheduler {
+public:
+  struct EventId {
+    int index{-1};
+    uint32 generation{0};
+  };
+
+  MidiScheduler(int capacity = default_capacity);
+  ~MidiScheduler();
+
+  static constexpr int default_capacity{1024};
+
+  // Getters
+  int get_capacity();
+  int num_pending();
+  int64 get_current_time();
+  bool is_pending(EventId id);
+
+  // Methods
+  EventId schedule(const MidiMessage &m, int64 sample_time);
+  bool cancel(EventId id);
+  void render_buffer(MidiBuffer &buffer, int64 block_start, int end_sample);
+  void flush(MidiBuffer &buffer, int sample_num);
+  void reset(int64 new_time);
+
+private:
+  static constexpr int num_levels{4};
+  static constexpr int slot_bits{8};
+  static constexpr int num_slots{1 << slot_bits};
+  static constexpr int slot_mask{num_slots - 1};
+  static constexpr int overflow_bucket{num_levels * num_slots};
+  static constexpr int free_bucket{-1};
+
+  struct Event {
+    int64 time{0};
+    uint8 data[3]{0, 0, 0};
+    uint8 size{0};
+    uint32 generation{0};
+    int bucket{free_bucket};
+    int prev{-1};
+    int next{-1};
+  };
+
+  struct Bucket {
+    int head{-1};
+    int tail{-1};
+  };
+
+  int64 current_time;
+  int pending;
+  int free_list;
+  uint16 lost_channels;
+  std::vector<Event> events;
+  std::array<Bucket, num_levels * num_slots + 1> buckets;
+  // a bit for each of the wheel's buckets (not the overflow) holding events
+  std::array<uint64, num_levels * num_slots / 64> occupied;
+
+  int bucket_for(int64 time);
+  void link(int index);
+  void unlink(int index);
+  void release(int index);
+  void set_occupied(int bucket, bool is_occupied);
+  int next_occupied(int level, int first_slot);
+  int64 next_due_time();
+  void cascade(int level);
+  void expire(MidiBuffer &buffer, int64 block_start);
+};
@@ -0,0 +1,169 @@
+/*
+ * MidiScheduler.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "MidiScheduler.hpp"
+
+class MidiSchedulerTests : public UnitTest {
+public:
+  MidiSchedulerTests() : UnitTest("MidiScheduler Testing") {}
+
+  void runTest() override {
+    MidiScheduler scheduler(4);
+
+    // == Instantiation ==
+    beginTest("Instantiation");
+
+    expect(scheduler.get_capacity() == 4, "scheduler has wrong capacity");
+    expect(scheduler.num_pending() == 0, "scheduler should start empty");
+    expect(scheduler.get_current_time() == 0, "scheduler should start at 0");
+
+    // == render_buffer ==
+    beginTest("render_buffer - events within a block");
+
+    MidiBuffer buffer;
+    scheduler.schedule(MidiMessage::noteOff(1, 60), 10);
+    scheduler.schedule(MidiMessage::noteOff(1, 64), 20);
+    expect(scheduler.num_pending() == 2, "should have 2 pending events");
+
+    scheduler.render_buffer(buffer, 0, 64);
+    expect(buffer.getNumEvents() == 2, "Wrong number of MIDI events");
+    expect(buffer.getFirstEventTime() == 10, "first event at wrong sample");
+    expect(buffer.getLastEventTime() == 20, "last event at wrong sample");
+    expect(scheduler.num_pending() == 0, "events should have been expired");
+    expect(scheduler.get_current_time() == 64, "time should have advanced");
+
+    beginTest("render_buffer - events across block boundaries");
+
+    buffer.clear();
+    scheduler.schedule(MidiMessage::noteOff(1, 60), 100);
+    scheduler.render_buffer(buffer, 64, 32);
+    expect(buffer.getNumEvents() == 0, "event rendered too early");
+    scheduler.render_buffer(buffer, 96, 32);
+    expect(buffer.getNumEvents() == 1, "event not rendered in its block");
+    expect(buffer.getFirstEventTime() == 4, "event at wrong block offset");
+
+    beginTest("render_buffer - events on coarser wheel levels");
+
+    int64 block_start = scheduler.get_current_time();
+    int block_size = 512;
+    scheduler.schedule(MidiMessage::noteOff(1, 60), block_start + 300);
+    scheduler.schedule(MidiMessage::noteOff(1, 61), block_start + 70000);
+    scheduler.schedule(MidiMessage::noteOff(1, 62), block_start + 20000000);
+
+    std::vector<int64> rendered_times;
+    for (int block = 0; block < 40000; ++block) {
+      buffer.clear();
+      scheduler.render_buffer(buffer, block_start, block_size);
+      if (!buffer.isEmpty()) {
+        rendered_times.push_back(block_start + buffer.getFirstEventTime());
+      }
+      block_start += block_size;
+      if (scheduler.num_pending() == 0) {
+        break;
+      }
+    }
+    expect(rendered_times.size() == 3, "not every event was rendered");
+    expect(rendered_times.at(0) == 128 + 300, "near event at wrong time");
+    expect(rendered_times.at(1) == 128 + 70000, "far event at wrong time");
+    expect(rendered_times.at(2) == 128 + 20000000, "v. far event wrong time");
+
+    beginTest("render_buffer - sparse events in one long block");
+
+    // rendering jumps from slot to slot, so each lands on its own sample
+    MidiScheduler sparse_scheduler(8);
+    const int64 offsets[]{5, 255, 256, 300, 65536, 70000, 16000000};
+    for (int64 offset : offsets) {
+      sparse_scheduler.schedule(MidiMessage::noteOff(1, 60), offset);
+    }
+    buffer.clear();
+    sparse_scheduler.render_buffer(buffer, 0, 1 << 24);
+    expect(sparse_scheduler.num_pending() == 0, "not every event was rendered");
+    expect(sparse_scheduler.get_current_time() == 1 << 24,
+           "time should be at the end of the block");
+    std::vector<int64> sparse_times;
+    MidiMessage m;
+    int time;
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      sparse_times.push_back(time);
+    }
+    expect(sparse_times == std::vector<int64>(std::begin(offsets),
+                                              std::end(offsets)),
+           "sparse events at the wrong samples");
+
+    beginTest("schedule - events in the past are due immediately");
+
+    buffer.clear();
+    int64 now = scheduler.get_current_time();
+    scheduler.schedule(MidiMessage::noteOff(1, 60), now - 50);
+    scheduler.render_buffer(buffer, now, 16);
+    expect(buffer.getNumEvents() == 1, "past event was not rendered");
+    expect(buffer.getFirstEventTime() == 0, "past event at wrong sample");
+
+    // == cancel ==
+    beginTest("cancel");
+
+    buffer.clear();
+    now = scheduler.get_current_time();
+    MidiScheduler::EventId id =
+        scheduler.schedule(MidiMessage::noteOff(1, 60), now + 8);
+    expect(scheduler.is_pending(id), "event should be pending");
+    expect(scheduler.cancel(id), "pending event should cancel");
+    expect(!scheduler.is_pending(id), "cancelled event is still pending");
+    expect(!scheduler.cancel(id), "event should only cancel once");
+    scheduler.render_buffer(buffer, now, 16);
+    expect(buffer.isEmpty(), "cancelled event was rendered");
+
+    id = scheduler.schedule(MidiMessage::noteOff(1, 60), now + 20);
+    scheduler.render_buffer(buffer, now + 16, 16);
+    expect(!scheduler.is_pending(id), "expired event is still pending");
+    expect(!scheduler.cancel(id), "expired event should not cancel");
+
+    // == flush ==
+    beginTest("flush");
+
+    buffer.clear();
+    now = scheduler.get_current_time();
+    scheduler.schedule(MidiMessage::noteOff(2, 60), now + 1000);
+    scheduler.schedule(MidiMessage::noteOn(2, 64, (uint8)100), now + 1000);
+    scheduler.flush(buffer, 5);
+
+    expect(scheduler.num_pending() == 0, "flush should clear the wheel");
+    expect(buffer.getNumEvents() == 1, "flush should only send note offs");
+    expect(buffer.getFirstEventTime() == 5, "flush at wrong sample");
+
+    beginTest("flush - all notes off for dropped events");
+
+    buffer.clear();
+    for (int i = 0; i < 5; ++i) {
+      scheduler.schedule(MidiMessage::noteOff(3, 60 + i), now + 1000);
+    }
+    expect(scheduler.num_pending() == 4, "pool should be full");
+    scheduler.flush(buffer, 0);
+    expect(buffer.getNumEvents() == 5, "4 note offs and 1 all notes off");
+
+    int num_all_notes_off{0};
+    for (MidiBuffer::Iterator i(buffer); i.getNextEvent(m, time);) {
+      if (m.isAllNotesOff()) {
+        ++num_all_notes_off;
+        expect(m.getChannel() == 3, "all notes off on wrong channel");
+      }
+    }
+    expect(num_all_notes_off == 1, "should send one all notes off");
+
+    // == reset ==
+    beginTest("reset");
+
+    scheduler.reset(905984);
+    expect(scheduler.get_current_time() == 905984, "reset to wrong time");
+    buffer.clear();
+    scheduler.schedule(MidiMessage::noteOff(1, 60), 905984 + 3);
+    scheduler.render_buffer(buffer, 905984, 8);
+    expect(buffer.getFirstEventTime() == 3, "event at wrong sample");
+  };
+};
+
+static MidiSchedulerTests test;
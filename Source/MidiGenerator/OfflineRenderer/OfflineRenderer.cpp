@@ -0,0 +1,190 @@
+/*
+ * OfflineRenderer.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "OfflineRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+OfflineRenderer::OfflineRenderer(double sample_rate, int block_size)
+    : sample_rate{sample_rate}, block_size{block_size},
+      time_sig_numerator{4}, time_sig_denominator{4} {
+  jassert(sample_rate > 0 && block_size > 0);
+  fastForward.set_synchronous(true);
+  set_tempo_map({{0.0, 120.0}});
+}
+OfflineRenderer::~OfflineRenderer() {}
+
+/*
+ * Getters & Setters
+ */
+
+// The tempo from each change until the next. A map that doesn't start at the
+// start of the song starts with its first tempo.
+void OfflineRenderer::set_tempo_map(const std::vector<TempoChange> &changes) {
+  std::vector<TempoChange> sorted{changes};
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const TempoChange &a, const TempoChange &b) {
+                     return a.ppq < b.ppq;
+                   });
+  if (sorted.empty()) {
+    sorted.push_back({0.0, 120.0});
+  }
+
+  segments.clear();
+  segments.push_back({0.0, sorted.front().bpm, 0.0});
+  for (const TempoChange &change : sorted) {
+    jassert(change.bpm > 0);
+    Segment &last = segments.back();
+    if (change.ppq <= last.ppq) {
+      last.bpm = change.bpm;
+      continue;
+    }
+    double sample = last.sample + (change.ppq - last.ppq) *
+                                      get_samples_per_quarter(last.bpm);
+    segments.push_back({change.ppq, change.bpm, sample});
+  }
+}
+
+void OfflineRenderer::set_time_signature(int numerator, int denominator) {
+  jassert(numerator > 0 && denominator > 0);
+  time_sig_numerator = numerator;
+  time_sig_denominator = denominator;
+}
+
+double OfflineRenderer::get_sample_rate() { return sample_rate; }
+
+double OfflineRenderer::get_bpm_at(int64 sample) {
+  return get_segment_at_sample(static_cast<double>(sample)).bpm;
+}
+
+double OfflineRenderer::get_ppq_at(int64 sample) {
+  const Segment &segment = get_segment_at_sample(static_cast<double>(sample));
+  return segment.ppq +
+         (sample - segment.sample) / get_samples_per_quarter(segment.bpm);
+}
+
+int64 OfflineRenderer::get_sample_at(double ppq) {
+  const Segment &segment = get_segment_at_ppq(ppq);
+  return static_cast<int64>(std::llround(
+      segment.sample +
+      (ppq - segment.ppq) * get_samples_per_quarter(segment.bpm)));
+}
+
+// The first sample of the bar, counting bars from 0.
+int64 OfflineRenderer::get_bar_sample(int bar) {
+  return get_sample_at(bar * time_sig_numerator * 4.0 / time_sig_denominator);
+}
+
+/*
+ * Methods
+ */
+
+// Plays the generator from the start of the song for `num_samples`, adding
+// what it plays to `rendered`, timed in samples. Anything still scheduled when
+// the render stops (e.g. the note offs of held notes) is let go at the end.
+void OfflineRenderer::render(MidiGenerator &generator, int64 num_samples,
+                             MidiMessageSequence &rendered) {
+  generator.prepare(sample_rate, block_size,
+                    MidiGenerator::default_max_neurons);
+  generator.set_fast_forward(&fastForward);
+
+  MidiBuffer block;
+  block.ensureSize(generator.get_max_midi_buffer_bytes());
+  MidiBuffer no_input;
+  auto add_block = [&rendered, &block](int64 start) {
+    MidiMessage message;
+    int time;
+    for (MidiBuffer::Iterator i(block); i.getNextEvent(message, time);) {
+      double sample = static_cast<double>(start + time);
+      rendered.addEvent(MidiMessage(message, sample));
+    }
+  };
+
+  AudioPlayHead::CurrentPositionInfo pos;
+  pos.isPlaying = true;
+  pos.timeSigNumerator = time_sig_numerator;
+  pos.timeSigDenominator = time_sig_denominator;
+  double quarters_per_bar = time_sig_numerator * 4.0 / time_sig_denominator;
+
+  for (int64 start = 0; start < num_samples; start += block_size) {
+    int num_block_samples =
+        static_cast<int>(jmin<int64>(block_size, num_samples - start));
+    pos.timeInSamples = start;
+    pos.timeInSeconds = start / sample_rate;
+    pos.bpm = get_bpm_at(start);
+    pos.ppqPosition = get_ppq_at(start);
+    pos.ppqPositionOfLastBarStart =
+        std::floor(pos.ppqPosition / quarters_per_bar) * quarters_per_bar;
+
+    block.clear();
+    if (generator.get_is_on()) {
+      generator.generate_next_midi_buffer(block, no_input, pos, sample_rate,
+                                          num_block_samples);
+    } else {
+      generator.flush_scheduled_midi(block);
+    }
+    add_block(start);
+  }
+  block.clear();
+  generator.flush_scheduled_midi(block);
+  add_block(num_samples);
+
+  generator.set_fast_forward(nullptr);
+  rendered.updateMatchedPairs();
+}
+
+// A type 1 file with the tempo map and time signature in the first track and
+// the rendered events in the second, each at the tick nearest its sample.
+void OfflineRenderer::to_midi_file(const MidiMessageSequence &rendered,
+                                   MidiFile &file, int ticks_per_quarter) {
+  file.clear();
+  file.setTicksPerQuarterNote(ticks_per_quarter);
+
+  MidiMessageSequence conductor;
+  conductor.addEvent(MidiMessage::timeSignatureMetaEvent(
+      time_sig_numerator, time_sig_denominator));
+  for (const Segment &segment : segments) {
+    conductor.addEvent(MidiMessage::tempoMetaEvent(
+                           roundToInt(60000000.0 / segment.bpm)),
+                       std::round(segment.ppq * ticks_per_quarter));
+  }
+
+  MidiMessageSequence events;
+  for (int i = 0; i < rendered.getNumEvents(); ++i) {
+    const MidiMessage &message = rendered.getEventPointer(i)->message;
+    double ppq = get_ppq_at(static_cast<int64>(message.getTimeStamp()));
+    events.addEvent(
+        MidiMessage(message, std::round(ppq * ticks_per_quarter)));
+  }
+
+  file.addTrack(conductor);
+  file.addTrack(events);
+}
+
+/*
+ * Private Methods
+ */
+
+const OfflineRenderer::Segment &
+OfflineRenderer::get_segment_at_sample(double sample) {
+  auto after = std::upper_bound(
+      segments.begin() + 1, segments.end(), sample,
+      [](double s, const Segment &segment) { return s < segment.sample; });
+  return *(after - 1);
+}
+
+const OfflineRenderer::Segment &
+OfflineRenderer::get_segment_at_ppq(double ppq) {
+  auto after = std::upper_bound(
+      segments.begin() + 1, segments.end(), ppq,
+      [](double p, const Segment &segment) { return p < segment.ppq; });
+  return *(after - 1);
+}
+
+double OfflineRenderer::get_samples_per_quarter(double bpm) {
+  return 60.0 / bpm * sample_rate;
+}
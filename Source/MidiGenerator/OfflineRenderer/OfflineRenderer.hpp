@@ -0,0 +1,81 @@
+/*
+ * OfflineRenderer.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../FastForward/FastForward.hpp"
+#include "../MidiGenerator.hpp"
+#include <vector>
+
+/*
+ * Offline Renderer
+ *
+ * Plays a generator without a host, as fast as it will go, for rendering to a
+ * MIDI file. It stands in for the host: block by block it reports the
+ * position, tempo and time signature from its tempo map and calls
+ * generate_next_midi_buffer just as processBlock does, so what it renders is
+ * what the plugin would play, to the sample.
+ *
+ * Like a host, the tempo reported for a block is the tempo at its first
+ * sample, along with the beat position the generator counts its ticks in, so
+ * ticks stay on the beat through tempo changes. Fast forwards are worked out
+ * synchronously, as when a host renders offline.
+ *
+ * The rendered events are timed in samples from the start of the song. A MIDI
+ * file times them in ticks of a quarter note, so to_midi_file converts them
+ * with the tempo map and writes the tempo map and time signature along with
+ * them.
+ */
+
+class OfflineRenderer {
+public:
+  struct TempoChange {
+    double ppq; // in quarter notes from the start of the song
+    double bpm;
+  };
+
+  OfflineRenderer(double sample_rate, int block_size = default_block_size);
+  ~OfflineRenderer();
+
+  static constexpr int default_block_size{512};
+  static constexpr int default_ticks_per_quarter{960};
+
+  // Getters & Setters
+  void set_tempo_map(const std::vector<TempoChange> &changes);
+  void set_time_signature(int numerator, int denominator);
+  double get_sample_rate();
+  double get_bpm_at(int64 sample);
+  double get_ppq_at(int64 sample);
+  int64 get_sample_at(double ppq);
+  int64 get_bar_sample(int bar);
+
+  // Methods
+  void render(MidiGenerator &generator, int64 num_samples,
+              MidiMessageSequence &rendered);
+  void to_midi_file(const MidiMessageSequence &rendered, MidiFile &file,
+                    int ticks_per_quarter = default_ticks_per_quarter);
+
+private:
+  struct Segment {
+    double ppq;
+    double bpm;
+    double sample; // where the segment starts
+  };
+
+  double sample_rate;
+  int block_size;
+  int time_sig_numerator, time_sig_denominator;
+  std::vector<Segment> segments;
+  FastForward fastForward;
+
+  const Segment &get_segment_at_sample(double sample);
+  const Segment &get_segment_at_ppq(double ppq);
+  double get_samples_per_quarter(double bpm);
+
+  JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
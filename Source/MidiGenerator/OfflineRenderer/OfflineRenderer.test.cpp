@@ -0,0 +1,205 @@
+/*
+ * OfflineRenderer.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "OfflineRenderer.hpp"
+
+class OfflineRendererTests : public UnitTest {
+public:
+  OfflineRendererTests() : UnitTest("OfflineRenderer Testing") {}
+
+  std::unique_ptr<MidiGenerator> make_generator() {
+    auto generator = std::make_unique<MidiGenerator>(3);
+    generator->toggleOnOff(); // generators start off
+    generator->set_subdivision(4);
+    for (int i = 0; i < 3; ++i) {
+      generator->set_neuron_midi_note(i, 60 + i);
+      generator->set_neuron_input_weight(i, i + 1);
+      generator->set_neuron_threshold(i, 3 + i);
+      for (int j = 0; j < 3; ++j) {
+        generator->set_neuron_connection_weight(i, j, i == j ? -4 - i : 1 + j);
+      }
+    }
+    return generator;
+  }
+
+  std::vector<std::pair<int64, int>>
+  get_note_ons(const MidiMessageSequence &sequence) {
+    std::vector<std::pair<int64, int>> notes;
+    for (int i = 0; i < sequence.getNumEvents(); ++i) {
+      const MidiMessage &m = sequence.getEventPointer(i)->message;
+      if (m.isNoteOn()) {
+        notes.push_back({static_cast<int64>(m.getTimeStamp()),
+                         m.getNoteNumber()});
+      }
+    }
+    return notes;
+  }
+
+  void runTest() override {
+    double sample_rate{44100};
+
+    // == Tempo Map ==
+    beginTest("tempo map - one tempo");
+
+    OfflineRenderer renderer(sample_rate);
+    expect(renderer.get_bpm_at(0) == 120.0, "should default to 120 bpm");
+    expect(renderer.get_sample_at(4.0) == 88200, "a bar should be 2 seconds");
+    expect(renderer.get_ppq_at(11025) == 0.5, "half a beat in");
+    expect(renderer.get_bar_sample(3) == 3 * 88200, "bars should be 4/4");
+
+    beginTest("tempo map - tempo changes");
+
+    renderer.set_tempo_map({{8.0, 60.0}, {0.0, 120.0}});
+    expect(renderer.get_sample_at(8.0) == 176400,
+           "the change should be 8 beats at 120 in");
+    expect(renderer.get_bpm_at(176399) == 120.0 &&
+               renderer.get_bpm_at(176400) == 60.0,
+           "the tempo should change at the change");
+    expect(renderer.get_ppq_at(176400 + 44100) == 9.0,
+           "a beat at 60 bpm should be a second");
+    expect(renderer.get_sample_at(10.0) == 176400 + 2 * 44100,
+           "beats after the change should be at the new tempo");
+
+    beginTest("tempo map - time signature");
+
+    renderer.set_time_signature(3, 4);
+    expect(renderer.get_bar_sample(1) == 66150, "a bar should be 3 beats");
+    renderer.set_time_signature(6, 8);
+    expect(renderer.get_bar_sample(1) == 66150, "a bar should be 6 eighths");
+    renderer.set_time_signature(4, 4);
+    renderer.set_tempo_map({{0.0, 120.0}});
+
+    // == Render ==
+    beginTest("render - plays what the plugin plays");
+
+    int64 num_samples{renderer.get_bar_sample(8)};
+    MidiMessageSequence rendered;
+    auto generator = make_generator();
+    renderer.render(*generator, num_samples, rendered);
+
+    // a host playing from the start in blocks of 512
+    auto hosted = make_generator();
+    hosted->prepare(sample_rate, 512, MidiGenerator::default_max_neurons);
+    AudioPlayHead::CurrentPositionInfo pos;
+    pos.bpm = 120;
+    pos.isPlaying = true;
+    MidiBuffer block, no_input;
+    MidiMessage m;
+    int time;
+    std::vector<std::pair<int64, int>> played;
+    for (int64 t = 0; t < num_samples; t += 512) {
+      block.clear();
+      pos.timeInSamples = t;
+      hosted->generate_next_midi_buffer(block, no_input, pos, sample_rate,
+                                        512);
+      for (MidiBuffer::Iterator i(block); i.getNextEvent(m, time);) {
+        if (m.isNoteOn() && t + time < num_samples) {
+          played.push_back({t + time, m.getNoteNumber()});
+        }
+      }
+    }
+    auto notes = get_note_ons(rendered);
+    expect(!notes.empty(), "the generator should have played notes");
+    expect(notes == played, "the render should match the plugin's output");
+
+    beginTest("render - the same whatever the block size");
+
+    OfflineRenderer small_blocks(sample_rate, 100);
+    MidiMessageSequence small_rendered;
+    auto small_generator = make_generator();
+    small_blocks.render(*small_generator, num_samples, small_rendered);
+    expect(get_note_ons(small_rendered) == notes,
+           "the block size shouldn't change what's played");
+
+    beginTest("render - held notes are let go at the end");
+
+    int num_on{0}, num_off{0};
+    double last_time{0};
+    for (int i = 0; i < rendered.getNumEvents(); ++i) {
+      const MidiMessage &event = rendered.getEventPointer(i)->message;
+      num_on += event.isNoteOn() ? 1 : 0;
+      num_off += event.isNoteOff() ? 1 : 0;
+      last_time = jmax(last_time, event.getTimeStamp());
+    }
+    expect(last_time <= num_samples, "nothing should be after the end");
+    expect(num_on == num_off, "every note on should have a note off");
+
+    beginTest("render - a generator that's off plays nothing");
+
+    MidiMessageSequence silent;
+    auto off = make_generator();
+    off->toggleOnOff();
+    renderer.render(*off, num_samples, silent);
+    expect(get_note_ons(silent).empty(), "nothing should be played");
+
+    beginTest("render - ticks stay on the beat through tempo changes");
+
+    {
+      // a neuron that fires every tick, following the song, with the tempo
+      // changing on a block boundary
+      OfflineRenderer changing(sample_rate, 441);
+      changing.set_tempo_map({{0.0, 120.0}, {8.0, 100.0}});
+      MidiGenerator every_tick(1);
+      every_tick.toggleOnOff();
+      every_tick.toggleFollowsSongPosition();
+      every_tick.set_subdivision(4);
+      every_tick.set_neuron_threshold(0, -1000);
+      MidiMessageSequence ticks;
+      changing.render(every_tick, changing.get_sample_at(16.0), ticks);
+      auto played = get_note_ons(ticks);
+      bool on_the_beat{played.size() == 16 * 4};
+      for (size_t k = 0; k < played.size() && on_the_beat; ++k) {
+        int64 beat_sample = changing.get_sample_at(k / 4.0);
+        on_the_beat = std::abs(played[k].first - beat_sample) <= 1;
+      }
+      expect(on_the_beat, "every tick should play on its sixteenth");
+    }
+
+    // == MIDI File ==
+    beginTest("to_midi_file");
+
+    renderer.set_tempo_map({{0.0, 120.0}, {16.0, 90.0}});
+    renderer.set_time_signature(3, 4);
+    MidiFile file;
+    renderer.to_midi_file(rendered, file, 960);
+    expect(file.getNumTracks() == 2, "should have a conductor and a track");
+    expect(file.getTimeFormat() == 960, "should be in ticks per quarter");
+
+    const MidiMessageSequence *conductor = file.getTrack(0);
+    std::vector<double> tempo_ticks;
+    for (int i = 0; i < conductor->getNumEvents(); ++i) {
+      const MidiMessage &event = conductor->getEventPointer(i)->message;
+      if (event.isTempoMetaEvent()) {
+        tempo_ticks.push_back(event.getTimeStamp());
+      }
+      if (event.isTimeSignatureMetaEvent()) {
+        int numerator, denominator;
+        event.getTimeSignatureInfo(numerator, denominator);
+        expect(numerator == 3 && denominator == 4,
+               "the time signature should be written");
+      }
+    }
+    expect(tempo_ticks == std::vector<double>{0.0, 16.0 * 960},
+           "each tempo change should be written at its tick");
+
+    const MidiMessageSequence *track = file.getTrack(1);
+    expect(track->getNumEvents() == rendered.getNumEvents(),
+           "every rendered event should be written");
+    bool on_ticks{true};
+    for (int i = 0; i < track->getNumEvents(); ++i) {
+      double sample = rendered.getEventPointer(i)->message.getTimeStamp();
+      double tick = track->getEventPointer(i)->message.getTimeStamp();
+      on_ticks = on_ticks &&
+                 tick == std::round(
+                             renderer.get_ppq_at(static_cast<int64>(sample)) *
+                             960);
+    }
+    expect(on_ticks, "events should be at the tick nearest their sample");
+  };
+};
+
+static OfflineRendererTests test;
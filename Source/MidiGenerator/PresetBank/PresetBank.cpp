@@ -0,0 +1,126 @@
+/*
+ * PresetBank.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PresetBank.hpp"
+
+PresetBank::PresetBank() : prepared_sample_rate{0}, prepared_block_size{0} {
+  // the network the plugin starts with
+  MidiGenerator init(5);
+  add_program("Init", init);
+
+  // a spike passed around a ring of neurons, up a C major scale
+  MidiGenerator ring(8);
+  std::vector<int> scale{60, 62, 64, 65, 67, 69, 71, 72};
+  for (int i = 0; i < 8; ++i) {
+    ring.set_neuron_midi_note(i, scale[i]);
+    ring.set_neuron_input_weight(i, i == 0 ? 1 : 0);
+    ring.set_neuron_threshold(i, 4);
+    ring.set_neuron_connection_weight(i, i, -10);
+    ring.set_neuron_connection_weight(i, (i + 1) % 8, 6);
+  }
+  add_program("Ring", ring);
+
+  // drums on channel 10, each charging at its own rate
+  MidiGenerator pulse(4);
+  std::vector<int> drums{36, 38, 42, 46};
+  std::vector<int> rates{1, 1, 2, 3};
+  std::vector<int> thresholds{3, 7, 1, 5};
+  for (int i = 0; i < 4; ++i) {
+    pulse.set_neuron_midi_note(i, drums[i]);
+    pulse.set_neuron_midi_channel(i, 10);
+    pulse.set_neuron_input_weight(i, rates[i]);
+    pulse.set_neuron_threshold(i, thresholds[i]);
+    pulse.set_neuron_connection_weight(i, i, -8);
+  }
+  add_program("Pulse", pulse);
+
+  // two triads whose notes excite each other and inhibit the other triad
+  MidiGenerator chords(6);
+  std::vector<int> notes{60, 64, 67, 57, 60, 64};
+  for (int from = 0; from < 6; ++from) {
+    chords.set_neuron_midi_note(from, notes[from]);
+    chords.set_neuron_input_weight(from, 1);
+    chords.set_neuron_threshold(from, 8);
+    for (int to = 0; to < 6; ++to) {
+      bool same_triad = (from < 3) == (to < 3);
+      int weight = from == to ? -12 : (same_triad ? 3 : -4);
+      chords.set_neuron_connection_weight(from, to, weight);
+    }
+  }
+  add_program("Chords", chords);
+}
+PresetBank::~PresetBank() {}
+
+/*
+ * Getters & Setters
+ */
+
+int PresetBank::get_num_programs() { return static_cast<int>(programs.size()); }
+
+String PresetBank::get_program_name(int index) {
+  return programs.at(index).name;
+}
+void PresetBank::set_program_name(int index, const String &name) {
+  programs.at(index).name = name;
+}
+
+const EngineSnapshot &PresetBank::get_program_state(int index) {
+  return programs.at(index).state;
+}
+
+bool PresetBank::is_ready(int index) {
+  return programs.at(index).ready != nullptr;
+}
+
+/*
+ * Methods
+ */
+
+// Builds a generator for every program, prepared for playback, so that the
+// first switch to any of them is instant.
+void PresetBank::prepare(double sample_rate, int max_block_size) {
+  prepared_sample_rate = sample_rate;
+  prepared_block_size = max_block_size;
+  for (Program &program : programs) {
+    program.ready = build(program);
+  }
+}
+
+// Hands out the program's ready generator, or builds one if it isn't ready.
+std::unique_ptr<MidiGenerator> PresetBank::take_generator(int index) {
+  Program &program = programs.at(index);
+  if (program.ready == nullptr) {
+    return build(program);
+  }
+  return std::move(program.ready);
+}
+
+// Builds the generators that have been taken since the last refill.
+void PresetBank::refill() {
+  for (Program &program : programs) {
+    if (program.ready == nullptr) {
+      program.ready = build(program);
+    }
+  }
+}
+
+/*
+ * Private Methods
+ */
+
+std::unique_ptr<MidiGenerator> PresetBank::build(const Program &program) {
+  auto generator = std::make_unique<MidiGenerator>(program.state);
+  if (prepared_sample_rate > 0) {
+    generator->prepare(prepared_sample_rate, prepared_block_size,
+                       MidiGenerator::default_max_neurons);
+  }
+  return generator;
+}
+
+void PresetBank::add_program(const String &name, MidiGenerator &generator) {
+  programs.push_back(Program{name, *generator.get_snapshot(), nullptr});
+}
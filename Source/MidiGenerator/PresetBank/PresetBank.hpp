@@ -0,0 +1,57 @@
+/*
+ * PresetBank.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../MidiGenerator.hpp"
+#include <memory>
+#include <vector>
+
+/*
+ * Preset Bank
+ *
+ * The programs the host can switch between. Each program is a saved state,
+ * and the bank keeps a generator built from it and prepared for playback, so
+ * switching program only has to hand a ready generator to the audio thread.
+ * Once a program's generator has been taken it is built again by refill, off
+ * the audio thread, ready for the next switch.
+ */
+
+class PresetBank {
+public:
+  PresetBank();
+  ~PresetBank();
+
+  // Getters & Setters
+  int get_num_programs();
+  String get_program_name(int index);
+  void set_program_name(int index, const String &name);
+  const EngineSnapshot &get_program_state(int index);
+  bool is_ready(int index);
+
+  // Methods - message thread
+  void prepare(double sample_rate, int max_block_size);
+  std::unique_ptr<MidiGenerator> take_generator(int index);
+  void refill();
+
+private:
+  struct Program {
+    String name;
+    EngineSnapshot state;
+    std::unique_ptr<MidiGenerator> ready;
+  };
+
+  std::vector<Program> programs;
+  double prepared_sample_rate;
+  int prepared_block_size;
+
+  std::unique_ptr<MidiGenerator> build(const Program &program);
+  void add_program(const String &name, MidiGenerator &generator);
+
+  JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
@@ -0,0 +1,68 @@
+/*
+ * PresetBank.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PresetBank.hpp"
+
+class PresetBankTests : public UnitTest {
+public:
+  PresetBankTests() : UnitTest("PresetBank Testing") {}
+
+  void runTest() override {
+    PresetBank bank;
+
+    // == Instantiation ==
+    beginTest("Instantiation");
+
+    expect(bank.get_num_programs() > 1, "there should be factory programs");
+    expect(bank.get_program_name(0) == "Init", "the first should be Init");
+    expect(!bank.is_ready(0), "nothing should be built before prepare");
+
+    beginTest("set_program_name");
+
+    bank.set_program_name(1, "Renamed");
+    expect(bank.get_program_name(1) == "Renamed", "program not renamed");
+
+    // == prepare / take_generator / refill ==
+    beginTest("prepare");
+
+    bank.prepare(48000, 256);
+    for (int i = 0; i < bank.get_num_programs(); ++i) {
+      expect(bank.is_ready(i), "every program should be ready");
+    }
+
+    beginTest("take_generator");
+
+    std::unique_ptr<MidiGenerator> generator = bank.take_generator(1);
+    const EngineSnapshot &state = bank.get_program_state(1);
+    expect(generator != nullptr, "a generator should be handed out");
+    expect(generator->num_neurons() == state.num_neurons(),
+           "the generator should be built from the program");
+    expect(generator->get_neuron_midi_note(2) == state.midi_notes[2],
+           "the generator should have the program's notes");
+    expect(generator->get_max_midi_buffer_bytes() >
+               MidiGenerator(state.num_neurons()).get_max_midi_buffer_bytes(),
+           "the generator should be prepared for the bank's block size");
+    expect(!bank.is_ready(1), "the program's generator has been taken");
+
+    std::unique_ptr<MidiGenerator> another = bank.take_generator(1);
+    expect(another != nullptr && another != generator,
+           "a generator should be built when none is ready");
+
+    beginTest("refill");
+
+    bank.refill();
+    expect(bank.is_ready(1), "the program should be ready again");
+
+    beginTest("the programs are independent");
+
+    generator->set_neuron_threshold(0, 999);
+    expect(bank.get_program_state(1).thresholds[0] != 999,
+           "changing a generator shouldn't change its program");
+  };
+};
+
+static PresetBankTests test;
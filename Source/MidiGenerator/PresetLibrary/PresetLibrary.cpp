@@ -0,0 +1,299 @@
+/*
+ * PresetLibrary.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PresetLibrary.hpp"
+#include "../StateSerializer/StateSerializer.hpp"
+
+namespace {
+// where each field is in an index entry
+constexpr int entry_state_offset{0};
+constexpr int entry_state_size{8};
+constexpr int entry_num_neurons{16};
+constexpr int entry_density{18};
+constexpr int entry_tags{20};
+constexpr int entry_fingerprint{24};
+constexpr int entry_name{32};
+
+void write_padded(MemoryOutputStream &stream, const String &text,
+                  int num_bytes) {
+  int length = jmin(static_cast<int>(text.getNumBytesAsUTF8()), num_bytes);
+  stream.write(text.toRawUTF8(), static_cast<size_t>(length));
+  for (int i = length; i < num_bytes; ++i) {
+    stream.writeByte(0);
+  }
+}
+} // namespace
+
+PresetLibrary::PresetLibrary()
+    : data{nullptr}, num_bytes{0}, num_presets{0} {}
+PresetLibrary::~PresetLibrary() {}
+
+/*
+ * Writing
+ */
+
+// Tags are matched ignoring case. A library can use up to max_tags of them;
+// any more are left out of the index.
+void PresetLibrary::write(const std::vector<Preset> &presets,
+                          MemoryBlock &destination) {
+  StringArray tags;
+  for (const Preset &preset : presets) {
+    for (const String &tag : preset.tags) {
+      if (tags.size() < max_tags) {
+        tags.addIfNotAlreadyThere(tag, true);
+      }
+    }
+  }
+  std::vector<MemoryBlock> states(presets.size());
+  for (size_t i = 0; i < presets.size(); ++i) {
+    StateSerializer::write(presets[i].state, states[i]);
+  }
+
+  MemoryOutputStream stream(destination, false);
+  stream.writeInt(magic);
+  stream.writeInt(format_version);
+  stream.writeInt(static_cast<int>(presets.size()));
+  stream.writeInt(tags.size());
+  for (const String &tag : tags) {
+    write_padded(stream, tag, tag_name_bytes);
+  }
+
+  int64 offset = header_bytes + tags.size() * tag_name_bytes +
+                 static_cast<int64>(presets.size()) * entry_bytes;
+  for (size_t i = 0; i < presets.size(); ++i) {
+    const Preset &preset = presets[i];
+    uint32 tag_bits{0};
+    for (const String &tag : preset.tags) {
+      int bit = tags.indexOf(tag, true);
+      if (bit >= 0) {
+        tag_bits |= 1u << bit;
+      }
+    }
+    int64 size = static_cast<int64>(states[i].getSize());
+    stream.writeInt64(offset);
+    stream.writeInt64(size);
+    stream.writeShort(static_cast<short>(preset.state.num_neurons()));
+    stream.writeShort(static_cast<short>(
+        roundToInt(density(preset.state) * density_scale)));
+    stream.writeInt(static_cast<int>(tag_bits));
+    stream.writeInt64(static_cast<int64>(fingerprint(preset.state)));
+    write_padded(stream, preset.name, name_bytes);
+    offset += size;
+  }
+  for (const MemoryBlock &state : states) {
+    stream.write(state.getData(), state.getSize());
+  }
+}
+
+// FNV-1a over the neuron count and the sign of every connection weight. 0 is
+// left for filters that match any fingerprint.
+uint64 PresetLibrary::fingerprint(const EngineSnapshot &state) {
+  uint64 hash{14695981039346656037ull};
+  auto mix = [&hash](uint8 byte) {
+    hash ^= byte;
+    hash *= 1099511628211ull;
+  };
+  int n = state.num_neurons();
+  mix(static_cast<uint8>(n & 0xff));
+  mix(static_cast<uint8>(n >> 8));
+  for (int from = 0; from < n; ++from) {
+    for (int weight : state.get_connection_row(from)) {
+      mix(weight > 0 ? 1 : (weight < 0 ? 2 : 0));
+    }
+  }
+  return hash != 0 ? hash : 1;
+}
+
+float PresetLibrary::density(const EngineSnapshot &state) {
+  int n = state.num_neurons();
+  if (n == 0) {
+    return 0.0f;
+  }
+  int connected{0};
+  for (int from = 0; from < n; ++from) {
+    for (int weight : state.get_connection_row(from)) {
+      connected += weight != 0 ? 1 : 0;
+    }
+  }
+  return static_cast<float>(connected) / static_cast<float>(n * n);
+}
+
+/*
+ * Opening
+ */
+
+bool PresetLibrary::open(const File &file) {
+  auto mapped = std::make_unique<MemoryMappedFile>(
+      file, MemoryMappedFile::readOnly);
+  if (mapped->getData() == nullptr ||
+      !open(mapped->getData(), mapped->getSize())) {
+    return false;
+  }
+  mappedFile = std::move(mapped);
+  return true;
+}
+
+// Only the header and index are checked, so opening takes no longer for a
+// library of large presets. Returns false, leaving the library closed, if
+// the data isn't a library of this format or its index doesn't fit it.
+bool PresetLibrary::open(const void *library_data, size_t library_bytes) {
+  close();
+  const char *bytes = static_cast<const char *>(library_data);
+  if (bytes == nullptr || library_bytes < header_bytes ||
+      static_cast<int32>(ByteOrder::littleEndianInt(bytes)) != magic ||
+      static_cast<int32>(ByteOrder::littleEndianInt(bytes + 4)) !=
+          format_version) {
+    return false;
+  }
+  int32 presets = static_cast<int32>(ByteOrder::littleEndianInt(bytes + 8));
+  int32 tags = static_cast<int32>(ByteOrder::littleEndianInt(bytes + 12));
+  if (presets < 0 || tags < 0 || tags > max_tags) {
+    return false;
+  }
+  uint64 index_end = static_cast<uint64>(header_bytes) +
+                     static_cast<uint64>(tags) * tag_name_bytes +
+                     static_cast<uint64>(presets) * entry_bytes;
+  if (index_end > library_bytes) {
+    return false;
+  }
+  const char *index = bytes + header_bytes + tags * tag_name_bytes;
+  for (int i = 0; i < presets; ++i) {
+    const char *entry = index + static_cast<size_t>(i) * entry_bytes;
+    uint64 offset = ByteOrder::littleEndianInt64(entry + entry_state_offset);
+    uint64 size = ByteOrder::littleEndianInt64(entry + entry_state_size);
+    // compared so that nothing can overflow, whatever the entry holds
+    if (offset < index_end || offset > library_bytes ||
+        size > library_bytes - offset) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < tags; ++i) {
+    tag_names.add(String::fromUTF8(bytes + header_bytes + i * tag_name_bytes,
+                                   tag_name_bytes));
+  }
+  data = bytes;
+  num_bytes = library_bytes;
+  num_presets = presets;
+  return true;
+}
+
+void PresetLibrary::close() {
+  data = nullptr;
+  num_bytes = 0;
+  num_presets = 0;
+  tag_names = StringArray();
+  mappedFile.reset();
+}
+
+bool PresetLibrary::is_open() { return data != nullptr; }
+
+/*
+ * Getters
+ */
+
+int PresetLibrary::get_num_presets() { return num_presets; }
+
+const StringArray &PresetLibrary::get_tags() { return tag_names; }
+
+String PresetLibrary::get_name(int index) {
+  return String::fromUTF8(get_entry(index) + entry_name, name_bytes);
+}
+
+int PresetLibrary::get_num_neurons(int index) {
+  return ByteOrder::littleEndianShort(get_entry(index) + entry_num_neurons);
+}
+
+float PresetLibrary::get_density(int index) {
+  return ByteOrder::littleEndianShort(get_entry(index) + entry_density) /
+         static_cast<float>(density_scale);
+}
+
+uint64 PresetLibrary::get_fingerprint(int index) {
+  return ByteOrder::littleEndianInt64(get_entry(index) + entry_fingerprint);
+}
+
+StringArray PresetLibrary::get_tags(int index) {
+  StringArray tags;
+  uint32 bits = get_tag_bits(index);
+  for (int i = 0; i < tag_names.size(); ++i) {
+    if ((bits & (1u << i)) != 0) {
+      tags.add(tag_names[i]);
+    }
+  }
+  return tags;
+}
+
+bool PresetLibrary::has_tag(int index, const String &tag) {
+  int bit = tag_names.indexOf(tag, true);
+  return bit >= 0 && (get_tag_bits(index) & (1u << bit)) != 0;
+}
+
+/*
+ * Methods
+ */
+
+// The indices of the presets that match, read from the index alone.
+std::vector<int> PresetLibrary::find(const Filter &filter) {
+  std::vector<int> found;
+  uint32 required = get_tag_bits(filter.tags);
+  if (filter.tags.size() > 0 && required == 0) {
+    return found; // a tag no preset has
+  }
+  for (int i = 0; i < num_presets; ++i) {
+    int n = get_num_neurons(i);
+    float d = get_density(i);
+    if (n < filter.min_neurons ||
+        (filter.max_neurons >= 0 && n > filter.max_neurons) ||
+        d < filter.min_density || d > filter.max_density ||
+        (get_tag_bits(i) & required) != required ||
+        (filter.fingerprint != 0 && get_fingerprint(i) != filter.fingerprint)) {
+      continue;
+    }
+    found.push_back(i);
+  }
+  return found;
+}
+
+// The preset's state is read from the mapped file into `state`'s own rows, so
+// it doesn't need the library to stay open. Returns false, leaving `state`
+// untouched, if it isn't a valid state.
+bool PresetLibrary::load(int index, EngineSnapshot &state) {
+  const char *entry = get_entry(index);
+  uint64 offset = ByteOrder::littleEndianInt64(entry + entry_state_offset);
+  uint64 size = ByteOrder::littleEndianInt64(entry + entry_state_size);
+  return StateSerializer::read(data + offset, static_cast<size_t>(size),
+                               state);
+}
+
+/*
+ * Private Methods
+ */
+
+const char *PresetLibrary::get_entry(int index) {
+  jassert(index >= 0 && index < num_presets);
+  return data + header_bytes + tag_names.size() * tag_name_bytes +
+         static_cast<size_t>(index) * entry_bytes;
+}
+
+uint32 PresetLibrary::get_tag_bits(int index) {
+  return ByteOrder::littleEndianInt(get_entry(index) + entry_tags);
+}
+
+// Tags the library doesn't use are left out, so a filter on one of them
+// matches nothing.
+uint32 PresetLibrary::get_tag_bits(const StringArray &tags) {
+  uint32 bits{0};
+  for (const String &tag : tags) {
+    int bit = tag_names.indexOf(tag, true);
+    if (bit < 0) {
+      return 0;
+    }
+    bits |= 1u << bit;
+  }
+  return bits;
+}
@@ -0,0 +1,109 @@
+/*
+ * PresetLibrary.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../EngineSnapshot/EngineSnapshot.hpp"
+#include <memory>
+#include <vector>
+
+/*
+ * Preset Library
+ *
+ * Many presets in one file, with an index of what's in each so a library of
+ * thousands can be browsed and filtered without reading any of them. The file
+ * is memory mapped and the index is read where it lies, so opening a library
+ * only checks its index, and a preset is only read when it's loaded. Loading
+ * isn't zero copy, the preset's weights are copied out of the mapping into
+ * the rows of an EngineSnapshot.
+ *
+ *   header   magic, format version, the preset count and the tag count
+ *   tags     the name of each tag used in the library, tag_name_bytes each
+ *   index    an entry_bytes entry per preset: where its state is and its size
+ *            (64 bit, so a library can be bigger than 2GB), its neuron count,
+ *            density (the fraction of connections that aren't 0), a bit for
+ *            each of its tags, its fingerprint and its name
+ *   presets  each preset's state, as written by StateSerializer
+ *
+ * The fingerprint hashes which neurons excite or inhibit which, and not by
+ * how much, so presets that are variations of the same network share one.
+ *
+ * Everything is little endian. A library opened from memory (rather than a
+ * file) reads the data in place, so it must outlive the library.
+ */
+
+class PresetLibrary {
+public:
+  struct Preset {
+    String name;
+    StringArray tags;
+    EngineSnapshot state;
+  };
+
+  // Every condition must match. A max of -1 means no limit.
+  struct Filter {
+    int min_neurons{0};
+    int max_neurons{-1};
+    float min_density{0.0f};
+    float max_density{1.0f};
+    StringArray tags;
+    uint64 fingerprint{0}; // 0 matches any
+  };
+
+  PresetLibrary();
+  ~PresetLibrary();
+
+  // Writing
+  static void write(const std::vector<Preset> &presets,
+                    MemoryBlock &destination);
+  static uint64 fingerprint(const EngineSnapshot &state);
+  static float density(const EngineSnapshot &state);
+
+  // Opening
+  bool open(const File &file);
+  bool open(const void *data, size_t num_bytes);
+  void close();
+  bool is_open();
+
+  // Getters - read from the index
+  int get_num_presets();
+  const StringArray &get_tags();
+  String get_name(int index);
+  int get_num_neurons(int index);
+  float get_density(int index);
+  uint64 get_fingerprint(int index);
+  StringArray get_tags(int index);
+  bool has_tag(int index, const String &tag);
+
+  // Methods
+  std::vector<int> find(const Filter &filter);
+  bool load(int index, EngineSnapshot &state);
+
+  static constexpr int32 magic{0x42494c57}; // "WLIB"
+  static constexpr int format_version{2};
+  static constexpr int header_bytes{16};
+  static constexpr int max_tags{32};
+  static constexpr int tag_name_bytes{16};
+  static constexpr int entry_bytes{72};
+  static constexpr int name_bytes{40};
+  // density is stored in ten thousandths
+  static constexpr int density_scale{10000};
+
+private:
+  std::unique_ptr<MemoryMappedFile> mappedFile;
+  const char *data;
+  size_t num_bytes;
+  int num_presets;
+  StringArray tag_names;
+
+  const char *get_entry(int index);
+  uint32 get_tag_bits(int index);
+  uint32 get_tag_bits(const StringArray &tags);
+
+  JUCE_DECLARE_NON_COPYABLE(PresetLibrary)
+};
@@ -0,0 +1,141 @@
+/*
+ * PresetLibrary.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PresetLibrary.hpp"
+#include "../MidiGenerator.hpp"
+
+class PresetLibraryTests : public UnitTest {
+public:
+  PresetLibraryTests() : UnitTest("PresetLibrary Testing") {}
+
+  void runTest() override {
+    MidiGenerator sparse(4);
+    sparse.set_neuron_connection_weight(0, 1, 50);
+    sparse.set_neuron_connection_weight(1, 2, -20);
+    sparse.set_neuron_threshold(3, 77);
+    MidiGenerator louder(4);
+    louder.set_neuron_connection_weight(0, 1, 90);
+    louder.set_neuron_connection_weight(1, 2, -5);
+    MidiGenerator big(8);
+    for (int from = 0; from < 8; ++from) {
+      for (int to = 0; to < 8; ++to) {
+        big.set_neuron_connection_weight(from, to, from == to ? 0 : 10);
+      }
+    }
+
+    std::vector<PresetLibrary::Preset> presets{
+        {"Sparse", {"Drums", "Dark"}, *sparse.get_snapshot()},
+        {"Louder", {"drums"}, *louder.get_snapshot()},
+        {"Big", {"Pad"}, *big.get_snapshot()}};
+    MemoryBlock file;
+    PresetLibrary::write(presets, file);
+
+    // == index ==
+    beginTest("open - index");
+
+    PresetLibrary library;
+    expect(!library.is_open(), "a new library should be closed");
+    expect(library.open(file.getData(), file.getSize()),
+           "a written library should open");
+    expect(library.get_num_presets() == 3, "wrong preset count");
+    expect(library.get_tags().size() == 3,
+           "tags should be shared, ignoring case");
+    expect(library.get_name(0) == "Sparse" && library.get_name(2) == "Big",
+           "names not read from the index");
+    expect(library.get_num_neurons(0) == 4 && library.get_num_neurons(2) == 8,
+           "neuron counts not read from the index");
+    expect(std::abs(library.get_density(0) - 2.0f / 16.0f) < 0.001f,
+           "density not read from the index");
+    expect(std::abs(library.get_density(2) - 56.0f / 64.0f) < 0.001f,
+           "density not read from the index");
+    expect(library.has_tag(0, "dark") && library.has_tag(1, "Drums") &&
+               !library.has_tag(1, "Dark") && !library.has_tag(0, "Bass"),
+           "tags not read from the index");
+    expect(library.get_tags(0).size() == 2, "wrong tags for a preset");
+
+    beginTest("fingerprint");
+
+    expect(library.get_fingerprint(0) == library.get_fingerprint(1),
+           "the same network with other weights should share a fingerprint");
+    expect(library.get_fingerprint(0) != library.get_fingerprint(2),
+           "different networks should have different fingerprints");
+    expect(library.get_fingerprint(0) ==
+               PresetLibrary::fingerprint(*sparse.get_snapshot()),
+           "the index should hold the preset's fingerprint");
+
+    // == find ==
+    beginTest("find");
+
+    PresetLibrary::Filter filter;
+    expect(library.find(filter).size() == 3,
+           "an empty filter should match everything");
+    filter.tags.add("drums");
+    expect(library.find(filter) == std::vector<int>{0, 1},
+           "should find by tag");
+    filter.tags.add("dark");
+    expect(library.find(filter) == std::vector<int>{0},
+           "every tag should have to match");
+    filter = PresetLibrary::Filter{};
+    filter.min_neurons = 5;
+    expect(library.find(filter) == std::vector<int>{2},
+           "should find by neuron count");
+    filter = PresetLibrary::Filter{};
+    filter.max_density = 0.5f;
+    expect(library.find(filter) == std::vector<int>{0, 1},
+           "should find by density");
+    filter = PresetLibrary::Filter{};
+    filter.fingerprint = library.get_fingerprint(1);
+    expect(library.find(filter) == std::vector<int>{0, 1},
+           "should find by fingerprint");
+    filter = PresetLibrary::Filter{};
+    filter.tags.add("Bass");
+    expect(library.find(filter).empty(),
+           "a tag no preset has should match nothing");
+
+    // == load ==
+    beginTest("load");
+
+    EngineSnapshot state;
+    expect(library.load(0, state), "a preset should load");
+    MidiGenerator loaded(state);
+    expect(loaded.get_neuron_connection_weight(1, 2) == -20 &&
+               loaded.get_neuron_threshold(3) == 77,
+           "the preset's state should be loaded");
+    expect(library.load(2, state) && state.num_neurons() == 8,
+           "each preset's own state should be loaded");
+
+    // == corrupt data ==
+    beginTest("open - rejects corrupt data");
+
+    expect(!library.open(file.getData(), PresetLibrary::header_bytes),
+           "a truncated index should be rejected");
+    expect(!library.is_open() && library.get_num_presets() == 0,
+           "a rejected library should be closed");
+    expect(!library.open("not a library", 13),
+           "data without the magic should be rejected");
+
+    // the first entry's state offset and size
+    int entry = PresetLibrary::header_bytes + 3 * PresetLibrary::tag_name_bytes;
+    auto corrupt_byte = [&](int at, uint8 value) {
+      MemoryBlock corrupt(file.getData(), file.getSize());
+      static_cast<uint8 *>(corrupt.getData())[at] = value;
+      return !library.open(corrupt.getData(), corrupt.getSize());
+    };
+    expect(corrupt_byte(entry + 8 + 7, 0x7f),
+           "a preset past the end of the file should be rejected");
+    expect(corrupt_byte(entry + 4, 0x01),
+           "an offset past 4GB shouldn't wrap back into the file");
+    expect(corrupt_byte(entry + 8 + 7, 0xff),
+           "a size that overflows the offset should be rejected");
+    MemoryBlock old_format(file.getData(), file.getSize());
+    static_cast<uint8 *>(old_format.getData())[4] = 1;
+    expect(!library.open(old_format.getData(), old_format.getSize()),
+           "a library in another format should be rejected");
+  };
+};
+
+static PresetLibraryTests test;
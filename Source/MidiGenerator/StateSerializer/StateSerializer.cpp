@@ -0,0 +1,291 @@
+/*
+ * StateSerializer.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "StateSerializer.hpp"
+#include "../BeatClock/BeatClock.hpp"
+#include "../MidiReceiver/MidiReceiver.hpp"
+#include <cmath>
+
+void StateSerializer::write(const EngineSnapshot &snapshot,
+                            MemoryBlock &destination) {
+  MemoryOutputStream stream(destination, false);
+  stream.writeInt(magic);
+  stream.writeInt(format_version);
+
+  write_settings(stream, snapshot);
+  write_neurons(stream, snapshot);
+  write_connections(stream, snapshot);
+  write_midi_input(stream, snapshot);
+}
+
+// Returns false, leaving `snapshot` untouched, if the data isn't a state or
+// is truncated or corrupt.
+bool StateSerializer::read(const void *data, size_t num_bytes,
+                           EngineSnapshot &snapshot) {
+  MemoryInputStream stream(data, num_bytes, false);
+  if (stream.getNumBytesRemaining() < header_bytes ||
+      stream.readInt() != magic || stream.readInt() < 1) {
+    return false;
+  }
+
+  EngineSnapshot restored;
+  bool has_settings{false}, has_neurons{false}, has_connections{false},
+      has_midi_input{false};
+
+  while (stream.getNumBytesRemaining() >= chunk_header_bytes) {
+    int32 id = stream.readInt();
+    int num_chunk_bytes = stream.readInt();
+    if (num_chunk_bytes < 0 ||
+        num_chunk_bytes > stream.getNumBytesRemaining()) {
+      return false;
+    }
+    int64 chunk_end = stream.getPosition() + num_chunk_bytes;
+
+    // the neurons come first, as the other chunks are checked against them,
+    // and each chunk is only read once so none is checked against another
+    // neuron count
+    bool ok{true};
+    if (id == settings_chunk) {
+      ok = !has_settings && read_settings(stream, num_chunk_bytes, restored);
+      has_settings = ok;
+    } else if (id == neurons_chunk) {
+      ok = !has_neurons && read_neurons(stream, num_chunk_bytes, restored);
+      has_neurons = ok;
+    } else if (id == connections_chunk) {
+      ok = has_neurons && !has_connections &&
+           read_connections(stream, num_chunk_bytes, restored);
+      has_connections = ok;
+    } else if (id == midi_input_chunk) {
+      ok = has_neurons && !has_midi_input &&
+           read_midi_input(stream, num_chunk_bytes, restored);
+      has_midi_input = ok;
+    }
+    if (!ok) {
+      return false;
+    }
+    stream.setPosition(chunk_end);
+  }
+
+  if (!(has_settings && has_neurons && has_connections && has_midi_input) ||
+      !is_consistent(restored)) {
+    return false;
+  }
+  snapshot = std::move(restored);
+  return true;
+}
+
+/*
+ * Private Methods
+ */
+
+void StateSerializer::write_chunk_header(MemoryOutputStream &stream, int32 id,
+                                         int num_bytes) {
+  stream.writeInt(id);
+  stream.writeInt(num_bytes);
+}
+
+void StateSerializer::write_gate(MemoryOutputStream &stream,
+                                 const GateLength &gate) {
+  stream.writeByte(static_cast<char>(gate.unit));
+  stream.writeFloat(gate.value);
+}
+
+void StateSerializer::write_settings(MemoryOutputStream &stream,
+                                     const EngineSnapshot &snapshot) {
+  write_chunk_header(stream, settings_chunk, settings_bytes);
+  stream.writeByte(static_cast<char>((snapshot.is_on ? 1 : 0) |
+                                     (snapshot.receives_midi ? 2 : 0) |
+                                     (snapshot.midi_through ? 4 : 0) |
+                                     (snapshot.follows_song_position ? 8 : 0)));
+  stream.writeInt(snapshot.subdivision);
+  stream.writeFloat(snapshot.volume);
+  stream.writeInt(snapshot.volume_clip_min);
+  stream.writeInt(snapshot.volume_clip_max);
+  stream.writeInt(snapshot.max_neuron_output);
+  write_gate(stream, snapshot.gate_length);
+  stream.writeByte(static_cast<char>(snapshot.note_policy.velocity));
+  stream.writeByte(static_cast<char>(snapshot.note_policy.repeat));
+}
+
+void StateSerializer::write_neurons(MemoryOutputStream &stream,
+                                    const EngineSnapshot &snapshot) {
+  int n = snapshot.num_neurons();
+  write_chunk_header(stream, neurons_chunk, 4 + (n * bytes_per_neuron));
+  stream.writeInt(n);
+  for (int i = 0; i < n; ++i) {
+    stream.writeByte(static_cast<char>(snapshot.midi_notes[i]));
+    stream.writeByte(static_cast<char>(snapshot.midi_channels[i]));
+    write_gate(stream, snapshot.gate_lengths[i]);
+    stream.writeInt(snapshot.input_weights[i]);
+    stream.writeInt(snapshot.thresholds[i]);
+  }
+}
+
+// Weights are stored in two bytes each unless one of them doesn't fit, which
+// halves the size of the largest chunk for any network set from the editor.
+void StateSerializer::write_connections(MemoryOutputStream &stream,
+                                        const EngineSnapshot &snapshot) {
+  int n = snapshot.num_neurons();
+  int bytes_per_weight{2};
+  for (const EngineSnapshot::Row &row : snapshot.connection_weights) {
+    for (int weight : *row) {
+      if (weight < std::numeric_limits<int16>::min() ||
+          weight > std::numeric_limits<int16>::max()) {
+        bytes_per_weight = 4;
+      }
+    }
+  }
+
+  write_chunk_header(stream, connections_chunk,
+                     5 + (n * n * bytes_per_weight));
+  stream.writeInt(n);
+  stream.writeByte(static_cast<char>(bytes_per_weight));
+  for (const EngineSnapshot::Row &row : snapshot.connection_weights) {
+    for (int weight : *row) {
+      if (bytes_per_weight == 2) {
+        stream.writeShort(static_cast<short>(weight));
+      } else {
+        stream.writeInt(weight);
+      }
+    }
+  }
+}
+
+void StateSerializer::write_midi_input(MemoryOutputStream &stream,
+                                       const EngineSnapshot &snapshot) {
+  write_chunk_header(stream, midi_input_chunk, midi_input_bytes);
+  for (int neuron_idx : snapshot.input_note_neurons) {
+    stream.writeShort(static_cast<short>(neuron_idx));
+  }
+  for (int neuron_idx : snapshot.input_cc_neurons) {
+    stream.writeShort(static_cast<short>(neuron_idx));
+  }
+}
+
+// A neuron's gate has a value of 0 when it follows the global gate.
+bool StateSerializer::read_gate(MemoryInputStream &stream, GateLength &gate) {
+  int unit = static_cast<uint8>(stream.readByte());
+  gate.value = stream.readFloat();
+  gate.unit = static_cast<GateLength::Unit>(unit);
+  return unit <= GateLength::subdivision_fraction &&
+         std::isfinite(gate.value) && gate.value >= 0;
+}
+
+bool StateSerializer::read_settings(MemoryInputStream &stream, int num_bytes,
+                                    EngineSnapshot &snapshot) {
+  if (num_bytes < settings_bytes) {
+    return false;
+  }
+  int flags = static_cast<uint8>(stream.readByte());
+  snapshot.is_on = (flags & 1) != 0;
+  snapshot.receives_midi = (flags & 2) != 0;
+  snapshot.midi_through = (flags & 4) != 0;
+  snapshot.follows_song_position = (flags & 8) != 0;
+  snapshot.subdivision = stream.readInt();
+  snapshot.volume = stream.readFloat();
+  snapshot.volume_clip_min = stream.readInt();
+  snapshot.volume_clip_max = stream.readInt();
+  snapshot.max_neuron_output = stream.readInt();
+  bool gate_ok = read_gate(stream, snapshot.gate_length);
+  int velocity = static_cast<uint8>(stream.readByte());
+  int repeat = static_cast<uint8>(stream.readByte());
+  snapshot.note_policy.velocity = static_cast<NotePolicy::Velocity>(velocity);
+  snapshot.note_policy.repeat = static_cast<NotePolicy::Repeat>(repeat);
+
+  return gate_ok && snapshot.gate_length.value > 0 &&
+         snapshot.subdivision >= 1 &&
+         snapshot.subdivision <= BeatClock::max_subdivision &&
+         std::isfinite(snapshot.volume) &&
+         snapshot.volume_clip_min <= snapshot.volume_clip_max &&
+         snapshot.max_neuron_output > 0 && snapshot.max_neuron_output < 128 &&
+         velocity <= NotePolicy::sum_velocity && repeat <= NotePolicy::hold;
+}
+
+bool StateSerializer::read_neurons(MemoryInputStream &stream, int num_bytes,
+                                   EngineSnapshot &snapshot) {
+  int n = stream.readInt();
+  if (n < 0 || n > max_neurons || num_bytes < 4 + (n * bytes_per_neuron)) {
+    return false;
+  }
+  snapshot.midi_notes.resize(n);
+  snapshot.midi_channels.resize(n);
+  snapshot.gate_lengths.resize(n);
+  snapshot.input_weights.resize(n);
+  snapshot.thresholds.resize(n);
+  for (int i = 0; i < n; ++i) {
+    snapshot.midi_notes[i] = static_cast<uint8>(stream.readByte());
+    snapshot.midi_channels[i] = static_cast<uint8>(stream.readByte());
+    if (!read_gate(stream, snapshot.gate_lengths[i])) {
+      return false;
+    }
+    snapshot.input_weights[i] = stream.readInt();
+    snapshot.thresholds[i] = stream.readInt();
+    if (snapshot.midi_notes[i] > 127 || snapshot.midi_channels[i] < 1 ||
+        snapshot.midi_channels[i] > 16) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StateSerializer::read_connections(MemoryInputStream &stream,
+                                       int num_bytes,
+                                       EngineSnapshot &snapshot) {
+  int n = stream.readInt();
+  int bytes_per_weight = static_cast<uint8>(stream.readByte());
+  if (n != snapshot.num_neurons() ||
+      (bytes_per_weight != 2 && bytes_per_weight != 4) ||
+      num_bytes < 5 + (n * n * bytes_per_weight)) {
+    return false;
+  }
+  snapshot.connection_weights.clear();
+  snapshot.connection_weights.reserve(n);
+  for (int from = 0; from < n; ++from) {
+    auto row = std::make_shared<std::vector<int>>(n);
+    for (int &weight : *row) {
+      weight = bytes_per_weight == 2 ? stream.readShort() : stream.readInt();
+    }
+    snapshot.connection_weights.push_back(std::move(row));
+  }
+  return true;
+}
+
+// Whether every per neuron part of the state is for the same neurons, so a
+// generator can be built from it.
+bool StateSerializer::is_consistent(const EngineSnapshot &snapshot) {
+  size_t n = snapshot.thresholds.size();
+  bool ok = snapshot.midi_notes.size() == n &&
+            snapshot.midi_channels.size() == n &&
+            snapshot.gate_lengths.size() == n &&
+            snapshot.input_weights.size() == n &&
+            snapshot.connection_weights.size() == n;
+  for (const EngineSnapshot::Row &row : snapshot.connection_weights) {
+    ok = ok && row != nullptr && row->size() == n;
+  }
+  for (auto *map : {&snapshot.input_note_neurons, &snapshot.input_cc_neurons}) {
+    for (int neuron_idx : *map) {
+      ok = ok && neuron_idx < static_cast<int>(n);
+    }
+  }
+  return ok;
+}
+
+bool StateSerializer::read_midi_input(MemoryInputStream &stream, int num_bytes,
+                                      EngineSnapshot &snapshot) {
+  if (num_bytes < midi_input_bytes) {
+    return false;
+  }
+  int n = snapshot.num_neurons();
+  bool ok{true};
+  for (auto *map : {&snapshot.input_note_neurons, &snapshot.input_cc_neurons}) {
+    for (int &neuron_idx : *map) {
+      neuron_idx = stream.readShort();
+      ok = ok && neuron_idx >= MidiReceiver::unmapped && neuron_idx < n;
+    }
+  }
+  return ok;
+}
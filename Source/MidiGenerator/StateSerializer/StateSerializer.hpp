@@ -0,0 +1,84 @@
+/*
+ * StateSerializer.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../EngineSnapshot/EngineSnapshot.hpp"
+
+/*
+ * State Serializer
+ *
+ * Saves a snapshot of the generator's parameters as compact binary, for the
+ * host to store with a project, and reads it back into a snapshot that a new
+ * generator can be built from.
+ *
+ * The state starts with a header (magic + format version) followed by chunks,
+ * each an id, a size in bytes and the chunk's data:
+ *
+ *   settings     the global settings
+ *   neurons      the neuron count, then each neuron's note, channel, gate,
+ *                input weight and threshold
+ *   connections  the neuron count, the bytes per weight (2 when every weight
+ *                fits, otherwise 4), then the weights row by row
+ *   midi input   the neuron each MIDI note and CC excites
+ *
+ * Everything is little endian. Readers skip chunks they don't know and
+ * anything after the fields they know at the end of a chunk, so newer
+ * versions can add to the format without breaking older ones. Reading is a
+ * single pass over the data, with no intermediate tree. A state with a chunk
+ * twice, or whose chunks disagree on the neuron count, is rejected.
+ */
+
+class StateSerializer {
+public:
+  static constexpr int format_version{1};
+  // the most neurons a state can have, to reject corrupt counts before
+  // reserving anything
+  static constexpr int max_neurons{1024};
+
+  static void write(const EngineSnapshot &snapshot, MemoryBlock &destination);
+  static bool read(const void *data, size_t num_bytes,
+                   EngineSnapshot &snapshot);
+
+  // ids are four characters, so they can be read in a hex dump
+  static constexpr int32 magic{0x4c4c4557};             // "WELL"
+  static constexpr int32 settings_chunk{0x53544553};    // "SETS"
+  static constexpr int32 neurons_chunk{0x534e524e};     // "NRNS"
+  static constexpr int32 connections_chunk{0x4e4e4f43}; // "CONN"
+  static constexpr int32 midi_input_chunk{0x4944494d};  // "MIDI"
+
+  static constexpr int header_bytes{8};
+  static constexpr int chunk_header_bytes{8};
+  static constexpr int settings_bytes{28};
+  static constexpr int bytes_per_neuron{15};
+  static constexpr int midi_input_bytes{2 * 128 * 2};
+
+private:
+  static void write_chunk_header(MemoryOutputStream &stream, int32 id,
+                                 int num_bytes);
+  static void write_gate(MemoryOutputStream &stream, const GateLength &gate);
+  static void write_settings(MemoryOutputStream &stream,
+                             const EngineSnapshot &snapshot);
+  static void write_neurons(MemoryOutputStream &stream,
+                            const EngineSnapshot &snapshot);
+  static void write_connections(MemoryOutputStream &stream,
+                                const EngineSnapshot &snapshot);
+  static void write_midi_input(MemoryOutputStream &stream,
+                               const EngineSnapshot &snapshot);
+
+  static bool read_gate(MemoryInputStream &stream, GateLength &gate);
+  static bool read_settings(MemoryInputStream &stream, int num_bytes,
+                            EngineSnapshot &snapshot);
+  static bool read_neurons(MemoryInputStream &stream, int num_bytes,
+                           EngineSnapshot &snapshot);
+  static bool read_connections(MemoryInputStream &stream, int num_bytes,
+                               EngineSnapshot &snapshot);
+  static bool read_midi_input(MemoryInputStream &stream, int num_bytes,
+                              EngineSnapshot &snapshot);
+  static bool is_consistent(const EngineSnapshot &snapshot);
+};
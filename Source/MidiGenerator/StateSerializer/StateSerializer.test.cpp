@@ -0,0 +1,161 @@
+/*
+ * StateSerializer.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "StateSerializer.hpp"
+#include "../MidiGenerator.hpp"
+
+class StateSerializerTests : public UnitTest {
+public:
+  StateSerializerTests() : UnitTest("StateSerializer Testing") {}
+
+  void runTest() override {
+    MidiGenerator generator(3);
+    generator.toggleOnOff();
+    generator.toggleMidiThrough();
+    generator.toggleFollowsSongPosition();
+    generator.set_subdivision(4);
+    generator.set_volume(0.75f);
+    generator.set_volume_clip(10, 100);
+    generator.set_max_neuron_output(12);
+    generator.set_gate_length(GateLength{GateLength::milliseconds, 80.0f});
+    generator.set_note_policy(
+        NotePolicy{NotePolicy::sum_velocity, NotePolicy::hold});
+    generator.set_neuron_midi_note(1, 48);
+    generator.set_neuron_midi_channel(2, 10);
+    generator.set_neuron_gate_length(0, GateLength{GateLength::ticks, 2.0f});
+    generator.set_neuron_input_weight(2, -7);
+    generator.set_neuron_threshold(1, 123);
+    generator.set_neuron_connection_weight(0, 2, -200);
+    generator.set_neuron_connection_weight(2, 1, 31);
+    generator.set_input_note_neuron(36, 2);
+    generator.set_input_cc_neuron(74, 1);
+
+    // == write / read ==
+    beginTest("write / read - round trip");
+
+    MemoryBlock state;
+    StateSerializer::write(*generator.get_snapshot(), state);
+    EngineSnapshot restored;
+    expect(StateSerializer::read(state.getData(), state.getSize(), restored),
+           "a written state should read back");
+
+    MidiGenerator copy(restored);
+    expect(copy.get_is_on() && copy.get_midi_through() &&
+               !copy.get_receives_midi(),
+           "toggles should be restored");
+    expect(copy.get_follows_song_position(), "song position not restored");
+    expect(copy.get_subdivision() == 4, "subdivision not restored");
+    expect(copy.get_volume() == 0.75f, "volume not restored");
+    expect(copy.get_volume_clip_min() == 10 && copy.get_volume_clip_max() == 100,
+           "volume clip not restored");
+    expect(copy.get_max_neuron_output() == 12, "max output not restored");
+    expect(copy.get_gate_length().unit == GateLength::milliseconds &&
+               copy.get_gate_length().value == 80.0f,
+           "gate length not restored");
+    expect(copy.get_note_policy().velocity == NotePolicy::sum_velocity &&
+               copy.get_note_policy().repeat == NotePolicy::hold,
+           "note policy not restored");
+    expect(copy.num_neurons() == 3, "neuron count not restored");
+    expect(copy.get_neuron_midi_note(1) == 48, "note not restored");
+    expect(copy.get_neuron_midi_channel(2) == 10, "channel not restored");
+    expect(copy.get_neuron_gate_length(0).unit == GateLength::ticks,
+           "neuron gate not restored");
+    expect(copy.get_neuron_input_weight(2) == -7, "input weight not restored");
+    expect(copy.get_neuron_threshold(1) == 123, "threshold not restored");
+    for (int from = 0; from < 3; ++from) {
+      for (int to = 0; to < 3; ++to) {
+        expect(copy.get_neuron_connection_weight(from, to) ==
+                   generator.get_neuron_connection_weight(from, to),
+               "connection weight not restored");
+      }
+    }
+    expect(copy.get_input_note_neuron(36) == 2, "note map not restored");
+    expect(copy.get_input_note_neuron(63) == MidiReceiver::unmapped,
+           "unmapped notes should stay unmapped");
+    expect(copy.get_input_cc_neuron(74) == 1, "cc map not restored");
+
+    beginTest("write - weights are packed");
+
+    int num_packed_bytes = static_cast<int>(state.getSize());
+    generator.set_neuron_connection_weight(1, 1, 100000);
+    StateSerializer::write(*generator.get_snapshot(), state);
+    expect(static_cast<int>(state.getSize()) == num_packed_bytes + (3 * 3 * 2),
+           "weights should take 4 bytes only when one doesn't fit in 2");
+    expect(StateSerializer::read(state.getData(), state.getSize(), restored) &&
+               restored.get_connection_weight(1, 1) == 100000,
+           "large weights should read back");
+
+    // == forward compatibility ==
+    beginTest("read - unknown chunks are skipped");
+
+    MemoryBlock extended;
+    {
+      MemoryOutputStream stream(extended, false);
+      stream.write(state.getData(), StateSerializer::header_bytes);
+      // a chunk from a newer version, before the ones we know
+      stream.writeInt(0x57454e21);
+      stream.writeInt(3);
+      stream.write("abc", 3);
+      stream.write(static_cast<const char *>(state.getData()) +
+                       StateSerializer::header_bytes,
+                   state.getSize() - StateSerializer::header_bytes);
+    }
+    EngineSnapshot skipped;
+    expect(StateSerializer::read(extended.getData(), extended.getSize(),
+                                 skipped),
+           "an unknown chunk should be skipped");
+    expect(skipped.get_connection_weight(1, 1) == 100000,
+           "the known chunks should still be read");
+
+    // == corrupt data ==
+    beginTest("read - rejects corrupt data");
+
+    EngineSnapshot untouched;
+    expect(!StateSerializer::read(state.getData(), state.getSize() - 1,
+                                  untouched),
+           "a truncated state should be rejected");
+    expect(untouched.num_neurons() == 0,
+           "a rejected state should leave the snapshot untouched");
+    expect(!StateSerializer::read("not a state", 11, untouched),
+           "data without the magic should be rejected");
+    expect(!StateSerializer::read(nullptr, 0, untouched),
+           "empty data should be rejected");
+
+    MemoryBlock corrupt(state.getData(), state.getSize());
+    // the neuron count, just after the neurons chunk's header
+    int count_offset = StateSerializer::header_bytes +
+                       StateSerializer::chunk_header_bytes +
+                       StateSerializer::settings_bytes +
+                       StateSerializer::chunk_header_bytes;
+    static_cast<char *>(corrupt.getData())[count_offset] = 100;
+    expect(!StateSerializer::read(corrupt.getData(), corrupt.getSize(),
+                                  untouched),
+           "a neuron count that doesn't match the data should be rejected");
+
+    beginTest("read - rejects chunks for other neuron counts");
+
+    // a 5 neuron neurons chunk after the 3 neuron state's connections
+    MemoryBlock other_state;
+    StateSerializer::write(*MidiGenerator(5).get_snapshot(), other_state);
+    int neurons_offset = StateSerializer::header_bytes +
+                         StateSerializer::chunk_header_bytes +
+                         StateSerializer::settings_bytes;
+    int neurons_chunk_size = StateSerializer::chunk_header_bytes + 4 +
+                             (5 * StateSerializer::bytes_per_neuron);
+    MemoryBlock duplicated(state.getData(), state.getSize());
+    duplicated.append(static_cast<const char *>(other_state.getData()) +
+                          neurons_offset,
+                      neurons_chunk_size);
+    expect(!StateSerializer::read(duplicated.getData(), duplicated.getSize(),
+                                  untouched),
+           "a second neurons chunk should be rejected");
+    expect(untouched.num_neurons() == 0,
+           "a rejected state should leave the snapshot untouched");
+  };
+};
+
+static StateSerializerTests test;
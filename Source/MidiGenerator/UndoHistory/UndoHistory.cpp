@@ -0,0 +1,87 @@
+/*
+ * UndoHistory.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "UndoHistory.hpp"
+
+UndoHistory::UndoHistory(int max_steps) : max_steps{max_steps} {
+  jassert(max_steps > 0);
+}
+UndoHistory::~UndoHistory() {}
+
+// Getters & Setters
+
+// A pending checkpoint counts, as whether it changed isn't known until undo
+bool UndoHistory::can_undo() {
+  return !undo_states.empty() || before != nullptr;
+}
+bool UndoHistory::can_redo() { return !redo_states.empty(); }
+int UndoHistory::get_num_undo_steps() {
+  return static_cast<int>(undo_states.size());
+}
+int UndoHistory::get_num_redo_steps() {
+  return static_cast<int>(redo_states.size());
+}
+int UndoHistory::get_max_steps() { return max_steps; }
+void UndoHistory::set_max_steps(int steps) {
+  jassert(steps > 0);
+  max_steps = steps;
+  trim();
+}
+
+// Methods
+void UndoHistory::checkpoint(const State &current) {
+  commit(current);
+  before = current;
+}
+
+UndoHistory::State UndoHistory::undo(const State &current) {
+  commit(current);
+  if (undo_states.empty()) {
+    return nullptr;
+  }
+  redo_states.push_back(current);
+  State previous = undo_states.back();
+  undo_states.pop_back();
+  return previous;
+}
+
+UndoHistory::State UndoHistory::redo(const State &current) {
+  commit(current);
+  if (redo_states.empty()) {
+    return nullptr;
+  }
+  undo_states.push_back(current);
+  trim();
+  State next = redo_states.back();
+  redo_states.pop_back();
+  return next;
+}
+
+void UndoHistory::clear() {
+  undo_states.clear();
+  redo_states.clear();
+  before = nullptr;
+}
+
+// Private Methods
+
+// The generator publishes a new snapshot after every change, so the pending
+// checkpoint is an undo step if the snapshot has changed since.
+void UndoHistory::commit(const State &current) {
+  if (before != nullptr && before != current) {
+    undo_states.push_back(before);
+    redo_states.clear();
+    trim();
+  }
+  before = nullptr;
+}
+
+void UndoHistory::trim() {
+  while (static_cast<int>(undo_states.size()) > max_steps) {
+    undo_states.pop_front();
+  }
+}
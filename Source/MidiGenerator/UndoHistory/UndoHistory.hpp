@@ -0,0 +1,66 @@
+/*
+ * UndoHistory.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../EngineSnapshot/EngineSnapshot.hpp"
+#include <deque>
+#include <memory>
+#include <vector>
+
+/*
+ * Undo History
+ *
+ * The undo and redo stacks, holding the generator's published snapshots
+ * rather than copies of the network. A snapshot shares every row of
+ * connection weights that hasn't changed with the one before it, so an edit
+ * only costs the rows it touched, and a long session on a big network holds
+ * at most max_steps snapshots' worth of changed rows.
+ *
+ * checkpoint is called before anything that might edit, with the state as it
+ * is. The checkpoint only becomes an undo step once a later call sees a
+ * different state, so a click that changes nothing doesn't fill the history
+ * or throw away the redo stack. undo and redo take the state as it is now and
+ * return the one to restore, or nullptr when there is nothing to go back (or
+ * forward) to.
+ */
+
+class UndoHistory {
+public:
+  using State = std::shared_ptr<const EngineSnapshot>;
+
+  UndoHistory(int max_steps = default_max_steps);
+  ~UndoHistory();
+
+  // Getters & Setters
+  bool can_undo();
+  bool can_redo();
+  int get_num_undo_steps();
+  int get_num_redo_steps();
+  int get_max_steps();
+  void set_max_steps(int steps);
+
+  // Methods
+  void checkpoint(const State &current);
+  State undo(const State &current);
+  State redo(const State &current);
+  void clear();
+
+  static constexpr int default_max_steps{100};
+
+private:
+  int max_steps;
+  // oldest first
+  std::deque<State> undo_states;
+  std::vector<State> redo_states;
+  // the last checkpoint, until it's known whether anything changed
+  State before;
+
+  void commit(const State &current);
+  void trim();
+};
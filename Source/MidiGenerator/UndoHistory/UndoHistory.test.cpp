@@ -0,0 +1,117 @@
+/*
+ * UndoHistory.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "UndoHistory.hpp"
+#include "../MidiGenerator.hpp"
+
+class UndoHistoryTests : public UnitTest {
+public:
+  UndoHistoryTests() : UnitTest("UndoHistory Testing") {}
+
+  void runTest() override {
+    // == checkpoint / undo / redo ==
+    beginTest("undo / redo");
+
+    MidiGenerator generator(4);
+    UndoHistory history;
+    expect(!history.can_undo() && !history.can_redo(),
+           "a new history should be empty");
+    expect(history.undo(generator.get_snapshot()) == nullptr,
+           "there should be nothing to undo");
+
+    UndoHistory::State original = generator.get_snapshot();
+    history.checkpoint(generator.get_snapshot());
+    generator.set_neuron_threshold(1, 42);
+    history.checkpoint(generator.get_snapshot());
+    generator.set_neuron_connection_weight(2, 3, -17);
+    UndoHistory::State edited = generator.get_snapshot();
+
+    generator.apply_state(*history.undo(generator.get_snapshot()));
+    expect(generator.get_neuron_connection_weight(2, 3) ==
+                   original->get_connection_weight(2, 3) &&
+               generator.get_neuron_threshold(1) == 42,
+           "undo should restore the state before the last edit");
+    generator.apply_state(*history.undo(generator.get_snapshot()));
+    expect(generator.get_neuron_threshold(1) ==
+               original->thresholds.at(1),
+           "undo should restore the state before the first edit");
+    expect(!history.can_undo() && history.get_num_redo_steps() == 2,
+           "both edits should be redoable");
+
+    generator.apply_state(*history.redo(generator.get_snapshot()));
+    generator.apply_state(*history.redo(generator.get_snapshot()));
+    expect(generator.get_neuron_connection_weight(2, 3) == -17 &&
+               generator.get_neuron_threshold(1) == 42,
+           "redo should restore both edits");
+    expect(history.redo(generator.get_snapshot()) == nullptr,
+           "there should be nothing left to redo");
+
+    beginTest("checkpoint - only records changes");
+
+    history.clear();
+    history.checkpoint(generator.get_snapshot());
+    history.checkpoint(generator.get_snapshot());
+    history.checkpoint(generator.get_snapshot());
+    expect(history.undo(generator.get_snapshot()) == nullptr,
+           "checkpoints without an edit should record nothing");
+
+    history.checkpoint(generator.get_snapshot());
+    generator.set_neuron_midi_note(0, 70);
+    generator.apply_state(*history.undo(generator.get_snapshot()));
+    history.checkpoint(generator.get_snapshot());
+    expect(history.can_redo(),
+           "a checkpoint without an edit shouldn't clear the redo stack");
+    generator.set_neuron_midi_note(0, 71);
+    history.checkpoint(generator.get_snapshot());
+    expect(!history.can_redo(), "an edit should clear the redo stack");
+
+    beginTest("max steps");
+
+    history.clear();
+    history.set_max_steps(3);
+    for (int i = 0; i < 10; ++i) {
+      history.checkpoint(generator.get_snapshot());
+      generator.set_neuron_threshold(0, i);
+    }
+    history.checkpoint(generator.get_snapshot());
+    expect(history.get_num_undo_steps() == 3,
+           "the history should be bounded by max steps");
+
+    // == structural sharing ==
+    beginTest("snapshots share unchanged rows");
+
+    expect(edited->connection_weights.at(2) !=
+               original->connection_weights.at(2),
+           "the edited row should be new");
+    for (int from : {0, 1, 3}) {
+      expect(edited->connection_weights.at(from) ==
+                 original->connection_weights.at(from),
+             "unedited rows should be shared, not copied");
+    }
+
+    beginTest("apply_state - only writes rows that differ");
+
+    MidiGenerator target(4);
+    target.set_neuron_connection_weight(2, 0, 5);
+    target.set_neuron_connection_weight(3, 0, 6);
+    UndoHistory::State target_state = target.get_snapshot();
+    target.set_neuron_connection_weight(3, 1, 7);
+    target.apply_state(*target_state);
+    UndoHistory::State applied = target.get_snapshot();
+    expect(target.get_neuron_connection_weight(3, 1) ==
+               target_state->get_connection_weight(3, 1),
+           "the changed row should be restored");
+    expect(applied->connection_weights.at(3) !=
+               target_state->connection_weights.at(3),
+           "the restored row should be published again");
+    expect(applied->connection_weights.at(2) ==
+               target_state->connection_weights.at(2),
+           "a row that didn't change shouldn't be written or republished");
+  };
+};
+
+static UndoHistoryTests test;
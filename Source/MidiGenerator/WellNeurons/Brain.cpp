@@ -8,75 +8,143 @@
 #include "Brain.hpp"
 #include <algorithm>
 #include <iostream>
+#include <utility>
 
-Brain::Brain(int starting_num_neurons) {
+Brain::Brain(int starting_num_neurons)
+    : input_weights{std::make_shared<std::vector<int>>()} {
   for (int i{0}; i < starting_num_neurons; ++i) {
     add_neuron();
   }
 };
+// The copy shares every block, but not the morph, which the copy's own
+// morph writes again once it plays.
+Brain::Brain(const Brain &other)
+    : neurons(other.neurons), input_weights{other.input_weights},
+      connection_weights(other.connection_weights),
+      thresholds(other.thresholds), reserved_neurons{other.reserved_neurons},
+      output(other.output), output_levels(other.output_levels),
+      weighted_input(other.weighted_input),
+      connection_energy(other.connection_energy) {
+  for (int i = 0; i < num_neurons(); ++i) {
+    neurons[i].set_threshold(thresholds[i]);
+  }
+}
 Brain::~Brain(){};
 
+// Reserves room for `max_neurons` so that growing the network up to that size
+// doesn't reallocate the existing storage. Blocks shared with another brain
+// stay shared, and are given the reserved room when they're copied.
+void Brain::prepare(int max_neurons) {
+  reserved_neurons = std::max(max_neurons, num_neurons());
+  neurons.reserve(reserved_neurons);
+  connection_weights.reserve(reserved_neurons);
+  thresholds.reserve(reserved_neurons);
+  morphed_input_weights.reserve(reserved_neurons);
+  morphed_connection_weights.reserve(static_cast<size_t>(reserved_neurons) *
+                                     reserved_neurons);
+  output.reserve(reserved_neurons);
+  output_levels.reserve(reserved_neurons);
+  weighted_input.reserve(reserved_neurons);
+  connection_energy.reserve(reserved_neurons);
+}
+
 /*
  * Getters
  */
 
-std::vector<int> Brain::get_output() {
-  std::vector<int> outputs(num_neurons(), 0);
-  transform(neurons.begin(), neurons.end(), outputs.begin(),
-            [](Neuron n) { return n.get_output(); });
-  return outputs;
+const std::vector<int> &Brain::get_output() {
+  transform(neurons.begin(), neurons.end(), output.begin(),
+            [](Neuron &n) { return n.get_output(); });
+  return output;
+};
+const std::vector<int> &Brain::get_output_levels() {
+  transform(neurons.begin(), neurons.end(), output_levels.begin(),
+            [](Neuron &n) { return n.get_output_level(); });
+  return output_levels;
 };
 
 std::vector<Neuron> Brain::get_neurons() { return neurons; };
 
 std::vector<std::vector<int>> Brain::get_connection_weights() {
-  return connection_weights;
+  std::vector<std::vector<int>> weights;
+  weights.reserve(connection_weights.size());
+  for (const Block &row : connection_weights) {
+    weights.push_back(*row);
+  }
+  return weights;
 };
 
-std::vector<int> Brain::get_input_weights() { return input_weights; }
+std::vector<int> Brain::get_input_weights() { return *input_weights; }
 
 int Brain::get_input_weight_for_neuron(int neuron_num) {
-  return input_weights.at(neuron_num);
+  return input_weights->at(neuron_num);
 }
 
 int Brain::get_connection_weight_for_neurons(int from, int to) {
-  return connection_weights.at(from).at(to);
+  return connection_weights.at(from)->at(to);
 }
 
 int Brain::get_threshold_for_neuron(int neuron_num) {
-  return neurons.at(neuron_num).get_threshold();
+  return thresholds.at(neuron_num);
+}
+
+int Brain::get_state_for_neuron(int neuron_num) {
+  return neurons.at(neuron_num).get_state();
 }
 
 /*
  * Setters
  */
 
-void Brain::set_input_weights(std::vector<int> new_weights) {
-  if (input_weights.size() != new_weights.size()) {
+// The setters copy into the existing storage, so setting weights of the same
+// shape never allocates once the brain is prepared.
+void Brain::set_input_weights(const std::vector<int> &new_weights) {
+  if (input_weights->size() != new_weights.size()) {
     throw std::invalid_argument("input weights incorect shape");
   }
-  input_weights = new_weights;
+  std::vector<int> &weights = writable(input_weights);
+  std::copy(new_weights.begin(), new_weights.end(), weights.begin());
 }
 
-void Brain::set_connection_weights(std::vector<std::vector<int>> new_weights) {
+void Brain::set_connection_weights(
+    const std::vector<std::vector<int>> &new_weights) {
   if (connection_weights.size() != new_weights.size() ||
-      connection_weights.at(0).size() != new_weights.at(0).size()) {
+      connection_weights.at(0)->size() != new_weights.at(0).size()) {
+    throw std::invalid_argument("connection weights incorect shape");
+  }
+  for (int from = 0; from < new_weights.size(); ++from) {
+    set_connection_weights_from(from, new_weights[from]);
+  }
+}
+
+void Brain::set_connection_weights_from(int from,
+                                        const std::vector<int> &new_weights) {
+  if (connection_weights.at(from)->size() != new_weights.size()) {
     throw std::invalid_argument("connection weights incorect shape");
   }
-  connection_weights = new_weights;
+  std::vector<int> &weights = writable(connection_weights[from]);
+  std::copy(new_weights.begin(), new_weights.end(), weights.begin());
 }
 
 void Brain::set_connection_weight_for_neurons(int from, int to,
                                               int new_weight) {
-  connection_weights.at(from).at(to) = new_weight;
+  writable(connection_weights.at(from)).at(to) = new_weight;
 };
 
 void Brain::set_input_weight_for_neuron(int neuron_num, int new_weight) {
-  input_weights.at(neuron_num) = new_weight;
+  writable(input_weights).at(neuron_num) = new_weight;
 };
 
 void Brain::set_threshold_for_neuron(int neuron_num, int new_threshold) {
-  neurons.at(neuron_num).set_threshold(new_threshold);
+  thresholds.at(neuron_num) = new_threshold;
+  if (!morphed) {
+    neurons[neuron_num].set_threshold(new_threshold);
+  }
+};
+
+// e.g. to rewind the network to a state it was in before
+void Brain::set_state_for_neuron(int neuron_num, int new_state) {
+  neurons.at(neuron_num).set_state(new_state);
 };
 
 /*
@@ -85,63 +153,128 @@ void Brain::set_threshold_for_neuron(int neuron_num, int new_threshold) {
 
 int Brain::num_neurons() { return static_cast<int>(neurons.size()); };
 
+// Whether a row of connection weights (or the input weights) is the same
+// block in both brains, rather than an equal copy.
+bool Brain::shares_connection_weights_from(const Brain &other, int from) {
+  return connection_weights.at(from) == other.connection_weights.at(from);
+}
+
+bool Brain::shares_input_weights(const Brain &other) {
+  return input_weights == other.input_weights;
+}
+
+// Changing the size of the network ends any morph, which was for the old size.
 void Brain::add_neuron() {
+  clear_morph();
   neurons.push_back(Neuron());
-  for (int i = 0; i < connection_weights.size(); ++i) {
-    connection_weights.at(i).push_back(0);
+  thresholds.push_back(0);
+  for (Block &row : connection_weights) {
+    writable(row).push_back(0);
   }
-  connection_weights.push_back(std::vector<int>(num_neurons(), 0));
-  input_weights.push_back(0);
+  auto weights = std::make_shared<std::vector<int>>(num_neurons(), 0);
+  weights->reserve(reserved_neurons);
+  connection_weights.push_back(std::move(weights));
+  writable(input_weights).push_back(0);
+  resize_working_space();
 };
 
 void Brain::remove_neuron() {
+  clear_morph();
   neurons.pop_back();
-  input_weights.pop_back();
+  thresholds.pop_back();
+  writable(input_weights).pop_back();
   connection_weights.pop_back();
-  for (int i = 0; i < connection_weights.size(); ++i) {
-    connection_weights.at(i).pop_back();
+  for (Block &row : connection_weights) {
+    writable(row).pop_back();
   }
+  resize_working_space();
 };
 
 void Brain::remove_neuron_at(int neuron_index) {
+  clear_morph();
   neurons.erase(neurons.begin() + neuron_index);
-  input_weights.erase(input_weights.begin() + neuron_index);
+  thresholds.erase(thresholds.begin() + neuron_index);
+  std::vector<int> &inputs = writable(input_weights);
+  inputs.erase(inputs.begin() + neuron_index);
   connection_weights.erase(connection_weights.begin() + neuron_index);
-  for (int i = 0; i < connection_weights.size(); ++i) {
-    std::vector<int> *n = &connection_weights.at(i);
-    n->erase(n->begin() + neuron_index);
+  for (Block &row : connection_weights) {
+    std::vector<int> &n = writable(row);
+    n.erase(n.begin() + neuron_index);
   }
+  resize_working_space();
 };
 
-std::vector<int> Brain::get_weighted_input(std::vector<int> input) {
-  assert(input.size() == num_neurons());
-  std::vector<int> weighted_input(num_neurons(), 0);
-  for (int i = 0; i < input.size(); ++i) {
-    weighted_input.at(i) = input.at(i) * input_weights.at(i);
+/*
+ * Morph
+ */
+
+bool Brain::is_morphed() { return morphed; }
+
+// The first values written start the morph from the brain's own, so the
+// morph can be written a few rows at a time.
+void Brain::set_morphed_input_weights(const std::vector<int> &new_weights) {
+  assert(new_weights.size() == num_neurons());
+  start_morph();
+  std::copy(new_weights.begin(), new_weights.end(),
+            morphed_input_weights.begin());
+}
+
+void Brain::set_morphed_thresholds(const std::vector<int> &new_thresholds) {
+  assert(new_thresholds.size() == num_neurons());
+  start_morph();
+  for (int i = 0; i < num_neurons(); ++i) {
+    neurons[i].set_threshold(new_thresholds[i]);
   }
-  return weighted_input;
-};
+}
 
-std::vector<int> Brain::get_connection_energy(std::vector<int> output) {
-  assert(output.size() == num_neurons());
-  std::vector<int> connection_energy(num_neurons(), 0);
+void Brain::set_morphed_connection_weights_from(
+    int from, const std::vector<int> &new_weights) {
+  assert(new_weights.size() == num_neurons());
+  start_morph();
+  std::copy(new_weights.begin(), new_weights.end(),
+            morphed_connection_weights.begin() + (from * num_neurons()));
+}
+
+// Back to playing the brain's own weights and thresholds.
+void Brain::clear_morph() {
+  if (!morphed) {
+    return;
+  }
+  morphed = false;
   for (int i = 0; i < num_neurons(); ++i) {
-    int total_connection_energy = 0;
-    for (int j = 0; j < num_neurons(); ++j) {
-      total_connection_energy += connection_weights.at(j).at(i) * output.at(j);
-    }
-    connection_energy.at(i) = total_connection_energy;
+    neurons[i].set_threshold(thresholds[i]);
   }
+}
+
+int Brain::get_played_input_weight(int neuron_num) {
+  return played_input_weights()[neuron_num];
+}
+
+int Brain::get_played_threshold(int neuron_num) {
+  return neurons.at(neuron_num).get_threshold();
+}
+
+int Brain::get_played_connection_weight(int from, int to) {
+  return played_connection_weights_from(from)[to];
+}
+
+std::vector<int> Brain::get_weighted_input(const std::vector<int> &input) {
+  calculate_weighted_input(input);
+  return weighted_input;
+};
+
+std::vector<int> Brain::get_connection_energy(const std::vector<int> &output) {
+  calculate_connection_energy(output);
   return connection_energy;
 };
 
-void Brain::input_to_neurons(std::vector<int> input,
-                             std::vector<int> prev_output) {
-  std::vector<int> weighted_input = get_weighted_input(input);
-  std::vector<int> connection_energy = get_connection_energy(prev_output);
+void Brain::input_to_neurons(const std::vector<int> &input,
+                             const std::vector<int> &prev_output) {
+  calculate_weighted_input(input);
+  calculate_connection_energy(prev_output);
   for (int i = 0; i < neurons.size(); ++i) {
-    int next_input = weighted_input.at(i) + connection_energy.at(i);
-    neurons.at(i).set_input(next_input);
+    int next_input = weighted_input[i] + connection_energy[i];
+    neurons[i].set_input(next_input);
   }
 }
 
@@ -149,8 +282,130 @@ void Brain::neurons_update_state() {
   for_each(neurons.begin(), neurons.end(), [](Neuron &n) { n.update_state(); });
 };
 
-std::vector<int> Brain::process_next(std::vector<int> input) {
+const std::vector<int> &Brain::process_next(const std::vector<int> &input) {
   input_to_neurons(input, get_output());
   neurons_update_state();
   return get_output();
 };
+
+// The same as calling process_next `num_ticks` times with the same input,
+// without stepping through every tick. While no neuron's output changes, each
+// state moves by the same amount every tick, so the brain jumps straight to
+// the next tick where an output does change. Only the rows of neurons whose
+// output changed are added to the connection energy, rather than all of them.
+void Brain::fast_forward(const std::vector<int> &input, int64_t num_ticks) {
+  calculate_weighted_input(input);
+  const std::vector<int> &fired = get_output();
+  calculate_connection_energy(fired);
+
+  while (num_ticks > 0) {
+    int64_t ticks = num_ticks;
+    for (int i = 0; i < num_neurons(); ++i) {
+      int64_t delta =
+          static_cast<int64_t>(weighted_input[i]) + connection_energy[i];
+      int64_t over = static_cast<int64_t>(neurons[i].get_state()) -
+                     neurons[i].get_threshold();
+      if (fired[i] == 1 && delta < 0) {
+        // stops when the state falls back to the threshold
+        ticks = std::min(ticks, (over - delta - 1) / -delta);
+      } else if (fired[i] == 0 && delta > 0) {
+        // fires when the state goes over the threshold
+        ticks = std::min(ticks, (-over / delta) + 1);
+      }
+    }
+    for (int i = 0; i < num_neurons(); ++i) {
+      int64_t delta =
+          static_cast<int64_t>(weighted_input[i]) + connection_energy[i];
+      neurons[i].set_state(
+          static_cast<int>(neurons[i].get_state() + (ticks * delta)));
+    }
+    num_ticks -= ticks;
+
+    for (int j = 0; j < num_neurons(); ++j) {
+      int now = neurons[j].get_output();
+      if (now == output[j]) {
+        continue;
+      }
+      const int *weights_from_j = played_connection_weights_from(j);
+      int change = now - output[j];
+      for (int i = 0; i < num_neurons(); ++i) {
+        connection_energy[i] += weights_from_j[i] * change;
+      }
+      output[j] = now;
+    }
+  }
+}
+
+/*
+ * Private Methods
+ */
+
+// Within the reserved storage, so a prepared brain doesn't allocate.
+void Brain::start_morph() {
+  if (morphed) {
+    return;
+  }
+  int n = num_neurons();
+  morphed_input_weights.assign(input_weights->begin(), input_weights->end());
+  morphed_connection_weights.resize(static_cast<size_t>(n) * n);
+  for (int from = 0; from < n; ++from) {
+    std::copy(connection_weights[from]->begin(),
+              connection_weights[from]->end(),
+              morphed_connection_weights.begin() + (from * n));
+  }
+  morphed = true;
+}
+
+const int *Brain::played_input_weights() {
+  return morphed ? morphed_input_weights.data() : input_weights->data();
+}
+
+const int *Brain::played_connection_weights_from(int from) {
+  return morphed ? &morphed_connection_weights[from * num_neurons()]
+                 : connection_weights[from]->data();
+}
+
+// The block, copied first if another brain shares it. The copy keeps the
+// reserved capacity, so a prepared brain can still grow without reallocating.
+std::vector<int> &Brain::writable(Block &block) {
+  if (block.use_count() > 1) {
+    auto copy = std::make_shared<std::vector<int>>();
+    copy->reserve(std::max(block->capacity(),
+                           static_cast<size_t>(reserved_neurons)));
+    copy->assign(block->begin(), block->end());
+    block = std::move(copy);
+  }
+  return *block;
+}
+
+void Brain::resize_working_space() {
+  output.resize(neurons.size(), 0);
+  output_levels.resize(neurons.size(), 0);
+  weighted_input.resize(neurons.size(), 0);
+  connection_energy.resize(neurons.size(), 0);
+}
+
+void Brain::calculate_weighted_input(const std::vector<int> &input) {
+  assert(input.size() == num_neurons());
+  const int *weights = played_input_weights();
+  for (int i = 0; i < input.size(); ++i) {
+    weighted_input[i] = input[i] * weights[i];
+  }
+}
+
+// Only neurons that produced output contribute energy, so this walks the
+// connection weights of the firing neurons row by row.
+void Brain::calculate_connection_energy(const std::vector<int> &output) {
+  assert(output.size() == num_neurons());
+  std::fill(connection_energy.begin(), connection_energy.end(), 0);
+  for (int j = 0; j < num_neurons(); ++j) {
+    int output_j = output[j];
+    if (output_j == 0) {
+      continue;
+    }
+    const int *weights_from_j = played_connection_weights_from(j);
+    for (int i = 0; i < num_neurons(); ++i) {
+      connection_energy[i] += weights_from_j[i] * output_j;
+    }
+  }
+}
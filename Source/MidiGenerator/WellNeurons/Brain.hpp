@@ -10,42 +10,109 @@
 #include "Neuron.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+/*
+ * The input weights and each row of connection weights are reference counted
+ * blocks, shared when a brain is copied and copied themselves only when one of
+ * the brains writes to them. Copying a brain to change it (e.g. to add a
+ * neuron) copies the rows it changes, not the whole network. The neurons hold
+ * their state as the brain plays, so each brain has its own.
+ *
+ * prepare only reserves room, so a prepared copy still shares every block it
+ * didn't change. A block is copied the first time it is written, so a brain
+ * being played mustn't be written to - change a copy and hand that over.
+ *
+ * A morph (see BrainMorph) is played in place of the weights and thresholds
+ * while it is set. It is written on the audio thread into storage each brain
+ * has to itself and a copy doesn't take, so the blocks are only ever written
+ * on the message thread and the getters always give the brain's own values.
+ */
+
 class Brain {
 public:
   Brain(int starting_num_neurons);
+  Brain(const Brain &other);
   ~Brain();
 
-  std::vector<int> get_output();
+  void prepare(int max_neurons);
+
+  const std::vector<int> &get_output();
+  const std::vector<int> &get_output_levels();
   std::vector<Neuron> get_neurons();
   std::vector<int> get_input_weights();
   std::vector<std::vector<int>> get_connection_weights();
 
-  void set_input_weights(std::vector<int> new_weights);
-  void set_connection_weights(std::vector<std::vector<int>> new_weights);
+  void set_input_weights(const std::vector<int> &new_weights);
+  void set_connection_weights(const std::vector<std::vector<int>> &new_weights);
+  void set_connection_weights_from(int from,
+                                   const std::vector<int> &new_weights);
 
   int get_input_weight_for_neuron(int neuron_num);
   int get_connection_weight_for_neurons(int from, int to);
   int get_threshold_for_neuron(int neuron_num);
+  int get_state_for_neuron(int neuron_num);
   void set_input_weight_for_neuron(int neuron_num, int new_weight);
   void set_connection_weight_for_neurons(int from, int to, int new_weight);
   void set_threshold_for_neuron(int neuron_num, int new_threshold);
+  void set_state_for_neuron(int neuron_num, int new_state);
 
   void add_neuron();
   void remove_neuron(); // removes last added neuron
   void remove_neuron_at(int neuron_index);
 
+  // Morph - audio thread
+  bool is_morphed();
+  void set_morphed_input_weights(const std::vector<int> &new_weights);
+  void set_morphed_thresholds(const std::vector<int> &new_thresholds);
+  void set_morphed_connection_weights_from(int from,
+                                           const std::vector<int> &new_weights);
+  void clear_morph();
+  int get_played_input_weight(int neuron_num);
+  int get_played_threshold(int neuron_num);
+  int get_played_connection_weight(int from, int to);
+
   int num_neurons();
-  std::vector<int> get_weighted_input(std::vector<int> input);
-  std::vector<int> get_connection_energy(std::vector<int> output);
-  void input_to_neurons(std::vector<int> input, std::vector<int> prev_output);
+  bool shares_connection_weights_from(const Brain &other, int from);
+  bool shares_input_weights(const Brain &other);
+  std::vector<int> get_weighted_input(const std::vector<int> &input);
+  std::vector<int> get_connection_energy(const std::vector<int> &output);
+  void input_to_neurons(const std::vector<int> &input,
+                        const std::vector<int> &prev_output);
   void neurons_update_state();
-  std::vector<int> process_next(std::vector<int> input);
+  const std::vector<int> &process_next(const std::vector<int> &input);
+  void fast_forward(const std::vector<int> &input, int64_t num_ticks);
 
 private:
+  using Block = std::shared_ptr<std::vector<int>>;
+
   std::vector<Neuron> neurons;
-  std::vector<int> input_weights;
-  std::vector<std::vector<int>> connection_weights;
+  Block input_weights;
+  std::vector<Block> connection_weights;
+  // the neurons hold the thresholds played, which are these unless morphed
+  std::vector<int> thresholds;
+  int reserved_neurons{0};
+
+  // the morph, n x n row by row for the connection weights
+  bool morphed{false};
+  std::vector<int> morphed_input_weights;
+  std::vector<int> morphed_connection_weights;
+
+  // working space for process_next - sized with the network so that
+  // processing the next state never allocates
+  std::vector<int> output;
+  std::vector<int> output_levels;
+  std::vector<int> weighted_input;
+  std::vector<int> connection_energy;
+
+  std::vector<int> &writable(Block &block);
+  void start_morph();
+  const int *played_input_weights();
+  const int *played_connection_weights_from(int from);
+  void resize_working_space();
+  void calculate_weighted_input(const std::vector<int> &input);
+  void calculate_connection_energy(const std::vector<int> &output);
 };
@@ -8,6 +8,8 @@
 #include "Neuron.hpp"
 #include <cstdio>
 
+constexpr int Neuron::max_output_level;
+
 Neuron::Neuron(){};
 Neuron::~Neuron(){};
 
@@ -23,8 +25,17 @@ int Neuron::get_output() {
   }
 };
 
+int Neuron::get_output_level() {
+  int level = state - threshold;
+  if (level <= 0) {
+    return 0;
+  }
+  return level < max_output_level ? level : max_output_level;
+};
+
 void Neuron::set_input(int new_input) { input = new_input; };
 void Neuron::set_threshold(int new_threshold) { threshold = new_threshold; };
+void Neuron::set_state(int new_state) { state = new_state; };
 
 void Neuron::update_state() {
   state = state + input;
@@ -14,13 +14,18 @@ public:
   Neuron();
   ~Neuron();
 
+  // graded output is how far the state is over the threshold, capped here
+  static constexpr int max_output_level{127};
+
   int get_input();
   int get_output();
+  int get_output_level();
   int get_state();
   int get_threshold();
 
   void set_input(int new_input);
   void set_threshold(int new_threshold);
+  void set_state(int new_state);
 
   void update_state();
 
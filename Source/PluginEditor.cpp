@@ -17,7 +17,7 @@ WellsAudioProcessorEditor::WellsAudioProcessorEditor(WellsAudioProcessor &p)
   // Make sure that before the constructor has finished, you've set the
   // editor's size to whatever you need it to be.
   setResizable(true, true);
-  setSize(800, 600);
+  setSize(1000, 760);
 
   addAndMakeVisible(&mainComponent);
 }
@@ -10,6 +10,7 @@
 
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
+#include "MidiGenerator/StateSerializer/StateSerializer.hpp"
 
 //==============================================================================
 WellsAudioProcessor::WellsAudioProcessor()
@@ -23,12 +24,23 @@ WellsAudioProcessor::WellsAudioProcessor()
 #endif
                          ),
 #endif
-      midiGenerator(std::make_unique<MidiGenerator>(5)) {
-
-  // Run all tests when plugin loads in debug
+      generators(std::make_unique<MidiGenerator>(5)), current_program{0} {
+  midiGenerator = generators.get_latest();
+  midiGenerator->set_activity_feed(&activityFeed);
+  midiGenerator->set_fast_forward(&fastForward);
+  addParameter(morphAmount =
+                   new AudioParameterFloat("morph", "Morph", 0.0f, 1.0f, 0.0f));
+
+  // Run all tests when plugin loads in debug (but not again for the
+  // processors the tests build)
 #ifdef DEBUG
-  UnitTestRunner testRunner;
-  testRunner.runAllTests();
+  static bool is_running_tests{false};
+  if (!is_running_tests) {
+    is_running_tests = true;
+    UnitTestRunner testRunner;
+    testRunner.runAllTests();
+    is_running_tests = false;
+  }
 #endif
 }
 
@@ -64,29 +76,64 @@ bool WellsAudioProcessor::isMidiEffect() const {
 double WellsAudioProcessor::getTailLengthSeconds() const { return 0.0; }
 
 int WellsAudioProcessor::getNumPrograms() {
-  return 1; // NB: some hosts don't cope very well if you tell them there are 0
-            // programs, so this should be at least 1, even if you're not really
-            // implementing programs.
+  return presetBank.get_num_programs();
 }
 
-int WellsAudioProcessor::getCurrentProgram() { return 0; }
+int WellsAudioProcessor::getCurrentProgram() { return current_program; }
 
-void WellsAudioProcessor::setCurrentProgram(int index) {}
+// The program's generator is already built and prepared, so it is handed
+// straight to the audio thread, which switches on the next tick. It keeps
+// playing the way the one it replaces was. The bank then builds the program
+// again, ready for the next switch.
+void WellsAudioProcessor::setCurrentProgram(int index) {
+  if (index < 0 || index >= presetBank.get_num_programs()) {
+    return;
+  }
+  current_program = index;
+  checkpoint();
+  std::unique_ptr<MidiGenerator> program = presetBank.take_generator(index);
+  program->keep_transport_settings(*midiGenerator);
+  swap_generator(std::move(program));
+  presetBank.refill();
+}
 
-const String WellsAudioProcessor::getProgramName(int index) { return {}; }
+const String WellsAudioProcessor::getProgramName(int index) {
+  if (index < 0 || index >= presetBank.get_num_programs()) {
+    return {};
+  }
+  return presetBank.get_program_name(index);
+}
 
-void WellsAudioProcessor::changeProgramName(int index, const String &newName) {}
+void WellsAudioProcessor::changeProgramName(int index, const String &newName) {
+  if (index >= 0 && index < presetBank.get_num_programs()) {
+    presetBank.set_program_name(index, newName);
+  }
+}
 
 //==============================================================================
 void WellsAudioProcessor::prepareToPlay(double sampleRate,
                                         int samplesPerBlock) {
-  // Use this method as the place to do any pre-playback
-  // initialisation that you need..
+  // reserve everything up front so processBlock never has to grow anything
+  midiGenerator->prepare(sampleRate, samplesPerBlock,
+                         MidiGenerator::default_max_neurons);
+  presetBank.prepare(sampleRate, samplesPerBlock);
+  // an offline render can't wait for the worker, so it waits for the result
+  fastForward.set_synchronous(isNonRealtime());
+  int generated_bytes = midiGenerator->get_max_midi_buffer_bytes();
+  processedMidi.ensureSize(generated_bytes);
+  int merged_bytes = generated_bytes + (max_host_midi_events *
+                                        MidiProcessor::bytes_per_event);
+  mergedMidi.ensureSize(merged_bytes);
+  // the host's buffer may be smaller than that, so it is lent ours again
+  lentMidi.ensureSize(merged_bytes);
+  lent_midi_data = nullptr;
 }
 
 void WellsAudioProcessor::releaseResources() {
-  // When playback stops, you can use this as an opportunity to free up any
-  // spare memory, etc.
+  processedMidi = MidiBuffer();
+  mergedMidi = MidiBuffer();
+  lentMidi = MidiBuffer();
+  lent_midi_data = nullptr;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -123,7 +170,8 @@ void WellsAudioProcessor::processBlock(AudioBuffer<float> &buffer,
   // channels that didn't contain input data, (because these aren't
   // guaranteed to be empty - they may contain garbage).
   // This is here to avoid people getting screaming feedback
-  // when they first compile a plugin, but obviously you don't need to keep
+  // when they first compile a plugin, but obviously you don't need to keep
+
   // this code if your algorithm always overwrites all the output channels.
   for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
@@ -142,32 +190,165 @@ void WellsAudioProcessor::processBlock(AudioBuffer<float> &buffer,
 
   // Well Neuron Processing
 
-  MidiBuffer processedMidi;
+  processedMidi.clear();
   double sample_rate = getSampleRate();
   int num_buffer_samples = buffer.getNumSamples();
   AudioPlayHead::CurrentPositionInfo pos;
   getPlayHead()->getCurrentPosition(pos);
 
-  if (midiGenerator->get_is_on() && pos.isPlaying) {
-    midiGenerator->generate_next_midi_buffer(processedMidi, pos, sample_rate,
-                                             num_buffer_samples);
+  MidiGenerator *generator = generators.get_playing();
+  generator->set_morph_amount(morphAmount->get());
+  bool is_playing = generator->get_is_on() && pos.isPlaying;
+  int start_sample{0};
+  if (generators.has_pending()) {
+    // a new generator takes over on the next tick, so a switch stays in time
+    // (or straight away when nothing is playing)
+    int switch_sample{0};
+    if (is_playing) {
+      switch_sample =
+          generator->get_next_tick(pos, sample_rate, num_buffer_samples);
+    }
+    if (switch_sample < num_buffer_samples) {
+      generator->stop_at(processedMidi, pos, switch_sample);
+      generator = generators.switch_to_pending();
+      generator->set_morph_amount(morphAmount->get());
+      is_playing = generator->get_is_on() && pos.isPlaying;
+      start_sample = switch_sample;
+    }
+  }
+
+  if (is_playing) {
+    generator->generate_next_midi_buffer(processedMidi, midiMessages, pos,
+                                         sample_rate, num_buffer_samples,
+                                         start_sample);
+  } else {
+    // stopped or switched off - don't leave any scheduled notes hanging
+    generator->flush_scheduled_midi(processedMidi);
   }
 
-  midiMessages.swapWith(processedMidi);
+  if (generator->get_midi_through()) {
+    MidiMerger::merge(midiMessages, processedMidi, mergedMidi);
+    write_host_midi(mergedMidi, midiMessages);
+  } else {
+    write_host_midi(processedMidi, midiMessages);
+  }
+}
+
+// The host's MIDI buffer may not have room for the block, and growing it here
+// would allocate. So the first time the host passes a buffer, it is given our
+// reserved storage, already holding the block, in exchange for its own. From
+// then on it has room for anything we write, so the block is copied in. Only
+// a host that passes a different buffer every block makes us copy into
+// storage that wasn't reserved.
+void WellsAudioProcessor::write_host_midi(const MidiBuffer &output,
+                                          MidiBuffer &midiMessages) {
+  if (lent_midi_data != nullptr &&
+      midiMessages.data.getRawDataPointer() == lent_midi_data) {
+    MidiMerger::copy(output, midiMessages);
+    return;
+  }
+  MidiMerger::copy(output, lentMidi);
+  midiMessages.swapWith(lentMidi);
+  lent_midi_data = midiMessages.data.getRawDataPointer();
+}
+
+// The change is made to a copy of the latest generator, which is swapped in.
+// The copy shares the rows of weights the change leaves alone.
+void WellsAudioProcessor::edit(
+    const std::function<void(MidiGenerator &)> &change) {
+  std::unique_ptr<MidiGenerator> new_generator =
+      std::make_unique<MidiGenerator>(*midiGenerator);
+  change(*new_generator);
+  swap_generator(std::move(new_generator));
 }
 
 void WellsAudioProcessor::add_neuron() {
+  checkpoint();
   std::unique_ptr<MidiGenerator> new_generator =
       std::make_unique<MidiGenerator>(*midiGenerator);
   new_generator->add_neuron();
-  midiGenerator = std::move(new_generator);
+  swap_generator(std::move(new_generator));
 }
 
 void WellsAudioProcessor::remove_neuron_at(int neuron_index) {
+  checkpoint();
   std::unique_ptr<MidiGenerator> new_generator =
       std::make_unique<MidiGenerator>(*midiGenerator);
   new_generator->remove_neuron_at(neuron_index);
-  midiGenerator = std::move(new_generator);
+  swap_generator(std::move(new_generator));
+}
+
+void WellsAudioProcessor::store_morph_a() {
+  morph_a = midiGenerator->get_snapshot();
+  update_morph();
+}
+
+void WellsAudioProcessor::store_morph_b() {
+  morph_b = midiGenerator->get_snapshot();
+  update_morph();
+}
+
+// Once both ends are stored, a generator with the morph is built and swapped
+// in. The ends must be the same size as the network to be morphed.
+void WellsAudioProcessor::update_morph() {
+  if (morph_a == nullptr || morph_b == nullptr ||
+      morph_a->num_neurons() != midiGenerator->num_neurons()) {
+    return;
+  }
+  std::unique_ptr<MidiGenerator> new_generator =
+      std::make_unique<MidiGenerator>(*midiGenerator);
+  if (new_generator->set_morph_states(*morph_a, *morph_b)) {
+    swap_generator(std::move(new_generator));
+  }
+}
+
+void WellsAudioProcessor::checkpoint() {
+  undoHistory.checkpoint(midiGenerator->get_snapshot());
+}
+
+void WellsAudioProcessor::undo() {
+  UndoHistory::State previous = undoHistory.undo(midiGenerator->get_snapshot());
+  if (previous != nullptr) {
+    restore_state(*previous);
+  }
+}
+
+void WellsAudioProcessor::redo() {
+  UndoHistory::State next = undoHistory.redo(midiGenerator->get_snapshot());
+  if (next != nullptr) {
+    restore_state(*next);
+  }
+}
+
+// A restored state is applied to a copy of the generator and swapped in, so
+// the audio thread switches to all of it at once. Rows of connection weights
+// the state shares with the network as it is aren't written again. If the
+// neuron count has changed since, a new generator is built from the state.
+void WellsAudioProcessor::restore_state(const EngineSnapshot &state) {
+  std::unique_ptr<MidiGenerator> new_generator;
+  if (state.num_neurons() == midiGenerator->num_neurons()) {
+    new_generator = std::make_unique<MidiGenerator>(*midiGenerator);
+    new_generator->apply_state(state);
+  } else {
+    new_generator = std::make_unique<MidiGenerator>(state);
+  }
+  swap_generator(std::move(new_generator));
+}
+
+// The new generator is prepared here, off the audio thread. It keeps sharing
+// the weights it didn't change with the generator it was copied from, which
+// is never written to once it may be playing. The audio thread switches to it
+// on its next tick.
+void WellsAudioProcessor::swap_generator(std::unique_ptr<MidiGenerator> next) {
+  next->set_activity_feed(&activityFeed);
+  next->set_fast_forward(&fastForward);
+  // before playback is prepared, prepareToPlay will prepare it instead
+  if (getSampleRate() > 0) {
+    next->prepare(getSampleRate(), getBlockSize(),
+                  MidiGenerator::default_max_neurons);
+  }
+  generators.hand_off(std::move(next));
+  midiGenerator = generators.get_latest();
 }
 
 //==============================================================================
@@ -180,17 +361,24 @@ AudioProcessorEditor *WellsAudioProcessor::createEditor() {
 }
 
 //==============================================================================
+// The state is written from the latest snapshot, so saving never reads the
+// generator while it is being changed or played.
 void WellsAudioProcessor::getStateInformation(MemoryBlock &destData) {
-  // You should use this method to store your parameters in the memory block.
-  // You could do that either as raw data, or use the XML or ValueTree classes
-  // as intermediaries to make it easy to save and load complex data.
+  StateSerializer::write(*midiGenerator->get_snapshot(), destData);
 }
 
+// A new generator is built from the state and swapped in, so the audio thread
+// never sees a half restored network. Anything that isn't a valid state is
+// ignored. The undo history belongs to the network that was replaced, so it
+// is cleared.
 void WellsAudioProcessor::setStateInformation(const void *data,
                                               int sizeInBytes) {
-  // You should use this method to restore your parameters from this memory
-  // block, whose contents will have been created by the getStateInformation()
-  // call.
+  EngineSnapshot state;
+  if (sizeInBytes > 0 &&
+      StateSerializer::read(data, static_cast<size_t>(sizeInBytes), state)) {
+    swap_generator(std::make_unique<MidiGenerator>(state));
+    undoHistory.clear();
+  }
 }
 
 //==============================================================================
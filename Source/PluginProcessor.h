@@ -11,7 +11,12 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "MidiGenerator/GeneratorHandoff/GeneratorHandoff.hpp"
 #include "MidiGenerator/MidiGenerator.hpp"
+#include "MidiGenerator/MidiMerger/MidiMerger.hpp"
+#include "MidiGenerator/PresetBank/PresetBank.hpp"
+#include "MidiGenerator/UndoHistory/UndoHistory.hpp"
+#include <functional>
 #include <memory>
 
 //==============================================================================
@@ -59,11 +64,49 @@ public:
   void setStateInformation(const void *data, int sizeInBytes) override;
 
   //==Model=======================================================================
-  std::unique_ptr<MidiGenerator> midiGenerator;
+  // the latest generator, the one the editor reads (message thread only). It
+  // may be playing, so it's changed with edit rather than written to.
+  MidiGenerator *midiGenerator;
+  ActivityFeed activityFeed;
+  void edit(const std::function<void(MidiGenerator &)> &change);
   void add_neuron();
   void remove_neuron_at(int neuron_index);
 
+  // Morph - the network as it is now can be stored as either end of the
+  // morph, and the automatable morph parameter moves between them
+  AudioParameterFloat *morphAmount;
+  void store_morph_a();
+  void store_morph_b();
+
+  // Undo - the editor checkpoints before anything that might edit the network
+  void checkpoint();
+  void undo();
+  void redo();
+
 private:
+  // works out where the brain would be when the host starts playing part way
+  // through the song, declared first as every generator points to it
+  FastForward fastForward;
+  GeneratorHandoff generators;
+  PresetBank presetBank;
+  int current_program;
+  std::shared_ptr<const EngineSnapshot> morph_a, morph_b;
+  void swap_generator(std::unique_ptr<MidiGenerator> next);
+  void update_morph();
+  UndoHistory undoHistory;
+  void restore_state(const EngineSnapshot &state);
+
+  MidiBuffer processedMidi;
+  MidiBuffer mergedMidi;
+  // reserved storage lent to the host's MIDI buffer, and the storage it lent,
+  // so the block's MIDI can be copied into it without it growing
+  MidiBuffer lentMidi;
+  const uint8 *lent_midi_data{nullptr};
+  void write_host_midi(const MidiBuffer &output, MidiBuffer &midiMessages);
+
+  // room for the host's MIDI when it is merged with ours
+  static constexpr int max_host_midi_events{512};
+
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WellsAudioProcessor)
 };
@@ -0,0 +1,223 @@
+/*
+ * PluginProcessor.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PluginProcessor.h"
+#include "Utils/RealtimeChecker.hpp"
+
+// The host's transport, moved by the test between blocks
+class TestPlayHead : public AudioPlayHead {
+public:
+  CurrentPositionInfo pos;
+
+  bool getCurrentPosition(CurrentPositionInfo &result) override {
+    result = pos;
+    return true;
+  }
+};
+
+class WellsAudioProcessorTests : public UnitTest {
+public:
+  WellsAudioProcessorTests() : UnitTest("WellsAudioProcessor Testing") {}
+
+  void runTest() override {
+    beginTest("program changes keep playing");
+
+    {
+      WellsAudioProcessor processor;
+      TestPlayHead play_head;
+      play_head.pos.bpm = 120;
+      play_head.pos.isPlaying = true;
+      processor.setPlayHead(&play_head);
+      processor.setRateAndBufferSizeDetails(44100, 512);
+      processor.prepareToPlay(44100, 512);
+      processor.midiGenerator->toggleOnOff();
+      processor.midiGenerator->toggleMidiThrough();
+
+      AudioBuffer<float> audio(2, 512);
+      MidiBuffer midi;
+      for (int program = 1; program < processor.getNumPrograms(); ++program) {
+        processor.setCurrentProgram(program);
+        MidiGenerator *generator = processor.midiGenerator;
+        expect(generator->get_is_on(), "the new program should be on");
+        expect(generator->get_midi_through(), "MIDI through should be kept");
+        expect(!generator->get_receives_midi(), "MIDI in should be kept off");
+
+        int num_events{0};
+        for (int b = 0; b < 1000; ++b) {
+          midi.clear();
+          play_head.pos.timeInSamples = b * 512;
+          processor.processBlock(audio, midi);
+          num_events += midi.getNumEvents();
+        }
+        expect(num_events > 0, "program " + String(program) +
+                                   " should play after the change");
+      }
+      processor.releaseResources();
+    }
+
+    beginTest("edit shares the rows it doesn't change");
+
+    {
+      WellsAudioProcessor processor;
+      processor.setRateAndBufferSizeDetails(44100, 512);
+      processor.prepareToPlay(44100, 512);
+      MidiGenerator *playing = processor.midiGenerator;
+      processor.edit([](MidiGenerator &generator) {
+        generator.set_neuron_connection_weight(1, 2, 9);
+      });
+      MidiGenerator *edited = processor.midiGenerator;
+      bool shares_the_rest{true};
+      for (int from = 0; from < edited->num_neurons(); ++from) {
+        shares_the_rest = shares_the_rest &&
+                          (from == 1 ||
+                           edited->shares_connection_weights_from(*playing,
+                                                                  from));
+      }
+      expect(edited != playing, "the edit should be made to a copy");
+      expect(edited->get_neuron_connection_weight(1, 2) == 9 &&
+                 playing->get_neuron_connection_weight(1, 2) != 9,
+             "only the copy should be changed");
+      expect(!edited->shares_connection_weights_from(*playing, 1),
+             "the row changed should have been copied");
+      expect(shares_the_rest, "the prepared copy should share the other rows");
+      processor.releaseResources();
+    }
+
+    beginTest("processBlock doesn't grow the host's MIDI buffer");
+
+    {
+      WellsAudioProcessor processor;
+      TestPlayHead play_head;
+      play_head.pos.bpm = 120;
+      play_head.pos.isPlaying = true;
+      processor.setPlayHead(&play_head);
+      processor.setRateAndBufferSizeDetails(44100, 512);
+      processor.prepareToPlay(44100, 512);
+      MidiGenerator *generator = processor.midiGenerator;
+      generator->set_subdivision(16);
+      for (int i = 0; i < generator->num_neurons(); ++i) {
+        generator->set_neuron_threshold(i, -1);
+      }
+
+      // the host's buffer starts with no room at all, and the generator is
+      // switched on once the host has been playing for a while
+      AudioBuffer<float> audio(2, 512);
+      MidiBuffer midi;
+      const uint8 *storage{nullptr};
+      bool kept_storage{true};
+      int num_events{0};
+      for (int b = 0; b < 200; ++b) {
+        if (b == 20) {
+          generator->toggleOnOff();
+        }
+        midi.clear();
+        play_head.pos.timeInSamples = b * 512;
+        processor.processBlock(audio, midi);
+        num_events += midi.getNumEvents();
+        if (b == 0) {
+          storage = midi.data.getRawDataPointer();
+        }
+        kept_storage = kept_storage && midi.data.getRawDataPointer() == storage;
+      }
+      expect(num_events > 0, "the generator should have played");
+      expect(kept_storage, "the host's buffer shouldn't have been regrown");
+      processor.releaseResources();
+    }
+
+    beginTest("processBlock is real time safe through a session");
+
+    if (!RealtimeChecker::is_available()) {
+      logMessage("real time checks need a debug build with glibc, skipping");
+      return;
+    }
+
+    const double sample_rate{44100};
+    const int max_block_size{512};
+    WellsAudioProcessor processor;
+    TestPlayHead play_head;
+    play_head.pos.bpm = 120;
+    play_head.pos.isPlaying = true;
+    processor.setPlayHead(&play_head);
+    processor.setRateAndBufferSizeDetails(sample_rate, max_block_size);
+    processor.prepareToPlay(sample_rate, max_block_size);
+
+    // every neuron firing, with the host's MIDI passed through, and jumps in
+    // the song fast forwarded to
+    MidiGenerator *generator = processor.midiGenerator;
+    generator->toggleOnOff();
+    generator->toggleMidiThrough();
+    generator->toggleFollowsSongPosition();
+    generator->set_subdivision(4);
+    for (int i = 0; i < generator->num_neurons(); ++i) {
+      generator->set_neuron_threshold(i, -1);
+    }
+
+    AudioBuffer<float> audio(2, max_block_size);
+    MidiBuffer midi;
+
+    int num_violations{0}, num_events{0};
+    std::string report;
+    auto play_blocks = [&](int64 from, int num_blocks, int block_size) {
+      audio.setSize(2, block_size, false, false, true);
+      for (int b = 0; b < num_blocks; ++b) {
+        midi.clear();
+        midi.addEvent(MidiMessage::noteOn(1, 60, (uint8)100), 0);
+        play_head.pos.timeInSamples = from + b * block_size;
+        RealtimeChecker checker;
+        processor.processBlock(audio, midi);
+        checker.stop();
+        num_violations += checker.get_num_violations();
+        if (report.empty()) {
+          report = checker.get_report();
+        }
+        num_events += midi.getNumEvents();
+      }
+    };
+
+    // the host plays, changes its block size, stops and starts again, loops
+    // back and jumps ahead, while the editor changes the network and
+    // programs, stores the ends of a morph and the morph parameter is
+    // automated (message thread work is between the blocks, so isn't checked)
+    play_blocks(0, 100, max_block_size);
+    play_blocks(100 * max_block_size, 64, 100);
+    play_head.pos.isPlaying = false;
+    play_blocks(100 * max_block_size + 6400, 20, max_block_size);
+    play_head.pos.isPlaying = true;
+    play_blocks(0, 50, max_block_size);
+    processor.add_neuron();
+    play_blocks(50 * max_block_size, 50, max_block_size);
+    processor.undo();
+    play_blocks(100 * max_block_size, 50, max_block_size);
+    processor.store_morph_a();
+    processor.edit([](MidiGenerator &edited) {
+      for (int i = 0; i < edited.num_neurons(); ++i) {
+        edited.set_neuron_threshold(i, -2);
+      }
+    });
+    processor.store_morph_b();
+    expect(processor.midiGenerator->has_morph(), "the morph should be set");
+    play_blocks(88200, 20, max_block_size);
+    *processor.morphAmount = 0.5f;
+    play_blocks(88200 + 20 * max_block_size, 30, max_block_size);
+    play_blocks(44100 * 30, 20, max_block_size);
+    if (processor.getNumPrograms() > 1) {
+      processor.setCurrentProgram(1);
+    }
+    play_blocks(44100 * 60, 100, 64);
+    processor.setCurrentProgram(0);
+    play_blocks(44100 * 60 + 6400, 50, max_block_size);
+
+    expect(num_events > 0, "the session should have played notes");
+    expect(num_violations == 0, "the audio thread mustn't allocate, lock "
+                                "or touch files:\n" +
+                                    report);
+
+    processor.releaseResources();
+  };
+};
+
+static WellsAudioProcessorTests test;
@@ -0,0 +1,97 @@
+/*
+ * ActivityBar.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "ActivityBar.hpp"
+#include "Styles.hpp"
+
+// lights below this brightness are switched off
+static constexpr int min_light{16};
+static constexpr float light_size{12.0f};
+
+ActivityBar::ActivityBar(WellsAudioProcessor &p)
+    : lights(p.midiGenerator->num_neurons(), 0),
+      charges(p.midiGenerator->num_neurons(), 0) {}
+ActivityBar::~ActivityBar() {}
+
+void ActivityBar::paint(Graphics &g) {
+  auto area = getLocalBounds();
+  AppStyle.blockPadding.subtractFrom(area);
+
+  g.setColour(AppStyle.darkGrey);
+  g.fillRoundedRectangle(area.toFloat(), 5.0);
+  g.setColour(AppStyle.mediumGrey);
+  g.drawRoundedRectangle(area.toFloat(), 5.0, 1.0);
+
+  auto rowLabelArea = area.removeFromLeft(AppStyle.rowLabelWidth);
+  AppStyle.rowLabelPadding.subtractFrom(rowLabelArea);
+  g.setFont(AppStyle.fontSizeMedium);
+  g.setColour(AppStyle.lightGrey);
+  g.drawText("Activity", rowLabelArea, Justification::centredLeft, true);
+
+  for (int i = 0; i < lights.size(); ++i) {
+    auto column = get_column_bounds(i);
+    if (!g.clipRegionIntersects(column)) {
+      continue;
+    }
+    AppStyle.componentPadding.subtractFrom(column);
+
+    auto light = column.removeFromLeft(column.getHeight()).toFloat();
+    light = light.withSizeKeepingCentre(light_size, light_size);
+    g.setColour(AppStyle.veryDarkGrey.interpolatedWith(
+        AppStyle.buttonOnColour, lights[i] / 255.0f));
+    g.fillEllipse(light);
+
+    auto meter = column.reduced(0, column.getHeight() / 3);
+    g.setColour(AppStyle.veryDarkGrey);
+    g.fillRect(meter);
+    g.setColour(AppStyle.mediumGrey);
+    g.fillRect(meter.withWidth(
+        meter.getWidth() * charges[i] / ActivityFrame::full_charge));
+  }
+}
+
+void ActivityBar::update_activity(const ActivityFrame &activity,
+                                  bool has_activity) {
+  for (int i = 0; i < lights.size(); ++i) {
+    bool in_frame = has_activity && i < activity.num_neurons;
+    uint8 light = lights[i] - (lights[i] / 4);
+    if (light < min_light) {
+      light = 0;
+    }
+    if (in_frame && activity.has_fired(i)) {
+      light = 255;
+    }
+    uint8 charge = in_frame ? activity.charge[i] : charges[i];
+
+    if (light != lights[i] || charge != charges[i]) {
+      lights[i] = light;
+      charges[i] = charge;
+      repaint(get_column_bounds(i));
+    }
+  }
+}
+
+void ActivityBar::add_neuron_ui_update() {
+  lights.push_back(0);
+  charges.push_back(0);
+  repaint();
+}
+void ActivityBar::remove_neuron_ui_update() {
+  lights.pop_back();
+  charges.pop_back();
+  repaint();
+}
+
+// Private Methods
+
+Rectangle<int> ActivityBar::get_column_bounds(int neuron_index) {
+  auto area = getLocalBounds();
+  AppStyle.blockPadding.subtractFrom(area);
+  area.removeFromLeft(AppStyle.rowLabelWidth +
+                      (neuron_index * AppStyle.colWidth));
+  return area.removeFromLeft(AppStyle.colWidth);
+}
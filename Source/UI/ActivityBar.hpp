@@ -0,0 +1,44 @@
+/*
+ * ActivityBar.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../PluginProcessor.h"
+#include <vector>
+
+/*
+ * Activity Bar
+ *
+ * Shows what each neuron is doing while the plugin plays: a light that
+ * flashes when the neuron fires and fades out, and a meter of how close its
+ * state is to its threshold.
+ *
+ * It is updated at the display rate with the activity read from the
+ * processor's Activity Feed, and only the columns that have changed are
+ * repainted.
+ */
+
+class ActivityBar : public Component {
+public:
+  ActivityBar(WellsAudioProcessor &p);
+  ~ActivityBar();
+
+  void paint(Graphics &) override;
+
+  void update_activity(const ActivityFrame &activity, bool has_activity);
+  void add_neuron_ui_update();
+  void remove_neuron_ui_update();
+
+private:
+  std::vector<uint8> lights;
+  std::vector<uint8> charges;
+
+  Rectangle<int> get_column_bounds(int neuron_index);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ActivityBar)
+};
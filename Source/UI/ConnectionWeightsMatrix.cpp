@@ -8,19 +8,18 @@
 #include "ConnectionWeightsMatrix.hpp"
 #include "Styles.hpp"
 
+// cells smaller than this are drawn without their labels and values
+static constexpr int min_text_height{20};
+
 /*
  * Connection Weight Matrix
  */
 
 ConnectionWeightsMatrix::ConnectionWeightsMatrix(WellsAudioProcessor &p)
-    : processor(p) {
-  for (int i = 0; i < p.midiGenerator->num_neurons(); ++i) {
-    add_neuron_row_label(i);
-  }
-
-  for (int i = 0; i < p.midiGenerator->num_neurons(); ++i) {
-    add_connection_weight_slider(i);
-  }
+    : processor(p), connectionWeightsGrid(p),
+      seen_row_versions(p.midiGenerator->num_neurons(), 0) {
+  viewport.setViewedComponent(&connectionWeightsGrid, false);
+  addAndMakeVisible(viewport);
 }
 ConnectionWeightsMatrix::~ConnectionWeightsMatrix() {}
 
@@ -44,106 +43,238 @@ void ConnectionWeightsMatrix::resized() {
   auto area = getLocalBounds();
   AppStyle.blockPadding.subtractFrom(area);
   area.removeFromTop(AppStyle.connectionMatrixTitleHeight);
+  viewport.setBounds(area);
+}
+
+// Public Methods
 
-  for (int i = 0; i < neuronRowLabels.size(); ++i) {
-    auto rowArea = area.removeFromTop(AppStyle.connectionMatrixRowHeight);
-    neuronRowLabels.at(i)->setBounds(
-        rowArea.removeFromLeft(AppStyle.rowLabelWidth));
-    for (int j = 0; j < connectionWeightSliders.size(); ++j) {
-      auto sliderArea = rowArea.removeFromLeft(AppStyle.colWidth);
-      AppStyle.componentPadding.subtractFrom(sliderArea);
-      connectionWeightSliders.at(i).at(j)->setBounds(sliderArea);
+// Only the rows that have changed since the last update are repainted, so an
+// idle matrix costs one comparison rather than a read for every weight.
+void ConnectionWeightsMatrix::updateComponents() {
+  uint32 version =
+      processor.midiGenerator->get_version(MidiGenerator::connection_weights);
+  if (version == seen_version) {
+    return;
+  }
+  seen_version = version;
+
+  for (int i = 0; i < seen_row_versions.size(); ++i) {
+    uint32 row_version =
+        processor.midiGenerator->get_connection_row_version(i);
+    if (row_version != seen_row_versions.at(i)) {
+      seen_row_versions.at(i) = row_version;
+      connectionWeightsGrid.repaint_row(i);
     }
   }
 }
 
-void ConnectionWeightsMatrix::add_neuron_row_label(int neuron_index) {
-  std::unique_ptr<NeuronRowLabel> label =
-      std::make_unique<NeuronRowLabel>(neuron_index);
-  label->setJustificationType(Justification::centred);
-  label->setColour(Label::ColourIds::textColourId, AppStyle.lightGrey);
-  addAndMakeVisible(*label);
-  neuronRowLabels.push_back(std::move(label));
+void ConnectionWeightsMatrix::add_neuron_ui_update() {
+  seen_row_versions.push_back(0);
+  connectionWeightsGrid.set_num_neurons(seen_row_versions.size());
+}
+void ConnectionWeightsMatrix::remove_neuron_ui_update() {
+  seen_row_versions.pop_back();
+  connectionWeightsGrid.set_num_neurons(seen_row_versions.size());
 }
 
-void ConnectionWeightsMatrix::add_connection_weight_slider(int neuron_index) {
-  for (int i{0}; i < connectionWeightSliders.size(); ++i) {
-    std::unique_ptr<ConnectionWeightSlider> slider =
-        std::make_unique<ConnectionWeightSlider>(processor, i, neuron_index);
-    addAndMakeVisible(*slider);
-    connectionWeightSliders.at(i).push_back(std::move(slider));
+/*
+ * Connection Weights Grid
+ */
+
+ConnectionWeightsGrid::ConnectionWeightsGrid(WellsAudioProcessor &p)
+    : processor(p), num_neurons{0}, zoom{1.0f}, focused_from{no_focus},
+      focused_to{no_focus} {
+  setOpaque(true);
+  set_num_neurons(p.midiGenerator->num_neurons());
+}
+ConnectionWeightsGrid::~ConnectionWeightsGrid() {}
+
+void ConnectionWeightsGrid::paint(Graphics &g) {
+  g.fillAll(AppStyle.darkGrey);
+
+  // the editor can briefly be out of step with the number of neurons
+  auto snapshot = processor.midiGenerator->get_snapshot();
+  int num_cells = jmin(num_neurons, snapshot->num_neurons());
+  int cell_width = get_cell_width();
+  int cell_height = get_cell_height();
+  bool show_text = cell_height >= min_text_height;
+  auto clip = g.getClipBounds();
+
+  int first_row = jmax(0, clip.getY() / cell_height);
+  int last_row = jmin(num_cells, clip.getBottom() / cell_height + 1);
+  int first_col = jmax(0, (clip.getX() - AppStyle.rowLabelWidth) / cell_width);
+  int last_col = jmin(
+      num_cells, (clip.getRight() - AppStyle.rowLabelWidth) / cell_width + 1);
+
+  g.setFont(AppStyle.fontSizeMedium);
+  for (int from = first_row; from < last_row; ++from) {
+    if (show_text && clip.getX() < AppStyle.rowLabelWidth) {
+      g.setColour(AppStyle.lightGrey);
+      g.drawText("Neuron " + String(from + 1), 0, from * cell_height,
+                 AppStyle.rowLabelWidth, cell_height, Justification::centred);
+    }
+    for (int to = first_col; to < last_col; ++to) {
+      int weight = snapshot->get_connection_weight(from, to);
+      auto cell = get_cell_bounds(from, to);
+      g.setColour(get_weight_colour(weight));
+      g.fillRect(cell.reduced(1));
+      if (show_text) {
+        g.setColour(AppStyle.lightGrey);
+        g.drawText(String(weight), cell, Justification::centred);
+      }
+    }
   }
 
-  std::vector<std::unique_ptr<ConnectionWeightSlider>> sliderRow{};
-  for (int j = 0; j < connectionWeightSliders.size() + 1; ++j) {
-    std::unique_ptr<ConnectionWeightSlider> slider =
-        std::make_unique<ConnectionWeightSlider>(processor, neuron_index, j);
-    addAndMakeVisible(*slider);
-    sliderRow.push_back(std::move(slider));
+  if (focused_from != no_focus) {
+    g.setColour(AppStyle.lightGrey);
+    g.drawRect(get_cell_bounds(focused_from, focused_to));
   }
-  connectionWeightSliders.push_back(std::move(sliderRow));
 }
 
-void ConnectionWeightsMatrix::remove_connection_weight_slider() {
-  connectionWeightSliders.pop_back();
-  for (auto sliderRow = connectionWeightSliders.begin();
-       sliderRow != connectionWeightSliders.end(); ++sliderRow) {
-    (*sliderRow).pop_back();
+void ConnectionWeightsGrid::resized() { update_edit_slider_bounds(); }
+
+void ConnectionWeightsGrid::mouseDown(const MouseEvent &e) {
+  int column_x = e.x - AppStyle.rowLabelWidth;
+  if (column_x < 0) {
+    return;
+  }
+  int from = e.y / get_cell_height();
+  int to = column_x / get_cell_width();
+  if (from < num_neurons && to < num_neurons) {
+    focus_cell(from, to);
   }
 }
 
-// Public Methods
+void ConnectionWeightsGrid::mouseWheelMove(const MouseEvent &e,
+                                           const MouseWheelDetails &wheel) {
+  if (e.mods.isCommandDown()) {
+    set_zoom(zoom * (1.0f + wheel.deltaY));
+  } else {
+    // let the viewport scroll
+    Component::mouseWheelMove(e, wheel);
+  }
+}
 
-void ConnectionWeightsMatrix::updateComponents() {
-  for (auto sliderRow = connectionWeightSliders.begin();
-       sliderRow != connectionWeightSliders.end(); ++sliderRow) {
-    for (auto slider = sliderRow->begin(); slider != sliderRow->end();
-         ++slider) {
-      (*slider)->updateComponent();
+void ConnectionWeightsGrid::set_num_neurons(int n) {
+  num_neurons = n;
+  if (focused_from >= num_neurons || focused_to >= num_neurons) {
+    focused_from = no_focus;
+    focused_to = no_focus;
+    if (editSlider != nullptr) {
+      editSlider->setVisible(false);
     }
   }
+  update_size();
+  repaint();
 }
 
-void ConnectionWeightsMatrix::add_neuron_ui_update() {
-  add_neuron_row_label(neuronRowLabels.size());
-  add_connection_weight_slider(connectionWeightSliders.size());
-  resized();
+void ConnectionWeightsGrid::set_zoom(float z) {
+  zoom = jlimit(min_zoom, max_zoom, z);
+  update_size();
+  repaint();
 }
-void ConnectionWeightsMatrix::remove_neuron_ui_update() {
-  neuronRowLabels.pop_back();
-  remove_connection_weight_slider();
-  resized();
+
+void ConnectionWeightsGrid::repaint_row(int from) {
+  int cell_height = get_cell_height();
+  repaint(0, from * cell_height, getWidth(), cell_height);
+  if (from == focused_from) {
+    editSlider->updateComponent();
+  }
 }
 
-/*
- * Neuron Row Label
- */
+// Private Methods
+
+int ConnectionWeightsGrid::get_cell_width() {
+  return jmax(1, roundToInt(AppStyle.colWidth * zoom));
+}
+int ConnectionWeightsGrid::get_cell_height() {
+  return jmax(1, roundToInt(AppStyle.connectionMatrixRowHeight * zoom));
+}
+
+Rectangle<int> ConnectionWeightsGrid::get_cell_bounds(int from, int to) {
+  int cell_width = get_cell_width();
+  int cell_height = get_cell_height();
+  return Rectangle<int>(AppStyle.rowLabelWidth + to * cell_width,
+                        from * cell_height, cell_width, cell_height);
+}
 
-NeuronRowLabel::NeuronRowLabel(int i)
-    : Label("neuron" + String(i + 1), "Neuron " + String(i + 1)) {
-  setColour(Label::ColourIds::textColourId, AppStyle.darkGrey);
+Colour ConnectionWeightsGrid::get_weight_colour(int weight) {
+  float amount = jmin(1.0f, std::abs(weight) / (float)max_weight);
+  Colour full =
+      weight < 0 ? AppStyle.negativeWeightColour : AppStyle.buttonOnColour;
+  return AppStyle.veryDarkGrey.interpolatedWith(full, amount);
+}
+
+// The slider is only created once a cell is first focused, and is then reused
+// for every other cell.
+void ConnectionWeightsGrid::focus_cell(int from, int to) {
+  if (focused_from != no_focus) {
+    repaint(get_cell_bounds(focused_from, focused_to));
+  }
+  focused_from = from;
+  focused_to = to;
+
+  if (editSlider == nullptr) {
+    editSlider = std::make_unique<ConnectionWeightSlider>(processor);
+    addChildComponent(*editSlider);
+  }
+  editSlider->set_connection(from, to);
+  editSlider->updateComponent();
+  update_edit_slider_bounds();
+  editSlider->setVisible(true);
+  repaint(get_cell_bounds(from, to));
+}
+
+void ConnectionWeightsGrid::update_size() {
+  setSize(AppStyle.rowLabelWidth + (num_neurons * get_cell_width()),
+          num_neurons * get_cell_height());
+}
+
+// Small cells get a slider big enough to use, kept inside the grid.
+void ConnectionWeightsGrid::update_edit_slider_bounds() {
+  if (editSlider == nullptr || focused_from == no_focus) {
+    return;
+  }
+  auto cell = get_cell_bounds(focused_from, focused_to);
+  int width = jmax(cell.getWidth(), AppStyle.colWidth);
+  int height = jmax(cell.getHeight(), AppStyle.connectionMatrixRowHeight);
+  int x = jmax(0, jmin(cell.getX(), getWidth() - width));
+  int y = jmax(0, jmin(cell.getY(), getHeight() - height));
+
+  Rectangle<int> sliderArea(x, y, width, height);
+  AppStyle.componentPadding.subtractFrom(sliderArea);
+  editSlider->setBounds(sliderArea);
 }
-NeuronRowLabel::~NeuronRowLabel() {}
 
 /*
  * Connection Weight Slider
  */
 
-ConnectionWeightSlider::ConnectionWeightSlider(WellsAudioProcessor &p, int from,
-                                               int to)
-    : Slider("connectionWeightSlider" + String(from) + "-" + String(to)),
-      processor(p), neuron_from(from), neuron_to(to) {
+ConnectionWeightSlider::ConnectionWeightSlider(WellsAudioProcessor &p)
+    : Slider("connectionWeightSlider"), processor(p), neuron_from{0},
+      neuron_to{0} {
   setSliderStyle(Slider::IncDecButtons);
-  setRange(-256, 256, 1);
+  setRange(-ConnectionWeightsGrid::max_weight,
+           ConnectionWeightsGrid::max_weight, 1);
   setColour(Slider::ColourIds::textBoxBackgroundColourId, AppStyle.darkGrey);
   onValueChange = [this]() {
-    processor.midiGenerator->set_neuron_connection_weight(
-        neuron_from, neuron_to, getValue());
+    int from = neuron_from;
+    int to = neuron_to;
+    int weight = getValue();
+    processor.edit([from, to, weight](MidiGenerator &generator) {
+      generator.set_neuron_connection_weight(from, to, weight);
+    });
   };
 }
 ConnectionWeightSlider::~ConnectionWeightSlider() {}
 
+void ConnectionWeightSlider::set_connection(int from, int to) {
+  neuron_from = from;
+  neuron_to = to;
+}
+
 void ConnectionWeightSlider::updateComponent() {
   setValue(processor.midiGenerator->get_neuron_connection_weight(neuron_from,
-                                                                 neuron_to));
+                                                                 neuron_to),
+           dontSendNotification);
 }
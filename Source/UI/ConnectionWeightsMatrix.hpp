@@ -9,40 +9,81 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "../PluginProcessor.h"
+#include <memory>
 
 /*
- * Neuron Row Labels - label each row on connection weights
+ * Connection Weight Slider - controls the connection weight of whichever
+ * connection it has been pointed at
  */
 
-class NeuronRowLabel : public Label {
+class ConnectionWeightSlider : public Slider {
 public:
-  NeuronRowLabel(int neuron_index);
-  ~NeuronRowLabel();
+  ConnectionWeightSlider(WellsAudioProcessor &p);
+  ~ConnectionWeightSlider();
+
+  void set_connection(int from, int to);
+  void updateComponent();
 
 private:
+  WellsAudioProcessor &processor;
+  int neuron_from, neuron_to;
 };
 
 /*
- * Connection Weight Slider - controls the connection weight between two neurons
+ * Connection Weights Grid
+ *
+ * Draws every connection weight as a cell in a heatmap, one row for each
+ * neuron a connection comes from. Only the cells inside the area being
+ * repainted are drawn, so the cost of painting depends on the size of the
+ * view rather than the number of neurons.
+ *
+ * Clicking a cell focuses it. A single slider is created the first time a
+ * cell is focused and is moved over whichever cell has focus. Command + mouse
+ * wheel zooms.
  */
 
-class ConnectionWeightSlider : public Slider {
+class ConnectionWeightsGrid : public Component {
 public:
-  ConnectionWeightSlider(WellsAudioProcessor &p, int from, int to);
-  ~ConnectionWeightSlider();
+  ConnectionWeightsGrid(WellsAudioProcessor &p);
+  ~ConnectionWeightsGrid();
 
-  void updateComponent();
+  static constexpr int no_focus{-1};
+  static constexpr int max_weight{256};
+  static constexpr float min_zoom{0.25f};
+  static constexpr float max_zoom{2.0f};
+
+  void paint(Graphics &) override;
+  void resized() override;
+  void mouseDown(const MouseEvent &) override;
+  void mouseWheelMove(const MouseEvent &, const MouseWheelDetails &) override;
+
+  void set_num_neurons(int n);
+  void set_zoom(float z);
+  void repaint_row(int from);
 
 private:
   WellsAudioProcessor &processor;
-  int neuron_from, neuron_to;
+  int num_neurons;
+  float zoom;
+  int focused_from, focused_to;
+  std::unique_ptr<ConnectionWeightSlider> editSlider;
+
+  int get_cell_width();
+  int get_cell_height();
+  Rectangle<int> get_cell_bounds(int from, int to);
+  Colour get_weight_colour(int weight);
+  void focus_cell(int from, int to);
+  void update_size();
+  void update_edit_slider_bounds();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConnectionWeightsGrid)
 };
 
 /*
  * Connection Weight Matrix
  *
- * Used to control the connection weights between all of the neurons. It does
- * this using the connection weight sliders.
+ * Used to control the connection weights between all of the neurons. The
+ * weights are shown in a Connection Weights Grid inside a scrollable viewport.
  */
 
 class ConnectionWeightsMatrix : public Component {
@@ -60,13 +101,12 @@ public:
 private:
   WellsAudioProcessor &processor;
 
-  std::vector<std::unique_ptr<NeuronRowLabel>> neuronRowLabels;
-  std::vector<std::vector<std::unique_ptr<ConnectionWeightSlider>>>
-      connectionWeightSliders;
+  Viewport viewport;
+  ConnectionWeightsGrid connectionWeightsGrid;
 
-  void add_neuron_row_label(int neuron_index);
-  void add_connection_weight_slider(int neuron_index);
-  void remove_connection_weight_slider();
+  // the versions last shown, for the whole matrix and for each row
+  uint32 seen_version{0};
+  std::vector<uint32> seen_row_versions;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConnectionWeightsMatrix)
 };
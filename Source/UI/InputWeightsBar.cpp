@@ -58,6 +58,13 @@ void InputWeightsBar::add_input_weight_slider(int neuron_index) {
 // Public Methods
 
 void InputWeightsBar::updateComponents() {
+  uint32 version =
+      processor.midiGenerator->get_version(MidiGenerator::input_weights);
+  if (version == seen_version) {
+    return;
+  }
+  seen_version = version;
+
   for (auto slider = inputWeightSliders.begin();
        slider != inputWeightSliders.end(); ++slider) {
     (*slider)->updateComponent();
@@ -83,11 +90,16 @@ InputWeightSlider::InputWeightSlider(WellsAudioProcessor &p, int i)
   setRange(-256, 256, 1);
   setColour(Slider::ColourIds::textBoxBackgroundColourId, AppStyle.darkGrey);
   onValueChange = [this]() {
-    processor.midiGenerator->set_neuron_input_weight(neuron_index, getValue());
+    int neuron = neuron_index;
+    int weight = getValue();
+    processor.edit([neuron, weight](MidiGenerator &generator) {
+      generator.set_neuron_input_weight(neuron, weight);
+    });
   };
 }
 InputWeightSlider::~InputWeightSlider() {}
 
 void InputWeightSlider::updateComponent() {
-  setValue(processor.midiGenerator->get_neuron_input_weight(neuron_index));
+  setValue(processor.midiGenerator->get_neuron_input_weight(neuron_index),
+           dontSendNotification);
 }
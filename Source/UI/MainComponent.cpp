@@ -12,6 +12,9 @@ MainComponent::MainComponent(WellsAudioProcessor &p)
     : processor(p), titleBar(p), pluginBody(p) {
   addAndMakeVisible(&titleBar);
   addAndMakeVisible(&pluginBody);
+  // every click anywhere in the editor checkpoints the network for undo
+  addMouseListener(this, true);
+  setWantsKeyboardFocus(true);
   startTimer(100);
   PluginLogger::PluginLogger::logger.logMessage(
       "thumbColourId " + String(Slider::ColourIds::thumbColourId));
@@ -31,6 +34,25 @@ void MainComponent::resized() {
   pluginBody.setBounds(area);
 }
 
+// Before a click can edit anything, the network is checkpointed. If nothing
+// changes the checkpoint is dropped again.
+void MainComponent::mouseDown(const MouseEvent &) { processor.checkpoint(); }
+
+bool MainComponent::keyPressed(const KeyPress &key) {
+  if (key == KeyPress('z', ModifierKeys::commandModifier, 0)) {
+    processor.undo();
+    return true;
+  }
+  if (key == KeyPress('z',
+                      ModifierKeys::commandModifier |
+                          ModifierKeys::shiftModifier,
+                      0)) {
+    processor.redo();
+    return true;
+  }
+  return false;
+}
+
 void MainComponent::timerCallback() {
   titleBar.updateComponents();
   pluginBody.updateComponents();
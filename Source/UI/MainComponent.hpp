@@ -19,6 +19,8 @@ public:
 
   void paint(Graphics &) override;
   void resized() override;
+  void mouseDown(const MouseEvent &) override;
+  bool keyPressed(const KeyPress &key) override;
 
 private:
   WellsAudioProcessor &processor;
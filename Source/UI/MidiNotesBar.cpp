@@ -55,6 +55,13 @@ void MidiNotesBar::add_midi_note_selector(int neuron_index) {
 // Public Methods
 
 void MidiNotesBar::updateComponents() {
+  uint32 version =
+      processor.midiGenerator->get_version(MidiGenerator::midi_notes);
+  if (version == seen_version) {
+    return;
+  }
+  seen_version = version;
+
   for (auto combo = midiNoteSelectors.begin(); combo != midiNoteSelectors.end();
        ++combo) {
     (*combo)->updateComponent();
@@ -84,8 +91,11 @@ MidiNoteComboBox::MidiNoteComboBox(WellsAudioProcessor &p, int idx)
   addItemList(midiNoteNums, 1);
   setEditableText(false);
   onChange = [this]() {
-    processor.midiGenerator->set_neuron_midi_note(neuron_index,
-                                                  getText().getIntValue());
+    int neuron = neuron_index;
+    int note = getText().getIntValue();
+    processor.edit([neuron, note](MidiGenerator &generator) {
+      generator.set_neuron_midi_note(neuron, note);
+    });
   };
 }
 MidiNoteComboBox::~MidiNoteComboBox() {}
@@ -93,6 +103,6 @@ MidiNoteComboBox::~MidiNoteComboBox() {}
 void MidiNoteComboBox::updateComponent() {
   int id{get_midi_note_id(
       processor.midiGenerator->get_neuron_midi_note(neuron_index))};
-  setSelectedId(id);
+  setSelectedId(id, dontSendNotification);
 }
 int MidiNoteComboBox::get_midi_note_id(int note_num) { return note_num; }
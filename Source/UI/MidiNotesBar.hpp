@@ -49,6 +49,7 @@ public:
 
 private:
   WellsAudioProcessor &processor;
+  uint32 seen_version{0};
 
   std::vector<std::unique_ptr<MidiNoteComboBox>> midiNoteSelectors;
 
@@ -13,11 +13,18 @@
  */
 
 NeuronTitleBar::NeuronTitleBar(WellsAudioProcessor &p)
-    : processor(p), addNeuron(p) {
+    : processor(p), addNeuron(p), storeMorphA("A"), storeMorphB("B") {
   for (int i = 0; i < p.midiGenerator->num_neurons(); ++i) {
     add_neuron_label(i);
   }
   addAndMakeVisible(addNeuron);
+
+  storeMorphA.setTooltip("Store the network as morph A");
+  storeMorphB.setTooltip("Store the network as morph B");
+  storeMorphA.onClick = [this]() { processor.store_morph_a(); };
+  storeMorphB.onClick = [this]() { processor.store_morph_b(); };
+  addAndMakeVisible(storeMorphA);
+  addAndMakeVisible(storeMorphB);
 }
 NeuronTitleBar::~NeuronTitleBar() {}
 
@@ -26,7 +33,10 @@ void NeuronTitleBar::paint(Graphics &g) {}
 void NeuronTitleBar::resized() {
   auto area = getLocalBounds();
   AppStyle.blockPadding.subtractFrom(area);
-  area.removeFromLeft(AppStyle.rowLabelWidth);
+  auto morphArea = area.removeFromLeft(AppStyle.rowLabelWidth);
+  AppStyle.rowLabelPadding.subtractFrom(morphArea);
+  storeMorphA.setBounds(morphArea.removeFromLeft(morphArea.getWidth() / 2));
+  storeMorphB.setBounds(morphArea);
 
   for (auto it = neuronColumnLabels.begin(); it != neuronColumnLabels.end();
        it++) {
@@ -55,7 +55,8 @@ private:
  *
  * This is the space at the top of the Plugin Body that shows the column labels
  * for each of the neurons. Crucially though it also contains the Add Neuron
- * Button, which is used to add neurons to the network.
+ * Button, which is used to add neurons to the network. The A and B buttons
+ * store the network as it is as either end of the morph.
  */
 
 class NeuronTitleBar : public Component {
@@ -75,6 +76,7 @@ private:
   WellsAudioProcessor &processor;
 
   AddNeuronButton addNeuron;
+  TextButton storeMorphA, storeMorphB;
   std::vector<std::unique_ptr<NeuronLabel>> neuronColumnLabels;
 
   void add_neuron_label(int neuron_index);
@@ -10,13 +10,17 @@
 
 PluginBody::PluginBody(WellsAudioProcessor &p)
     : processor(p), editor_num_neurons{p.midiGenerator->num_neurons()},
-      neuronTitleBar(p), midiNotesBar(p), inputWeightsBar(p), thresholdsBar(p),
-      connectionWeightsMatrix(p) {
+      neuronTitleBar(p), activityBar(p), midiNotesBar(p), inputWeightsBar(p),
+      thresholdsBar(p), connectionWeightsMatrix(p),
+      spikeRaster(p, firingHistory) {
   addAndMakeVisible(neuronTitleBar);
+  addAndMakeVisible(activityBar);
   addAndMakeVisible(midiNotesBar);
   addAndMakeVisible(inputWeightsBar);
   addAndMakeVisible(thresholdsBar);
   addAndMakeVisible(connectionWeightsMatrix);
+  addAndMakeVisible(spikeRaster);
+  startTimerHz(activity_frame_rate);
 }
 PluginBody::~PluginBody() {}
 
@@ -26,10 +30,12 @@ void PluginBody::resized() {
   auto area = getLocalBounds();
 
   neuronTitleBar.setBounds(area.removeFromTop(AppStyle.neuronTitleBarHeight));
+  activityBar.setBounds(area.removeFromTop(AppStyle.controlsBarHeight));
 
   midiNotesBar.setBounds(area.removeFromTop(AppStyle.controlsBarHeight));
   inputWeightsBar.setBounds(area.removeFromTop(AppStyle.controlsBarHeight));
   thresholdsBar.setBounds(area.removeFromTop(AppStyle.controlsBarHeight));
+  spikeRaster.setBounds(area.removeFromBottom(AppStyle.spikeRasterHeight));
 
   connectionWeightsMatrix.setBounds(area);
 }
@@ -48,6 +54,13 @@ void PluginBody::updateComponents() {
   connectionWeightsMatrix.updateComponents();
 }
 
+// The activity feed is only read here, so that it has a single reader.
+void PluginBody::timerCallback() {
+  bool has_activity = processor.activityFeed.read(activity, &firingHistory);
+  activityBar.update_activity(activity, has_activity);
+  spikeRaster.update();
+}
+
 void PluginBody::update_neuron_ui(int neuron_num_change) {
   if (neuron_num_change > 0) {
     for (int i{0}; i < neuron_num_change; ++i) {
@@ -62,6 +75,7 @@ void PluginBody::update_neuron_ui(int neuron_num_change) {
 
 void PluginBody::add_neuron_ui_update() {
   neuronTitleBar.add_neuron_ui_update();
+  activityBar.add_neuron_ui_update();
   midiNotesBar.add_neuron_ui_update();
   inputWeightsBar.add_neuron_ui_update();
   thresholdsBar.add_neuron_ui_update();
@@ -69,6 +83,7 @@ void PluginBody::add_neuron_ui_update() {
 }
 void PluginBody::remove_neuron_ui_update() {
   neuronTitleBar.remove_neuron_ui_update();
+  activityBar.remove_neuron_ui_update();
   midiNotesBar.remove_neuron_ui_update();
   inputWeightsBar.remove_neuron_ui_update();
   thresholdsBar.remove_neuron_ui_update();
@@ -9,17 +9,22 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "../PluginProcessor.h"
+#include "ActivityBar.hpp"
 #include "ConnectionWeightsMatrix.hpp"
 #include "InputWeightsBar.hpp"
 #include "MidiNotesBar.hpp"
 #include "NeuronTitleBar.hpp"
+#include "SpikeRaster.hpp"
 #include "ThresholdsBar.hpp"
 
-class PluginBody : public Component {
+class PluginBody : public Component, private Timer {
 public:
   PluginBody(WellsAudioProcessor &p);
   ~PluginBody();
 
+  // how often the neuron activity is read and shown
+  static constexpr int activity_frame_rate{30};
+
   void paint(Graphics &) override;
   void resized() override;
 
@@ -29,13 +34,18 @@ private:
   WellsAudioProcessor &processor;
 
   int editor_num_neurons;
+  ActivityFrame activity;
+  FiringHistory firingHistory;
 
   NeuronTitleBar neuronTitleBar;
+  ActivityBar activityBar;
   MidiNotesBar midiNotesBar;
   InputWeightsBar inputWeightsBar;
   ThresholdsBar thresholdsBar;
   ConnectionWeightsMatrix connectionWeightsMatrix;
+  SpikeRaster spikeRaster;
 
+  void timerCallback() override;
   void update_neuron_ui(int neuron_num_change);
   void add_neuron_ui_update();
   void remove_neuron_ui_update();
@@ -0,0 +1,143 @@
+/*
+ * SpikeRaster.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "SpikeRaster.hpp"
+#include "Styles.hpp"
+#include <algorithm>
+
+SpikeRaster::SpikeRaster(WellsAudioProcessor &p, const FiringHistory &h)
+    : processor(p), history(h), mode{neurons}, drawn_ticks{0},
+      lowest_row{0}, num_rows{0} {}
+SpikeRaster::~SpikeRaster() {}
+
+void SpikeRaster::paint(Graphics &g) {
+  auto area = getLocalBounds();
+  AppStyle.blockPadding.subtractFrom(area);
+
+  g.setColour(AppStyle.darkGrey);
+  g.fillRoundedRectangle(area.toFloat(), 5.0);
+  g.setColour(AppStyle.mediumGrey);
+  g.drawRoundedRectangle(area.toFloat(), 5.0, 1.0);
+
+  auto rowLabelArea = area.removeFromLeft(AppStyle.rowLabelWidth);
+  AppStyle.rowLabelPadding.subtractFrom(rowLabelArea);
+  g.setFont(AppStyle.fontSizeMedium);
+  g.setColour(AppStyle.lightGrey);
+  g.drawText(mode == neurons ? "Spikes" : "Notes", rowLabelArea,
+             Justification::centredLeft, true);
+
+  auto imageArea = get_image_area();
+  g.drawImageAt(image, imageArea.getX(), imageArea.getY());
+}
+
+void SpikeRaster::resized() {
+  auto imageArea = get_image_area();
+  if (imageArea.isEmpty()) {
+    image = Image();
+    return;
+  }
+  image = Image(Image::RGB, imageArea.getWidth(), imageArea.getHeight(), true);
+  redraw();
+}
+
+void SpikeRaster::mouseDown(const MouseEvent &) {
+  mode = mode == neurons ? notes : neurons;
+  redraw();
+  repaint();
+}
+
+// Draws the ticks pushed since the last update.
+void SpikeRaster::update() {
+  int64 num_new_ticks = history.get_num_ticks() - drawn_ticks;
+  if (num_new_ticks == 0 || !image.isValid()) {
+    return;
+  }
+
+  int width = image.getWidth();
+  if (update_rows(*processor.midiGenerator->get_snapshot()) ||
+      num_new_ticks >= width / tick_width ||
+      num_new_ticks > history.get_num_stored_ticks()) {
+    redraw();
+  } else {
+    int shift = static_cast<int>(num_new_ticks) * tick_width;
+    image.moveImageSection(0, 0, shift, 0, width - shift, image.getHeight());
+    Graphics g(image);
+    draw_ticks(g, static_cast<int>(num_new_ticks));
+    drawn_ticks = history.get_num_ticks();
+  }
+  repaint(get_image_area());
+}
+
+// Private Methods
+
+Rectangle<int> SpikeRaster::get_image_area() {
+  auto area = getLocalBounds();
+  AppStyle.blockPadding.subtractFrom(area);
+  area.removeFromLeft(AppStyle.rowLabelWidth);
+  AppStyle.componentPadding.subtractFrom(area);
+  return area;
+}
+
+// Works out the rows from the neurons or notes in use, and returns whether
+// they have changed since the image was drawn.
+bool SpikeRaster::update_rows(const EngineSnapshot &snapshot) {
+  int new_lowest_row{0};
+  int new_num_rows{snapshot.num_neurons()};
+  if (mode == notes && new_num_rows > 0) {
+    auto range = std::minmax_element(snapshot.midi_notes.begin(),
+                                     snapshot.midi_notes.end());
+    new_lowest_row = *range.first;
+    new_num_rows = *range.second - *range.first + 1;
+  }
+  bool changed = new_lowest_row != lowest_row || new_num_rows != num_rows;
+  lowest_row = new_lowest_row;
+  num_rows = new_num_rows;
+  return changed;
+}
+
+void SpikeRaster::redraw() {
+  drawn_ticks = history.get_num_ticks();
+  update_rows(*processor.midiGenerator->get_snapshot());
+  if (!image.isValid()) {
+    return;
+  }
+  Graphics g(image);
+  g.fillAll(AppStyle.veryDarkGrey);
+  draw_ticks(g, jmin(history.get_num_stored_ticks(),
+                     image.getWidth() / tick_width));
+}
+
+// Draws the latest `num_ticks` ticks at the right hand edge of the image.
+void SpikeRaster::draw_ticks(Graphics &g, int num_ticks) {
+  int width = image.getWidth();
+  int height = image.getHeight();
+  g.setColour(AppStyle.veryDarkGrey);
+  g.fillRect(width - (num_ticks * tick_width), 0, num_ticks * tick_width,
+             height);
+
+  auto snapshot = processor.midiGenerator->get_snapshot();
+  int num_neurons = snapshot->num_neurons();
+  if (num_rows == 0) {
+    return;
+  }
+  float row_height = height / static_cast<float>(num_rows);
+
+  g.setColour(AppStyle.buttonOnColour);
+  for (int ticks_ago = 0; ticks_ago < num_ticks; ++ticks_ago) {
+    int x = width - ((ticks_ago + 1) * tick_width);
+    int tick_neurons = jmin(num_neurons, history.get_num_neurons(ticks_ago));
+    // only the neurons that fired are visited
+    for (int i = history.next_fired(ticks_ago, 0); i >= 0 && i < tick_neurons;
+         i = history.next_fired(ticks_ago, i + 1)) {
+      int row = mode == neurons ? i : snapshot->midi_notes[i] - lowest_row;
+      // the first neuron and the lowest note are at the bottom
+      float y = height - ((row + 1) * row_height);
+      g.fillRect(static_cast<float>(x), y, static_cast<float>(tick_width),
+                 jmax(1.0f, row_height));
+    }
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * SpikeRaster.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../MidiGenerator/ActivityFeed/FiringHistory.hpp"
+#include "../PluginProcessor.h"
+
+/*
+ * Spike Raster
+ *
+ * A scrolling plot of the recent ticks, newest on the right. It either has a
+ * row for each neuron, marking the ticks it fired on, or a row for each MIDI
+ * note in use, like a piano roll of the notes that were played. Click it to
+ * switch between the two.
+ *
+ * The plot is kept in an image. New ticks shift the image along and only the
+ * new columns are drawn, so an update costs the same however much history is
+ * on screen. The whole image is only redrawn when it is resized or the view
+ * changes.
+ */
+
+class SpikeRaster : public Component {
+public:
+  SpikeRaster(WellsAudioProcessor &p, const FiringHistory &h);
+  ~SpikeRaster();
+
+  enum Mode { neurons, notes };
+
+  static constexpr int tick_width{2};
+
+  void paint(Graphics &) override;
+  void resized() override;
+  void mouseDown(const MouseEvent &) override;
+
+  void update();
+
+private:
+  WellsAudioProcessor &processor;
+  const FiringHistory &history;
+
+  Mode mode;
+  Image image;
+  int64 drawn_ticks;
+  // the rows the image was drawn with, so it can be redrawn when they change
+  int lowest_row, num_rows;
+
+  Rectangle<int> get_image_area();
+  bool update_rows(const EngineSnapshot &snapshot);
+  void redraw();
+  void draw_ticks(Graphics &g, int num_ticks);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpikeRaster)
+};
@@ -17,6 +17,7 @@ struct PluginStyle {
   const Colour veryDarkGrey{45, 45, 45};
   const Colour buttonOnColour{133, 150, 241};
   const Colour buttonOffColour{39, 44, 71};
+  const Colour negativeWeightColour{241, 133, 150};
 
   // Text
   float fontSizeMedium{16.0f};
@@ -32,6 +33,8 @@ struct PluginStyle {
   const int connectionMatrixTitleHeight{40};
   const int connectionMatrixRowHeight{40};
 
+  const int spikeRasterHeight{160};
+
   const BorderSize<int> componentPadding{3, 3, 3, 3};
   const BorderSize<int> blockPadding{5, 10, 5, 10};
   const BorderSize<int> rowLabelPadding{0, 10, 0, 0};
@@ -61,6 +61,13 @@ void ThresholdsBar::add_threshold_slider(int neuron_index) {
 // Public Methods
 
 void ThresholdsBar::updateComponents() {
+  uint32 version =
+      processor.midiGenerator->get_version(MidiGenerator::thresholds);
+  if (version == seen_version) {
+    return;
+  }
+  seen_version = version;
+
   for (auto slider = thresholdSliders.begin(); slider != thresholdSliders.end();
        ++slider) {
     (*slider)->updateComponent();
@@ -86,11 +93,16 @@ ThresholdSlider::ThresholdSlider(WellsAudioProcessor &p, int i)
   setRange(-256, 256, 1);
   setColour(Slider::ColourIds::textBoxBackgroundColourId, AppStyle.darkGrey);
   onValueChange = [this]() {
-    processor.midiGenerator->set_neuron_threshold(neuron_index, getValue());
+    int neuron = neuron_index;
+    int threshold = getValue();
+    processor.edit([neuron, threshold](MidiGenerator &generator) {
+      generator.set_neuron_threshold(neuron, threshold);
+    });
   };
 }
 ThresholdSlider::~ThresholdSlider() {}
 
 void ThresholdSlider::updateComponent() {
-  setValue(processor.midiGenerator->get_neuron_threshold(neuron_index));
+  setValue(processor.midiGenerator->get_neuron_threshold(neuron_index),
+           dontSendNotification);
 }
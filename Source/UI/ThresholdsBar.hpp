@@ -47,6 +47,7 @@ public:
 
 private:
   WellsAudioProcessor &processor;
+  uint32 seen_version{0};
 
   std::vector<std::unique_ptr<ThresholdSlider>> thresholdSliders;
 
@@ -9,14 +9,19 @@
 #include "Styles.hpp"
 
 TitleBar::TitleBar(WellsAudioProcessor &p)
-    : onOffButton(p), receivesMidiButton(p), subdivisionSlider(p),
-      globalVolumeSlider(p), volumeRange(p) {
+    : processor(p), onOffButton(p), receivesMidiButton(p), midiThroughButton(p),
+      followSongButton(p), subdivisionSlider(p), globalVolumeSlider(p),
+      volumeRange(p), dynamicsSlider(p), gateLengthSlider(p) {
 
   addAndMakeVisible(onOffButton);
   addAndMakeVisible(receivesMidiButton);
+  addAndMakeVisible(midiThroughButton);
+  addAndMakeVisible(followSongButton);
   addAndMakeVisible(subdivisionSlider);
   addAndMakeVisible(globalVolumeSlider);
   addAndMakeVisible(volumeRange);
+  addAndMakeVisible(dynamicsSlider);
+  addAndMakeVisible(gateLengthSlider);
 }
 TitleBar::~TitleBar() {}
 
@@ -43,6 +48,14 @@ void TitleBar::resized() {
   componentPadding.subtractFrom(buttonArea);
   receivesMidiButton.setBounds(buttonArea);
 
+  buttonArea = area.removeFromLeft(componentWidth);
+  componentPadding.subtractFrom(buttonArea);
+  midiThroughButton.setBounds(buttonArea);
+
+  buttonArea = area.removeFromLeft(componentWidth);
+  componentPadding.subtractFrom(buttonArea);
+  followSongButton.setBounds(buttonArea);
+
   buttonArea = area.removeFromLeft(componentWidth);
   componentPadding.subtractFrom(buttonArea);
   subdivisionSlider.setBounds(buttonArea);
@@ -54,15 +67,33 @@ void TitleBar::resized() {
   buttonArea = area.removeFromLeft(2 * componentWidth);
   componentPadding.subtractFrom(buttonArea);
   volumeRange.setBounds(buttonArea);
+
+  buttonArea = area.removeFromLeft(componentWidth);
+  componentPadding.subtractFrom(buttonArea);
+  dynamicsSlider.setBounds(buttonArea);
+
+  buttonArea = area.removeFromLeft(componentWidth);
+  componentPadding.subtractFrom(buttonArea);
+  gateLengthSlider.setBounds(buttonArea);
 }
 
 void TitleBar::updateComponents() {
-  // TODO only update GUI when needed
+  uint32 version =
+      processor.midiGenerator->get_version(MidiGenerator::settings);
+  if (version == seen_version) {
+    return;
+  }
+  seen_version = version;
+
   onOffButton.updateComponent();
   receivesMidiButton.updateComponent();
+  midiThroughButton.updateComponent();
+  followSongButton.updateComponent();
   subdivisionSlider.updateComponent();
   globalVolumeSlider.updateComponent();
   volumeRange.updateComponent();
+  dynamicsSlider.updateComponent();
+  gateLengthSlider.updateComponent();
 }
 
 /*
@@ -71,7 +102,9 @@ void TitleBar::updateComponents() {
 
 OnOffButton::OnOffButton(WellsAudioProcessor &p)
     : TextButton("On/Off"), processor(p) {
-  onClick = [this]() { processor.midiGenerator->toggleOnOff(); };
+  onClick = [this]() {
+    processor.edit([](MidiGenerator &generator) { generator.toggleOnOff(); });
+  };
 }
 OnOffButton::~OnOffButton() {}
 
@@ -87,7 +120,10 @@ void OnOffButton::updateComponent() {
 
 ReceivesMidiButton::ReceivesMidiButton(WellsAudioProcessor &p)
     : TextButton("MIDI In"), processor(p) {
-  onClick = [this]() { processor.midiGenerator->toggleReceivesMidi(); };
+  onClick = [this]() {
+    processor.edit(
+        [](MidiGenerator &generator) { generator.toggleReceivesMidi(); });
+  };
 }
 ReceivesMidiButton::~ReceivesMidiButton() {}
 
@@ -98,6 +134,47 @@ void ReceivesMidiButton::updateComponent() {
                 : AppStyle.buttonOffColour);
 }
 
+/*
+ * MIDI Through Button
+ */
+
+MidiThroughButton::MidiThroughButton(WellsAudioProcessor &p)
+    : TextButton("MIDI Thru"), processor(p) {
+  onClick = [this]() {
+    processor.edit(
+        [](MidiGenerator &generator) { generator.toggleMidiThrough(); });
+  };
+}
+MidiThroughButton::~MidiThroughButton() {}
+
+void MidiThroughButton::updateComponent() {
+  setColour(TextButton::ColourIds::buttonColourId,
+            processor.midiGenerator->get_midi_through()
+                ? AppStyle.buttonOnColour
+                : AppStyle.buttonOffColour);
+}
+
+/*
+ * Follow Song Button
+ */
+
+FollowSongButton::FollowSongButton(WellsAudioProcessor &p)
+    : TextButton("Follow"), processor(p) {
+  onClick = [this]() {
+    processor.edit([](MidiGenerator &generator) {
+      generator.toggleFollowsSongPosition();
+    });
+  };
+}
+FollowSongButton::~FollowSongButton() {}
+
+void FollowSongButton::updateComponent() {
+  setColour(TextButton::ColourIds::buttonColourId,
+            processor.midiGenerator->get_follows_song_position()
+                ? AppStyle.buttonOnColour
+                : AppStyle.buttonOffColour);
+}
+
 /*
  * Subdivision Slider
  */
@@ -109,13 +186,16 @@ SubdivisionSlider::SubdivisionSlider(WellsAudioProcessor &p)
   setTextBoxStyle(Slider::NoTextBox, false, 10, 0);
   setPopupDisplayEnabled(true, false, getParentComponent());
   onValueChange = [this]() {
-    processor.midiGenerator->set_subdivision(getValue());
+    int subdivision = getValue();
+    processor.edit([subdivision](MidiGenerator &generator) {
+      generator.set_subdivision(subdivision);
+    });
   };
 }
 SubdivisionSlider::~SubdivisionSlider() {}
 
 void SubdivisionSlider::updateComponent() {
-  setValue(processor.midiGenerator->get_subdivision());
+  setValue(processor.midiGenerator->get_subdivision(), dontSendNotification);
 }
 
 /*
@@ -129,12 +209,16 @@ GlobalVolumeSlider::GlobalVolumeSlider(WellsAudioProcessor &p)
   setNumDecimalPlacesToDisplay(2);
   setTextBoxStyle(Slider::NoTextBox, false, 10, 0);
   setPopupDisplayEnabled(true, false, getParentComponent());
-  onValueChange = [this]() { processor.midiGenerator->set_volume(getValue()); };
+  onValueChange = [this]() {
+    float volume = getValue();
+    processor.edit(
+        [volume](MidiGenerator &generator) { generator.set_volume(volume); });
+  };
 }
 GlobalVolumeSlider::~GlobalVolumeSlider() {}
 
 void GlobalVolumeSlider::updateComponent() {
-  setValue(processor.midiGenerator->get_volume());
+  setValue(processor.midiGenerator->get_volume(), dontSendNotification);
 }
 
 /*
@@ -148,12 +232,68 @@ VolumeRangeSlider::VolumeRangeSlider(WellsAudioProcessor &p)
   setTextBoxStyle(Slider::NoTextBox, false, 10, 0);
   setPopupDisplayEnabled(true, false, getParentComponent());
   onValueChange = [this]() {
-    processor.midiGenerator->set_volume_clip(getMinValue(), getMaxValue());
+    int min = getMinValue();
+    int max = getMaxValue();
+    processor.edit([min, max](MidiGenerator &generator) {
+      generator.set_volume_clip(min, max);
+    });
   };
 }
 VolumeRangeSlider::~VolumeRangeSlider() {}
 
 void VolumeRangeSlider::updateComponent() {
-  setMinValue(processor.midiGenerator->get_volume_clip_min());
-  setMaxValue(processor.midiGenerator->get_volume_clip_max());
+  setMinValue(processor.midiGenerator->get_volume_clip_min(),
+              dontSendNotification);
+  setMaxValue(processor.midiGenerator->get_volume_clip_max(),
+              dontSendNotification);
+}
+
+/*
+ * Dynamics Slider
+ */
+
+DynamicsSlider::DynamicsSlider(WellsAudioProcessor &p)
+    : Slider("Dynamics"), processor(p) {
+  setSliderStyle(Slider::RotaryVerticalDrag);
+  setRange(1, 127, 1);
+  setTextBoxStyle(Slider::NoTextBox, false, 10, 0);
+  setPopupDisplayEnabled(true, false, getParentComponent());
+  onValueChange = [this]() {
+    int max_output = getValue();
+    processor.edit([max_output](MidiGenerator &generator) {
+      generator.set_max_neuron_output(max_output);
+    });
+  };
+}
+DynamicsSlider::~DynamicsSlider() {}
+
+void DynamicsSlider::updateComponent() {
+  setValue(processor.midiGenerator->get_max_neuron_output(),
+           dontSendNotification);
+}
+
+/*
+ * Gate Length Slider
+ */
+
+GateLengthSlider::GateLengthSlider(WellsAudioProcessor &p)
+    : Slider("Gate Length"), processor(p) {
+  setSliderStyle(Slider::RotaryVerticalDrag);
+  setRange(0.05, 1.0, 0.01);
+  setNumDecimalPlacesToDisplay(2);
+  setTextBoxStyle(Slider::NoTextBox, false, 10, 0);
+  setPopupDisplayEnabled(true, false, getParentComponent());
+  onValueChange = [this]() {
+    GateLength gate{GateLength::subdivision_fraction, (float)getValue()};
+    processor.edit(
+        [gate](MidiGenerator &generator) { generator.set_gate_length(gate); });
+  };
+}
+GateLengthSlider::~GateLengthSlider() {}
+
+void GateLengthSlider::updateComponent() {
+  GateLength gate = processor.midiGenerator->get_gate_length();
+  if (gate.unit == GateLength::subdivision_fraction) {
+    setValue(gate.value, dontSendNotification);
+  }
 }
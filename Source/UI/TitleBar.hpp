@@ -35,6 +35,31 @@ private:
   WellsAudioProcessor &processor;
 };
 
+// MIDI Through Button - for toggling whether MIDI in is passed to MIDI out.
+
+class MidiThroughButton : public TextButton {
+public:
+  MidiThroughButton(WellsAudioProcessor &p);
+  ~MidiThroughButton();
+  void updateComponent();
+
+private:
+  WellsAudioProcessor &processor;
+};
+
+// Follow Song Button - for toggling whether playback starting part way through
+// the song plays what playing from the start would have played there.
+
+class FollowSongButton : public TextButton {
+public:
+  FollowSongButton(WellsAudioProcessor &p);
+  ~FollowSongButton();
+  void updateComponent();
+
+private:
+  WellsAudioProcessor &processor;
+};
+
 /*
  * Subdivision Slider - changes the subdivision in the BeatClock
  */
@@ -77,15 +102,48 @@ private:
   WellsAudioProcessor &processor;
 };
 
+/*
+ * Dynamics Slider - sets the neuron output that plays at full velocity, so
+ * neurons further over their threshold play louder
+ */
+
+class DynamicsSlider : public Slider {
+public:
+  DynamicsSlider(WellsAudioProcessor &p);
+  ~DynamicsSlider();
+  void updateComponent();
+
+private:
+  WellsAudioProcessor &processor;
+};
+
+/*
+ * Gate Length Slider - changes how long midi notes are held for
+ */
+
+class GateLengthSlider : public Slider {
+public:
+  GateLengthSlider(WellsAudioProcessor &p);
+  ~GateLengthSlider();
+  void updateComponent();
+
+private:
+  WellsAudioProcessor &processor;
+};
+
 /*
  * Title Bar
  *
  * The main title bar at the top of the app. Holds the global controls:
  *   - On/Off Button
  *   - Receives MIDI Button
+ *   - MIDI Through Button
+ *   - Follow Song Button
  *   - Subdivision Slider
  *   - Global Volume Slider
  *   - Volume Range Slider
+ *   - Dynamics Slider
+ *   - Gate Length Slider
  */
 
 class TitleBar : public Component {
@@ -99,15 +157,22 @@ public:
   void updateComponents();
 
 private:
+  WellsAudioProcessor &processor;
+  uint32 seen_version{0};
+
   int bottomBorderPx{1};
   BorderSize<int> componentPadding{10, 5, 10, 5};
   int componentWidth{100};
 
   OnOffButton onOffButton;
   ReceivesMidiButton receivesMidiButton;
+  MidiThroughButton midiThroughButton;
+  FollowSongButton followSongButton;
   SubdivisionSlider subdivisionSlider;
   GlobalVolumeSlider globalVolumeSlider;
   VolumeRangeSlider volumeRange;
+  DynamicsSlider dynamicsSlider;
+  GateLengthSlider gateLengthSlider;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TitleBar)
 };
@@ -0,0 +1,61 @@
+/*
+ * AllocationCounter.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "AllocationCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+static thread_local AllocationCounter *active_counter{nullptr};
+
+AllocationCounter::AllocationCounter()
+    : previous{active_counter}, num_allocations{0}, num_bytes{0} {
+  active_counter = this;
+}
+AllocationCounter::~AllocationCounter() { active_counter = previous; }
+
+int AllocationCounter::get_num_allocations() { return num_allocations; }
+size_t AllocationCounter::get_num_bytes() { return num_bytes; }
+
+void AllocationCounter::record_allocation(size_t size) {
+  for (AllocationCounter *c = active_counter; c != nullptr; c = c->previous) {
+    ++c->num_allocations;
+    c->num_bytes += size;
+  }
+}
+
+/*
+ * Global operator new / delete replacements - debug builds only
+ */
+
+#ifndef NDEBUG
+
+static void *counted_malloc(std::size_t size) {
+  AllocationCounter::record_allocation(size);
+  void *p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void *operator new(std::size_t size) { return counted_malloc(size); }
+void *operator new[](std::size_t size) { return counted_malloc(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  AllocationCounter::record_allocation(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  AllocationCounter::record_allocation(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * AllocationCounter.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Allocation Counter
+ *
+ * Counts the heap allocations (operator new) made on the current thread while
+ * the counter is alive. It is used by the tests to check that the audio thread
+ * code paths don't allocate. Counting works by replacing the global operator
+ * new in debug builds (see AllocationCounter.cpp), outside of a counter's
+ * lifetime the replacement just forwards to malloc.
+ *
+ * It also totals the bytes asked for, which the benchmarks use to measure how
+ * much memory building a network takes.
+ *
+ * This file doesn't depend on JUCE so it can be used by the catch tests too.
+ */
+
+class AllocationCounter {
+public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  int get_num_allocations();
+  size_t get_num_bytes();
+
+  static void record_allocation(size_t num_bytes = 0);
+
+private:
+  AllocationCounter *previous;
+  int num_allocations;
+  size_t num_bytes;
+};
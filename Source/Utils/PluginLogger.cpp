@@ -7,7 +7,8 @@
 
 #include "PluginLogger.hpp"
 
-void PluginLogger::log_vec(String vec_name, std::vector<int> vec) {
+void PluginLogger::log_vec(const String &vec_name,
+                           const std::vector<int> &vec) {
   if (!isLogging) {
     return;
   }
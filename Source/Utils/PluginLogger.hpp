@@ -18,7 +18,8 @@ public:
 
   static PluginLogger logger;
 
-  void log_vec(String vec_name, std::vector<int> vec);
+  bool is_logging() { return isLogging; };
+  void log_vec(const String &vec_name, const std::vector<int> &vec);
 
 private:
   bool isLogging{false};
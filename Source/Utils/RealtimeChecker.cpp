@@ -0,0 +1,247 @@
+/*
+ * RealtimeChecker.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "RealtimeChecker.hpp"
+#include <cstdlib>
+
+#if WELLS_REALTIME_CHECKS
+#include <cstdarg>
+#include <cstdio>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/types.h>
+#endif
+
+static thread_local RealtimeChecker *active_checker{nullptr};
+// set while a violation is being recorded, as recording can call the
+// functions being checked
+static thread_local bool is_recording{false};
+
+static const char *violation_names[RealtimeChecker::num_violation_kinds]{
+    "allocation", "deallocation", "lock", "file access"};
+
+RealtimeChecker::RealtimeChecker()
+    : previous{active_checker}, is_running{true}, num_violations{},
+      num_stacks{0} {
+#if WELLS_REALTIME_CHECKS
+  // the first backtrace loads the unwinder, which allocates
+  static bool has_loaded_unwinder{false};
+  if (!has_loaded_unwinder) {
+    void *frame;
+    backtrace(&frame, 1);
+    has_loaded_unwinder = true;
+  }
+#endif
+  active_checker = this;
+}
+RealtimeChecker::~RealtimeChecker() { stop(); }
+
+bool RealtimeChecker::is_available() { return WELLS_REALTIME_CHECKS; }
+
+void RealtimeChecker::stop() {
+  if (is_running && active_checker == this) {
+    active_checker = previous;
+  }
+  is_running = false;
+}
+
+int RealtimeChecker::get_num_violations() {
+  int total{0};
+  for (int n : num_violations) {
+    total += n;
+  }
+  return total;
+}
+
+int RealtimeChecker::get_num_violations(Violation kind) {
+  return num_violations[kind];
+}
+
+std::string RealtimeChecker::get_report() {
+  stop();
+  std::string report;
+  for (int kind = 0; kind < num_violation_kinds; ++kind) {
+    if (num_violations[kind] > 0) {
+      report += std::to_string(num_violations[kind]) + " " +
+                violation_names[kind] + "\n";
+    }
+  }
+#if WELLS_REALTIME_CHECKS
+  for (int i = 0; i < num_stacks; ++i) {
+    const Stack &stack = stacks[i];
+    report += std::string("\n") + violation_names[stack.kind] + " at:\n";
+    char **symbols = backtrace_symbols(stack.frames, stack.num_frames);
+    for (int frame = 0; frame < stack.num_frames; ++frame) {
+      // binary(mangled+offset) [address], with the name made readable
+      std::string symbol = symbols != nullptr ? symbols[frame] : "?";
+      size_t start = symbol.find('('), end = symbol.find('+', start);
+      if (start != std::string::npos && end != std::string::npos &&
+          end > start + 1) {
+        std::string name = symbol.substr(start + 1, end - start - 1);
+        int status{0};
+        char *demangled =
+            abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status == 0) {
+          symbol.replace(start + 1, name.size(), demangled);
+        }
+        std::free(demangled);
+      }
+      report += "  " + symbol + "\n";
+    }
+    std::free(symbols);
+  }
+#endif
+  return report;
+}
+
+void RealtimeChecker::record_violation(Violation kind) {
+  if (active_checker == nullptr || is_recording) {
+    return;
+  }
+  is_recording = true;
+  for (RealtimeChecker *c = active_checker; c != nullptr; c = c->previous) {
+    c->record(kind);
+  }
+  is_recording = false;
+}
+
+void RealtimeChecker::record(Violation kind) {
+  if (!is_running) {
+    return;
+  }
+  ++num_violations[kind];
+#if WELLS_REALTIME_CHECKS
+  if (num_stacks < max_stacks) {
+    Stack &stack = stacks[num_stacks++];
+    stack.kind = kind;
+    stack.num_frames = backtrace(stack.frames, max_frames);
+  }
+#endif
+}
+
+/*
+ * Replacements for the checked functions - debug builds with glibc only
+ *
+ * Memory goes to glibc's own allocator, the rest to whatever would have been
+ * called without us (RTLD_NEXT).
+ */
+
+#if WELLS_REALTIME_CHECKS
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void __libc_free(void *p);
+}
+
+// Looked up on first use. Not a function static, as guarding its
+// initialisation could need the lock being replaced.
+template <typename Function>
+static Function next(Function &real, const char *name) {
+  if (real == nullptr) {
+    real = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+  }
+  return real;
+}
+
+extern "C" {
+
+void *malloc(size_t size) noexcept {
+  RealtimeChecker::record_violation(RealtimeChecker::allocation);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size) noexcept {
+  RealtimeChecker::record_violation(RealtimeChecker::allocation);
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *p, size_t size) noexcept {
+  RealtimeChecker::record_violation(RealtimeChecker::allocation);
+  return __libc_realloc(p, size);
+}
+
+void free(void *p) noexcept {
+  if (p != nullptr) {
+    RealtimeChecker::record_violation(RealtimeChecker::deallocation);
+  }
+  __libc_free(p);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept {
+  using Function = int (*)(pthread_mutex_t *);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::lock);
+  return next(real, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *rwlock) noexcept {
+  using Function = int (*)(pthread_rwlock_t *);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::lock);
+  return next(real, "pthread_rwlock_rdlock")(rwlock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *rwlock) noexcept {
+  using Function = int (*)(pthread_rwlock_t *);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::lock);
+  return next(real, "pthread_rwlock_wrlock")(rwlock);
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+  using Function = int (*)(pthread_cond_t *, pthread_mutex_t *);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::lock);
+  return next(real, "pthread_cond_wait")(cond, mutex);
+}
+
+// declared here rather than with <fcntl.h> and <unistd.h>, which may define
+// them inline when fortified
+int open(const char *path, int flags, ...);
+ssize_t read(int fd, void *buffer, size_t num_bytes);
+ssize_t write(int fd, const void *buffer, size_t num_bytes);
+
+// the mode is only passed on when a file is created, but always reading it
+// is harmless
+int open(const char *path, int flags, ...) {
+  using Function = int (*)(const char *, int, ...);
+  static Function real;
+  va_list args;
+  va_start(args, flags);
+  unsigned int mode = va_arg(args, unsigned int);
+  va_end(args);
+  RealtimeChecker::record_violation(RealtimeChecker::file_access);
+  return next(real, "open")(path, flags, mode);
+}
+
+FILE *fopen(const char *path, const char *mode) {
+  using Function = FILE *(*)(const char *, const char *);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::file_access);
+  return next(real, "fopen")(path, mode);
+}
+
+ssize_t read(int fd, void *buffer, size_t num_bytes) {
+  using Function = ssize_t (*)(int, void *, size_t);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::file_access);
+  return next(real, "read")(fd, buffer, num_bytes);
+}
+
+ssize_t write(int fd, const void *buffer, size_t num_bytes) {
+  using Function = ssize_t (*)(int, const void *, size_t);
+  static Function real;
+  RealtimeChecker::record_violation(RealtimeChecker::file_access);
+  return next(real, "write")(fd, buffer, num_bytes);
+}
+}
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * RealtimeChecker.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+
+/*
+ * Realtime Checker
+ *
+ * Catches the current thread doing anything the audio thread mustn't while
+ * the checker is running: allocating or freeing memory, locking a mutex (or
+ * waiting on a condition) and opening, reading or writing files. Each
+ * violation is counted, and the stacks of the first few are kept so that a
+ * failing test can say where they came from.
+ *
+ * Checking works by replacing malloc, free, the pthread locks and the file
+ * calls with versions that tell the checker on their thread and then carry on
+ * as usual (see RealtimeChecker.cpp). That needs glibc, and like the
+ * AllocationCounter only happens in debug builds. Elsewhere is_available is
+ * false and nothing is ever counted.
+ *
+ * This file doesn't depend on JUCE so it can be used by the catch tests too.
+ */
+
+#if !defined(NDEBUG) && defined(__GLIBC__)
+#define WELLS_REALTIME_CHECKS 1
+#else
+#define WELLS_REALTIME_CHECKS 0
+#endif
+
+class RealtimeChecker {
+public:
+  enum Violation { allocation, deallocation, lock, file_access };
+  static constexpr int num_violation_kinds{4};
+
+  RealtimeChecker(); // starts checking the current thread
+  ~RealtimeChecker();
+
+  static bool is_available();
+
+  // Stops checking, so the results can be looked at (which allocates)
+  void stop();
+
+  int get_num_violations();
+  int get_num_violations(Violation kind);
+  // What each violation was and where it happened, after stopping
+  std::string get_report();
+
+  static void record_violation(Violation kind);
+
+private:
+  static constexpr int max_stacks{8};
+  static constexpr int max_frames{32};
+
+  struct Stack {
+    Violation kind;
+    int num_frames;
+    void *frames[max_frames];
+  };
+
+  RealtimeChecker *previous;
+  bool is_running;
+  std::array<int, num_violation_kinds> num_violations;
+  std::array<Stack, max_stacks> stacks;
+  int num_stacks;
+
+  void record(Violation kind);
+};
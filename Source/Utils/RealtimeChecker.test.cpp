@@ -0,0 +1,123 @@
+/*
+ * RealtimeChecker.test.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "RealtimeChecker.hpp"
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+class RealtimeCheckerTests : public UnitTest {
+public:
+  RealtimeCheckerTests() : UnitTest("RealtimeChecker Testing") {}
+
+  void runTest() override {
+    beginTest("catches allocations, locks and file access");
+
+    if (!RealtimeChecker::is_available()) {
+      logMessage("real time checks need a debug build with glibc, skipping");
+      return;
+    }
+
+    std::string *text;
+    {
+      RealtimeChecker checker;
+      text = new std::string(100, 'x');
+      checker.stop();
+      expect(checker.get_num_violations(RealtimeChecker::allocation) >= 1,
+             "an allocation should be caught");
+      expect(checker.get_num_violations(RealtimeChecker::deallocation) == 0,
+             "nothing has been freed yet");
+    }
+    {
+      RealtimeChecker checker;
+      delete text;
+      checker.stop();
+      expect(checker.get_num_violations(RealtimeChecker::deallocation) >= 1,
+             "freeing should be caught");
+    }
+
+    std::mutex mutex;
+    {
+      RealtimeChecker checker;
+      mutex.lock();
+      mutex.unlock();
+      checker.stop();
+      expect(checker.get_num_violations(RealtimeChecker::lock) == 1,
+             "locking a mutex should be caught");
+    }
+    {
+      RealtimeChecker checker;
+      std::FILE *file = std::fopen("/dev/null", "r");
+      checker.stop();
+      if (file != nullptr) {
+        std::fclose(file);
+      }
+      expect(checker.get_num_violations(RealtimeChecker::file_access) >= 1,
+             "opening a file should be caught");
+    }
+
+    beginTest("reports where each violation happened");
+
+    {
+      RealtimeChecker checker;
+      text = new std::string(100, 'x');
+      std::string report = checker.get_report();
+      delete text;
+      expect(report.find("allocation at:") != std::string::npos,
+             "the report should have the allocation's stack");
+    }
+
+    beginTest("doesn't catch code that is real time safe");
+
+    std::vector<int> reserved;
+    reserved.reserve(64);
+    std::atomic<int> counter{0};
+    {
+      RealtimeChecker checker;
+      for (int i = 0; i < 64; ++i) {
+        reserved.push_back(i);
+        counter.fetch_add(i);
+      }
+      checker.stop();
+      expect(checker.get_num_violations() == 0, checker.get_report());
+    }
+
+    beginTest("only checks its own thread, while running");
+
+    {
+      RealtimeChecker checker;
+      checker.stop();
+      delete new std::string(100, 'x');
+      expect(checker.get_num_violations() == 0,
+             "a stopped checker shouldn't count");
+    }
+
+    // the other thread allocates while this one is being checked
+    std::atomic<int> step{0};
+    std::thread other([&step]() {
+      while (step.load() != 1) {
+        std::this_thread::yield();
+      }
+      delete new std::string(100, 'x');
+      step = 2;
+    });
+    {
+      RealtimeChecker checker;
+      step = 1;
+      while (step.load() != 2) {
+        std::this_thread::yield();
+      }
+      checker.stop();
+      expect(checker.get_num_violations() == 0, checker.get_report());
+    }
+    other.join();
+  };
+};
+
+static RealtimeCheckerTests test;
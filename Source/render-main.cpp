@@ -0,0 +1,193 @@
+//
+//  render-main.cpp
+//  Wells Render
+//
+//  Renders a saved state or a preset to a Standard MIDI File, without a host,
+//  a GUI or an audio device.
+//
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "MidiGenerator/OfflineRenderer/OfflineRenderer.hpp"
+#include "MidiGenerator/PresetLibrary/PresetLibrary.hpp"
+#include "MidiGenerator/StateSerializer/StateSerializer.hpp"
+#include <iostream>
+
+static const char *usage =
+    "Usage: wells-render [options] <input> <output.mid>\n"
+    "\n"
+    "  <input> is a state saved by the plugin or a preset library.\n"
+    "\n"
+    "  --preset <name|index>      the preset to render from a library (0)\n"
+    "  --bars <n>                 how long to render, in bars (16)\n"
+    "  --seconds <s>              how long to render, in seconds\n"
+    "  --tempo <bpm>[,<beat>:<bpm>...]\n"
+    "                             the tempo, and where it changes, counting\n"
+    "                             quarter notes from the start (120)\n"
+    "  --time-signature <n>/<d>   (4/4)\n"
+    "  --sample-rate <hz>         (44100)\n"
+    "  --block-size <samples>     (512)\n"
+    "  --ppq <ticks>              ticks per quarter note in the file (960)\n";
+
+static int fail(const String &message) {
+  std::cerr << "wells-render: " << message << "\n";
+  return 1;
+}
+
+static bool parse_tempo_map(const String &argument,
+                            std::vector<OfflineRenderer::TempoChange> &map) {
+  StringArray changes = StringArray::fromTokens(argument, ",", "");
+  for (int i = 0; i < changes.size(); ++i) {
+    String change = changes[i];
+    double ppq{0};
+    if (change.contains(":")) {
+      ppq = change.upToFirstOccurrenceOf(":", false, false).getDoubleValue();
+      change = change.fromFirstOccurrenceOf(":", false, false);
+    } else if (i > 0) {
+      return false;
+    }
+    double bpm = change.getDoubleValue();
+    if (bpm <= 0 || ppq < 0) {
+      return false;
+    }
+    map.push_back({ppq, bpm});
+  }
+  return !map.empty();
+}
+
+// The state to render: the file itself, or one of the presets in it.
+static bool load_state(const File &input, const String &preset,
+                       EngineSnapshot &state, String &error) {
+  PresetLibrary library;
+  if (library.open(input)) {
+    int index{-1};
+    for (int i = 0; i < library.get_num_presets() && index < 0; ++i) {
+      if (library.get_name(i) == preset) {
+        index = i;
+      }
+    }
+    if (index < 0 && preset.containsOnly("0123456789")) {
+      index = preset.getIntValue();
+    }
+    if (index < 0 || index >= library.get_num_presets()) {
+      error = "no preset " + preset + " in " + input.getFullPathName();
+      return false;
+    }
+    if (!library.load(index, state)) {
+      error = "couldn't read preset " + preset;
+      return false;
+    }
+    return true;
+  }
+
+  MemoryBlock data;
+  if (!input.loadFileAsData(data) ||
+      !StateSerializer::read(data.getData(), data.getSize(), state)) {
+    error = input.getFullPathName() + " isn't a state or a preset library";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, const char *argv[]) {
+  StringArray args(argv + 1, argc - 1);
+  StringArray files;
+  String preset{"0"}, tempo{"120"}, time_signature{"4/4"};
+  double bars{16}, seconds{0}, sample_rate{44100};
+  int block_size{OfflineRenderer::default_block_size};
+  int ppq{OfflineRenderer::default_ticks_per_quarter};
+
+  for (int i = 0; i < args.size(); ++i) {
+    String arg = args[i];
+    if (arg == "--help" || arg == "-h") {
+      std::cout << usage;
+      return 0;
+    }
+    if (!arg.startsWith("--")) {
+      files.add(arg);
+      continue;
+    }
+    if (i + 1 >= args.size()) {
+      return fail(arg + " needs a value\n\n" + usage);
+    }
+    String value = args[++i];
+    if (arg == "--preset") {
+      preset = value;
+    } else if (arg == "--bars") {
+      bars = value.getDoubleValue();
+      seconds = 0;
+    } else if (arg == "--seconds") {
+      seconds = value.getDoubleValue();
+    } else if (arg == "--tempo") {
+      tempo = value;
+    } else if (arg == "--time-signature") {
+      time_signature = value;
+    } else if (arg == "--sample-rate") {
+      sample_rate = value.getDoubleValue();
+    } else if (arg == "--block-size") {
+      block_size = value.getIntValue();
+    } else if (arg == "--ppq") {
+      ppq = value.getIntValue();
+    } else {
+      return fail("unknown option " + arg + "\n\n" + usage);
+    }
+  }
+  if (files.size() != 2) {
+    return fail(String("an input and an output are needed\n\n") + usage);
+  }
+
+  std::vector<OfflineRenderer::TempoChange> tempo_map;
+  int numerator =
+      time_signature.upToFirstOccurrenceOf("/", false, false).getIntValue();
+  int denominator =
+      time_signature.fromFirstOccurrenceOf("/", false, false).getIntValue();
+  if (!parse_tempo_map(tempo, tempo_map)) {
+    return fail("can't read the tempo " + tempo);
+  }
+  if (numerator <= 0 || denominator <= 0) {
+    return fail("can't read the time signature " + time_signature);
+  }
+  if (sample_rate <= 0 || block_size <= 0 || ppq <= 0 || ppq > 0x7fff ||
+      bars < 0 || seconds < 0) {
+    return fail("the sample rate, block size, ppq and length must be positive, "
+                "and the ppq at most 32767");
+  }
+
+  File cwd = File::getCurrentWorkingDirectory();
+  File input = cwd.getChildFile(files[0]);
+  File output = cwd.getChildFile(files[1]);
+  EngineSnapshot state;
+  String error;
+  if (!load_state(input, preset, state, error)) {
+    return fail(error);
+  }
+
+  OfflineRenderer renderer(sample_rate, block_size);
+  renderer.set_tempo_map(tempo_map);
+  renderer.set_time_signature(numerator, denominator);
+  int64 num_samples =
+      seconds > 0 ? static_cast<int64>(std::llround(seconds * sample_rate))
+                  : renderer.get_sample_at(bars * numerator * 4.0 /
+                                           denominator);
+
+  MidiGenerator generator(state);
+  MidiMessageSequence rendered;
+  double started = Time::getMillisecondCounterHiRes();
+  renderer.render(generator, num_samples, rendered);
+  double render_ms = Time::getMillisecondCounterHiRes() - started;
+
+  MidiFile file;
+  renderer.to_midi_file(rendered, file, ppq);
+  output.deleteFile();
+  FileOutputStream stream(output);
+  if (stream.failedToOpen() || !file.writeTo(stream)) {
+    return fail("couldn't write " + output.getFullPathName());
+  }
+
+  double song_ms = num_samples * 1000.0 / sample_rate;
+  std::cout << "Rendered " << String(song_ms / 1000.0, 1) << "s ("
+            << rendered.getNumEvents() << " events) in "
+            << String(render_ms, 1) << "ms, "
+            << String(song_ms / jmax(render_ms, 0.001), 0)
+            << "x real time, to " << output.getFullPathName() << "\n";
+  return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Benchmark.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "Benchmark.hpp"
+#include "../Source/Utils/AllocationCounter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+Benchmark::Benchmark(const std::string &name, const std::string &unit,
+                     int64_t units_per_op, SetUp set_up)
+    : name{name}, unit{unit}, units_per_op{units_per_op}, set_up{set_up} {
+  get_all().push_back(this);
+}
+Benchmark::~Benchmark() {
+  std::vector<Benchmark *> &all = get_all();
+  all.erase(std::remove(all.begin(), all.end(), this), all.end());
+}
+
+std::vector<Benchmark *> &Benchmark::get_all() {
+  static std::vector<Benchmark *> all;
+  return all;
+}
+
+const std::string &Benchmark::get_name() { return name; }
+
+static double time_ns(const Benchmark::Op &op, int64_t num_iterations) {
+  auto start = std::chrono::steady_clock::now();
+  op(num_iterations);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+Benchmark::Result Benchmark::run(double min_seconds) {
+  Op op = set_up();
+
+  // long enough that the clock's resolution doesn't matter
+  double run_ns = min_seconds * 1e9 / num_runs;
+  int64_t num_iterations{1};
+  double ns = time_ns(op, num_iterations);
+  while (ns < run_ns / 10 && num_iterations < (int64_t{1} << 40)) {
+    num_iterations *= 2;
+    ns = time_ns(op, num_iterations);
+  }
+  num_iterations = std::max<int64_t>(
+      1, static_cast<int64_t>(num_iterations * run_ns / std::max(ns, 1.0)));
+
+  std::vector<double> ns_per_op;
+  int num_allocations{0};
+  for (int i = 0; i < num_runs; ++i) {
+    AllocationCounter counter;
+    ns_per_op.push_back(time_ns(op, num_iterations) / num_iterations);
+    num_allocations += counter.get_num_allocations();
+  }
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+
+  Result result;
+  result.name = name;
+  result.unit = unit;
+  result.iterations = num_iterations;
+  result.ns_per_op = ns_per_op[num_runs / 2];
+  result.min_ns_per_op = ns_per_op.front();
+  result.allocations_per_op =
+      static_cast<double>(num_allocations) / (num_iterations * num_runs);
+  result.units_per_second = units_per_op * 1e9 / result.ns_per_op;
+  return result;
+}
+
+/*
+ * JSON
+ */
+
+void Benchmark::write_json(const std::vector<Result> &results,
+                           const std::string &commit, std::ostream &out) {
+  out << "{\n  \"commit\": \"" << commit << "\",\n  \"benchmarks\": [\n";
+  out << std::setprecision(6);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit
+        << "\", \"iterations\": " << r.iterations
+        << ", \"ns_per_op\": " << r.ns_per_op
+        << ", \"min_ns_per_op\": " << r.min_ns_per_op
+        << ", \"allocations_per_op\": " << r.allocations_per_op
+        << ", \"units_per_second\": " << r.units_per_second << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+static std::string get_field(const std::string &line, const std::string &key) {
+  std::string quoted = "\"" + key + "\": ";
+  size_t start = line.find(quoted);
+  if (start == std::string::npos) {
+    return {};
+  }
+  start += quoted.size();
+  if (line[start] == '"') {
+    return line.substr(start + 1, line.find('"', start + 1) - start - 1);
+  }
+  return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+// Reads results written by write_json (and nothing more general).
+std::vector<Benchmark::Result> Benchmark::read_json(std::istream &in) {
+  std::vector<Result> results;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::string name = get_field(line, "name");
+    if (name.empty()) {
+      continue;
+    }
+    Result r;
+    r.name = name;
+    r.unit = get_field(line, "unit");
+    r.iterations = std::atoll(get_field(line, "iterations").c_str());
+    r.ns_per_op = std::atof(get_field(line, "ns_per_op").c_str());
+    r.min_ns_per_op = std::atof(get_field(line, "min_ns_per_op").c_str());
+    r.allocations_per_op =
+        std::atof(get_field(line, "allocations_per_op").c_str());
+    r.units_per_second = std::atof(get_field(line, "units_per_second").c_str());
+    results.push_back(r);
+  }
+  return results;
+}
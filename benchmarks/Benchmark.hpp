@@ -0,0 +1,75 @@
+/*
+ * Benchmark.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*
+ * Benchmark
+ *
+ * A small harness for timing the engine's hot paths. Each benchmark registers
+ * itself (like a JUCE UnitTest) with a set up function, which builds whatever
+ * it works on and returns the op to time. The op is called with a number of
+ * iterations to run, so the loop is in the benchmark and calling the op costs
+ * nothing per iteration.
+ *
+ * The number of iterations is doubled until a run takes long enough to time,
+ * then the op is timed several times and the fastest and median runs are
+ * reported, along with the heap allocations per iteration (counted by
+ * AllocationCounter) and the throughput in the benchmark's units (e.g. ticks
+ * or samples per second).
+ *
+ * This file doesn't depend on JUCE, so the Brain benchmarks build from the
+ * same sources as the catch tests.
+ */
+
+class Benchmark {
+public:
+  using Op = std::function<void(int64_t num_iterations)>;
+  using SetUp = std::function<Op()>;
+
+  struct Result {
+    std::string name;
+    std::string unit;
+    int64_t iterations;
+    double ns_per_op;     // median
+    double min_ns_per_op; // fastest run
+    double allocations_per_op;
+    double units_per_second;
+  };
+
+  Benchmark(const std::string &name, const std::string &unit,
+            int64_t units_per_op, SetUp set_up);
+  ~Benchmark();
+
+  static std::vector<Benchmark *> &get_all();
+
+  const std::string &get_name();
+  Result run(double min_seconds);
+
+  // Results, one benchmark per line so earlier results can be read back
+  static void write_json(const std::vector<Result> &results,
+                         const std::string &commit, std::ostream &out);
+  static std::vector<Result> read_json(std::istream &in);
+
+private:
+  std::string name, unit;
+  int64_t units_per_op;
+  SetUp set_up;
+
+  static constexpr int num_runs{5};
+};
+
+// Keeps the compiler from optimising away a result that's never used.
+template <typename T> inline void do_not_optimise(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,107 @@
+/*
+ * Brain.bench.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "../Source/MidiGenerator/WellNeurons/Brain.hpp"
+#include "Benchmark.hpp"
+#include <memory>
+#include <random>
+
+// A fully connected network that keeps firing: positive input weights, and a
+// mix of excitatory and inhibitory connections.
+static std::shared_ptr<Brain> make_brain(int num_neurons) {
+  std::mt19937 random(num_neurons);
+  std::uniform_int_distribution<int> weight(-20, 20);
+  std::uniform_int_distribution<int> input_weight(1, 10);
+  std::uniform_int_distribution<int> threshold(10, 100);
+
+  auto brain = std::make_shared<Brain>(num_neurons);
+  brain->prepare(num_neurons);
+  std::vector<int> input_weights(num_neurons);
+  for (int i = 0; i < num_neurons; ++i) {
+    input_weights[i] = input_weight(random);
+    brain->set_threshold_for_neuron(i, threshold(random));
+    std::vector<int> row(num_neurons);
+    for (int &w : row) {
+      w = weight(random);
+    }
+    brain->set_connection_weights_from(i, row);
+  }
+  brain->set_input_weights(input_weights);
+  return brain;
+}
+
+static Benchmark::Op process_next(int num_neurons) {
+  auto brain = make_brain(num_neurons);
+  std::vector<int> input(num_neurons, 1);
+  return [brain, input](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      do_not_optimise(brain->process_next(input).data());
+    }
+  };
+}
+
+static Benchmark::Op get_weighted_input(int num_neurons) {
+  auto brain = make_brain(num_neurons);
+  std::vector<int> input(num_neurons, 1);
+  return [brain, input](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      do_not_optimise(brain->get_weighted_input(input).size());
+    }
+  };
+}
+
+static Benchmark::Op get_connection_energy(int num_neurons) {
+  auto brain = make_brain(num_neurons);
+  // about half the network firing
+  std::vector<int> output(num_neurons);
+  for (int i = 0; i < num_neurons; i += 2) {
+    output[i] = 1;
+  }
+  return [brain, output](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      do_not_optimise(brain->get_connection_energy(output).size());
+    }
+  };
+}
+
+static constexpr int64_t fast_forward_ticks{1000};
+
+// from the start each time, as how long it takes depends on where it starts
+static Benchmark::Op fast_forward(int num_neurons) {
+  auto brain = make_brain(num_neurons);
+  std::vector<int> input(num_neurons, 1);
+  return [brain, input, num_neurons](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      for (int j = 0; j < num_neurons; ++j) {
+        brain->set_state_for_neuron(j, 0);
+      }
+      brain->fast_forward(input, fast_forward_ticks);
+      do_not_optimise(brain->get_state_for_neuron(0));
+    }
+  };
+}
+
+static Benchmark process_next_8{"Brain::process_next/8", "ticks", 1,
+                                [] { return process_next(8); }};
+static Benchmark process_next_64{"Brain::process_next/64", "ticks", 1,
+                                 [] { return process_next(64); }};
+static Benchmark weighted_input_8{"Brain::get_weighted_input/8", "ticks", 1,
+                                  [] { return get_weighted_input(8); }};
+static Benchmark weighted_input_64{"Brain::get_weighted_input/64", "ticks", 1,
+                                   [] { return get_weighted_input(64); }};
+static Benchmark connection_energy_8{
+    "Brain::get_connection_energy/8", "ticks", 1,
+    [] { return get_connection_energy(8); }};
+static Benchmark connection_energy_64{
+    "Brain::get_connection_energy/64", "ticks", 1,
+    [] { return get_connection_energy(64); }};
+static Benchmark fast_forward_8{"Brain::fast_forward/8", "ticks",
+                                fast_forward_ticks,
+                                [] { return fast_forward(8); }};
+static Benchmark fast_forward_64{"Brain::fast_forward/64", "ticks",
+                                 fast_forward_ticks,
+                                 [] { return fast_forward(64); }};
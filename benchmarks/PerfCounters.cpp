@@ -0,0 +1,91 @@
+/*
+ * PerfCounters.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int open_counter(uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // this thread, on any CPU
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters() {
+  const uint64_t configs[num_counters]{
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+  for (int i = 0; i < num_counters; ++i) {
+    fds[i] = open_counter(configs[i]);
+    counts[i] = -1;
+  }
+}
+PerfCounters::~PerfCounters() {
+  for (int fd : fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+void PerfCounters::start() {
+  for (int fd : fds) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+void PerfCounters::stop() {
+  for (int i = 0; i < num_counters; ++i) {
+    if (fds[i] < 0) {
+      continue;
+    }
+    ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count{0};
+    counts[i] = read(fds[i], &count, sizeof(count)) == sizeof(count)
+                    ? static_cast<int64_t>(count)
+                    : -1;
+  }
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+  fds.fill(-1);
+  counts.fill(-1);
+}
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+
+#endif
+
+bool PerfCounters::is_available() {
+  for (int fd : fds) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t PerfCounters::get(Counter counter) { return counts[counter]; }
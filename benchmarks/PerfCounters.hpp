@@ -0,0 +1,41 @@
+/*
+ * PerfCounters.hpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/*
+ * Perf Counters
+ *
+ * The CPU's hardware counters for the current thread, read with
+ * perf_event_open on Linux. Counting starts and stops with start and stop,
+ * and the counts are read after stop.
+ *
+ * The counters aren't always there (other platforms, virtual machines, or a
+ * kernel.perf_event_paranoid setting that doesn't allow them), so each one
+ * that couldn't be opened reads as -1 and the benchmark carries on without it.
+ */
+
+class PerfCounters {
+public:
+  enum Counter { cycles, instructions, cache_references, cache_misses };
+  static constexpr int num_counters{4};
+
+  PerfCounters();
+  ~PerfCounters();
+
+  bool is_available(); // any of the counters
+  void start();
+  void stop();
+  int64_t get(Counter counter);
+
+private:
+  std::array<int, num_counters> fds;
+  std::array<int64_t, num_counters> counts;
+};
@@ -0,0 +1,121 @@
+/*
+ * Engine.bench.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "../../Source/MidiGenerator/MidiGenerator.hpp"
+#include "../Benchmark.hpp"
+#include <memory>
+
+static constexpr double sample_rate{44100};
+static constexpr int block_size{512};
+
+static Benchmark::Op beat_clock_configure() {
+  auto clock = std::make_shared<BeatClock>();
+  clock->set_subdivision(4);
+  return [clock](int64_t n) {
+    AudioPlayHead::CurrentPositionInfo pos;
+    pos.bpm = 120;
+    for (int64_t i = 0; i < n; ++i) {
+      pos.timeInSamples = i * block_size;
+      clock->configure(sample_rate, pos);
+      do_not_optimise(clock->get_sample_num_remainder());
+    }
+  };
+}
+
+// every sample of a block, as generate_next_midi_buffer asks
+static Benchmark::Op beat_clock_should_play() {
+  auto clock = std::make_shared<BeatClock>();
+  clock->set_subdivision(4);
+  AudioPlayHead::CurrentPositionInfo pos;
+  pos.bpm = 120;
+  clock->configure(sample_rate, pos);
+  return [clock](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      int num_ticks{0};
+      for (int time = 0; time < block_size; ++time) {
+        num_ticks += clock->should_play(time) ? 1 : 0;
+      }
+      do_not_optimise(num_ticks);
+    }
+  };
+}
+
+// one tick's notes, half the neurons firing
+static Benchmark::Op midi_processor_render_buffer(int num_neurons) {
+  struct State {
+    MidiProcessor processor{0};
+    MidiScheduler scheduler;
+    MidiBuffer buffer;
+    std::vector<int> output;
+  };
+  auto state = std::make_shared<State>();
+  for (int i = 0; i < num_neurons; ++i) {
+    state->processor.add_midi_note(36 + i);
+    state->output.push_back(i % 2);
+  }
+  state->processor.prepare(sample_rate, num_neurons);
+  state->processor.configure(sample_rate, 5512.5f);
+  state->buffer.ensureSize(num_neurons * 2 * MidiProcessor::bytes_per_event);
+  return [state](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      state->buffer.clear();
+      state->processor.render_buffer(state->buffer, state->scheduler,
+                                     state->output, 0, 100);
+      state->scheduler.flush(state->buffer, 0);
+      do_not_optimise(state->buffer.getNumEvents());
+    }
+  };
+}
+
+// a block of a playing generator, at 16th notes
+static Benchmark::Op generate_next_midi_buffer(int num_neurons) {
+  auto generator = std::make_shared<MidiGenerator>(num_neurons);
+  generator->set_subdivision(4);
+  for (int i = 0; i < num_neurons; ++i) {
+    generator->set_neuron_input_weight(i, 1 + i % 5);
+    generator->set_neuron_threshold(i, 5 + i % 7);
+    for (int j = 0; j < num_neurons; ++j) {
+      generator->set_neuron_connection_weight(i, j, i == j ? -8 : (i + j) % 3);
+    }
+  }
+  generator->prepare(sample_rate, block_size, num_neurons);
+  auto buffer = std::make_shared<MidiBuffer>();
+  buffer->ensureSize(generator->get_max_midi_buffer_bytes());
+  auto position = std::make_shared<int64>(0);
+  return [generator, buffer, position](int64_t n) {
+    MidiBuffer no_input;
+    AudioPlayHead::CurrentPositionInfo pos;
+    pos.bpm = 120;
+    pos.isPlaying = true;
+    for (int64_t i = 0; i < n; ++i) {
+      buffer->clear();
+      pos.timeInSamples = *position;
+      generator->generate_next_midi_buffer(*buffer, no_input, pos,
+                                           sample_rate, block_size);
+      *position += block_size;
+      do_not_optimise(buffer->getNumEvents());
+    }
+  };
+}
+
+static Benchmark configure{"BeatClock::configure", "blocks", 1,
+                           [] { return beat_clock_configure(); }};
+static Benchmark should_play{"BeatClock::should_play/512", "samples",
+                             block_size,
+                             [] { return beat_clock_should_play(); }};
+static Benchmark render_buffer_8{
+    "MidiProcessor::render_buffer/8", "ticks", 1,
+    [] { return midi_processor_render_buffer(8); }};
+static Benchmark render_buffer_64{
+    "MidiProcessor::render_buffer/64", "ticks", 1,
+    [] { return midi_processor_render_buffer(64); }};
+static Benchmark generate_8{"MidiGenerator::generate_next_midi_buffer/8/512",
+                            "samples", block_size,
+                            [] { return generate_next_midi_buffer(8); }};
+static Benchmark generate_64{
+    "MidiGenerator::generate_next_midi_buffer/64/512", "samples", block_size,
+    [] { return generate_next_midi_buffer(64); }};
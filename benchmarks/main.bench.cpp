@@ -0,0 +1,95 @@
+/*
+ * main.bench.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+#include "Benchmark.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+static const char *usage =
+    "Usage: run_benchmarks [options]\n"
+    "\n"
+    "  --filter <text>    only run benchmarks with <text> in their name\n"
+    "  --seconds <s>      roughly how long to time each benchmark for (0.5)\n"
+    "  --json <file>      save the results\n"
+    "  --commit <hash>    the commit the results are for, saved with them\n"
+    "  --compare <file>   compare with results saved before\n";
+
+int main(int argc, const char *argv[]) {
+  std::string filter, json_path, commit, compare_path;
+  double seconds{0.5};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+      std::cout << usage;
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+    std::string value = argv[++i];
+    if (arg == "--filter") {
+      filter = value;
+    } else if (arg == "--seconds") {
+      seconds = std::atof(value.c_str());
+    } else if (arg == "--json") {
+      json_path = value;
+    } else if (arg == "--commit") {
+      commit = value;
+    } else if (arg == "--compare") {
+      compare_path = value;
+    } else {
+      std::cerr << "unknown option " << arg << "\n\n" << usage;
+      return 1;
+    }
+  }
+
+  std::map<std::string, Benchmark::Result> before;
+  if (!compare_path.empty()) {
+    std::ifstream in(compare_path);
+    if (!in) {
+      std::cerr << "couldn't read " << compare_path << "\n";
+      return 1;
+    }
+    for (const Benchmark::Result &r : Benchmark::read_json(in)) {
+      before[r.name] = r;
+    }
+  }
+
+  std::printf("%-48s %12s %12s %10s %16s%s\n", "benchmark", "ns/op",
+              "min ns/op", "allocs/op", "throughput",
+              before.empty() ? "" : "     change");
+  std::vector<Benchmark::Result> results;
+  for (Benchmark *benchmark : Benchmark::get_all()) {
+    if (benchmark->get_name().find(filter) == std::string::npos) {
+      continue;
+    }
+    Benchmark::Result r = benchmark->run(seconds);
+    results.push_back(r);
+
+    std::printf("%-48s %12.1f %12.1f %10.2f %10.3g %s/s", r.name.c_str(),
+                r.ns_per_op, r.min_ns_per_op, r.allocations_per_op,
+                r.units_per_second, r.unit.c_str());
+    auto previous = before.find(r.name);
+    if (previous != before.end()) {
+      std::printf(" %+9.1f%%",
+                  100.0 * (r.ns_per_op / previous->second.ns_per_op - 1.0));
+    }
+    std::printf("\n");
+  }
+
+  if (!json_path.empty()) {
+    std::ofstream out(json_path);
+    Benchmark::write_json(results, commit, out);
+    if (!out) {
+      std::cerr << "couldn't write " << json_path << "\n";
+      return 1;
+    }
+    std::cout << "Saved to " << json_path << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,458 @@
+/*
+ * Scaling.cpp
+ * Copyright (C) 2020 Ben Tilley <targansaikhan@gmail.com>
+ *
+ * Distributed under terms of the MIT license.
+ */
+
+/*
+ * Scaling Benchmark
+ *
+ * Sweeps the engine across network sizes and host settings to find where it
+ * stops keeping up. There are two sweeps:
+ *
+ *   tick   a Brain on its own, across neuron count, connection density and
+ *          firing rate - ns per tick
+ *   block  a playing MidiGenerator, across neuron count, subdivision and host
+ *          block size - ns per block, and the slowest block as a percentage
+ *          of the time the host gives it (over 100% and the audio drops out)
+ *
+ * Every configuration also records the heap bytes taken building it, the
+ * process's peak resident memory so far and, where the kernel allows
+ * perf_event_open, cycles, instructions and cache misses per tick. Results
+ * are written as CSV, and summarised as tables.
+ *
+ * The firing rate is a target: thresholds are set so that a neuron fed only
+ * its input fires at that rate, and connection weights are scaled so the
+ * recurrent input is of the same order. The rate each network really fired at
+ * is recorded with it.
+ */
+
+#include "../../Source/MidiGenerator/MidiGenerator.hpp"
+#include "../../Source/Utils/AllocationCounter.hpp"
+#include "../PerfCounters.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <sys/resource.h>
+
+static const char *usage =
+    "Usage: run_scaling [options]\n"
+    "\n"
+    "  --sweep <tick|block|all>      (all)\n"
+    "  --neurons <n,...>             (4,16,64,256,1024,4096)\n"
+    "  --densities <0-1,...>         (0,0.1,0.5,1)\n"
+    "  --rates <0-1,...>             target firing rates (0.01,0.1,0.5)\n"
+    "  --subdivisions <n,...>        (1,4,16)\n"
+    "  --block-sizes <samples,...>   (32,128,512,1024,4096)\n"
+    "  --seconds <s>                 time each configuration for (0.05)\n"
+    "  --csv <file>                  save the results\n";
+
+static constexpr double sample_rate{44100};
+static constexpr double bpm{120};
+static constexpr int input_weight{100};
+// the tick sweep times batches of ticks taking at least this long
+static constexpr double min_batch_ns{50000};
+static constexpr int max_batch_ticks{1 << 20};
+static constexpr int firing_sample_ticks{1000};
+// the block sweep's network
+static constexpr double block_density{0.5};
+static constexpr double block_rate{0.1};
+
+struct Config {
+  std::string sweep;
+  int neurons;
+  double density;
+  double rate;
+  int subdivision{0};
+  int block_size{0};
+};
+
+struct Measurement {
+  Config config;
+  double ns_per_tick{-1};
+  double ns_per_block{-1};
+  double max_ns_per_block{-1};
+  double budget_percent{-1};
+  double firing_rate{0};
+  size_t setup_bytes{0};
+  long max_rss_kb{0};
+  double cycles_per_tick{-1};
+  double instructions_per_tick{-1};
+  double cache_misses_per_tick{-1};
+};
+
+/*
+ * Building networks
+ */
+
+static EngineSnapshot make_state(const Config &config) {
+  EngineSnapshot state = *MidiGenerator(config.neurons).get_snapshot();
+  std::mt19937 random(config.neurons);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  int threshold = static_cast<int>(std::lround(input_weight / config.rate));
+  double connections = std::max(1.0, config.neurons * config.density);
+  int max_weight = std::max(
+      1, static_cast<int>(std::lround(threshold / std::sqrt(connections))));
+  std::uniform_int_distribution<int> weight(-max_weight, max_weight);
+
+  for (int i = 0; i < config.neurons; ++i) {
+    state.input_weights[i] = input_weight;
+    state.thresholds[i] = threshold;
+    auto row = std::make_shared<std::vector<int>>(config.neurons, 0);
+    for (int &w : *row) {
+      if (unit(random) < config.density) {
+        w = weight(random);
+      }
+    }
+    state.connection_weights[i] = row;
+  }
+  state.is_on = true;
+  state.subdivision = config.subdivision > 0 ? config.subdivision : 4;
+  return state;
+}
+
+static long get_max_rss_kb() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static double now_ns() {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void record_counters(PerfCounters &counters, int64_t num_ticks,
+                            Measurement &m) {
+  if (num_ticks == 0) {
+    return;
+  }
+  auto per_tick = [&](PerfCounters::Counter c) {
+    int64_t count = counters.get(c);
+    return count < 0 ? -1.0 : static_cast<double>(count) / num_ticks;
+  };
+  m.cycles_per_tick = per_tick(PerfCounters::cycles);
+  m.instructions_per_tick = per_tick(PerfCounters::instructions);
+  m.cache_misses_per_tick = per_tick(PerfCounters::cache_misses);
+}
+
+/*
+ * Sweeps
+ */
+
+static Measurement measure_ticks(const Config &config, double seconds) {
+  Measurement m;
+  m.config = config;
+  EngineSnapshot state = make_state(config);
+
+  std::unique_ptr<Brain> brain;
+  {
+    AllocationCounter counter;
+    brain = std::make_unique<Brain>(config.neurons);
+    brain->prepare(config.neurons);
+    brain->set_input_weights(state.input_weights);
+    for (int i = 0; i < config.neurons; ++i) {
+      brain->set_threshold_for_neuron(i, state.thresholds[i]);
+      brain->set_connection_weights_from(i, state.get_connection_row(i));
+    }
+    m.setup_bytes = counter.get_num_bytes();
+  }
+  std::vector<int> input(config.neurons, 1);
+  for (int i = 0; i < 10; ++i) {
+    brain->process_next(input);
+  }
+
+  // Ticks are timed in batches, so reading the clock is a small part of each
+  // measurement even for the smallest networks. The batch is doubled until
+  // it takes long enough, which also warms the brain up.
+  int batch{1};
+  while (batch < max_batch_ticks) {
+    double start = now_ns();
+    for (int t = 0; t < batch; ++t) {
+      brain->process_next(input);
+    }
+    if (now_ns() - start >= min_batch_ns) {
+      break;
+    }
+    batch *= 2;
+  }
+
+  PerfCounters counters;
+  int64_t num_ticks{0};
+  double elapsed{0};
+  counters.start();
+  while (elapsed < seconds * 1e9 || num_ticks < 3) {
+    double start = now_ns();
+    for (int t = 0; t < batch; ++t) {
+      brain->process_next(input);
+    }
+    elapsed += now_ns() - start;
+    num_ticks += batch;
+  }
+  counters.stop();
+
+  // the firing rate is counted afterwards, so scanning the output isn't timed
+  int64_t num_fired{0};
+  for (int t = 0; t < firing_sample_ticks; ++t) {
+    for (int fired : brain->process_next(input)) {
+      num_fired += fired;
+    }
+  }
+
+  m.ns_per_tick = elapsed / num_ticks;
+  m.firing_rate = static_cast<double>(num_fired) /
+                  (static_cast<double>(firing_sample_ticks) * config.neurons);
+  m.max_rss_kb = get_max_rss_kb();
+  record_counters(counters, num_ticks, m);
+  return m;
+}
+
+static Measurement measure_blocks(const Config &config, double seconds) {
+  Measurement m;
+  m.config = config;
+  EngineSnapshot state = make_state(config);
+
+  std::unique_ptr<MidiGenerator> generator;
+  MidiBuffer buffer;
+  {
+    AllocationCounter counter;
+    generator = std::make_unique<MidiGenerator>(state);
+    generator->prepare(sample_rate, config.block_size, config.neurons);
+    buffer.ensureSize(generator->get_max_midi_buffer_bytes());
+    m.setup_bytes = counter.get_num_bytes();
+  }
+
+  MidiBuffer no_input;
+  AudioPlayHead::CurrentPositionInfo pos;
+  pos.bpm = bpm;
+  pos.isPlaying = true;
+  double samples_per_tick = 60.0 / bpm / config.subdivision * sample_rate;
+  int64_t min_samples = static_cast<int64_t>(4 * samples_per_tick);
+
+  PerfCounters counters;
+  int64_t num_blocks{0}, num_samples{0};
+  double total{0}, slowest{0};
+  counters.start();
+  while (total < seconds * 1e9 || num_samples < min_samples) {
+    buffer.clear();
+    pos.timeInSamples = num_samples;
+    double start = now_ns();
+    generator->generate_next_midi_buffer(buffer, no_input, pos, sample_rate,
+                                         config.block_size);
+    double ns = now_ns() - start;
+    total += ns;
+    slowest = std::max(slowest, ns);
+    ++num_blocks;
+    num_samples += config.block_size;
+  }
+  counters.stop();
+
+  double block_ns = config.block_size / sample_rate * 1e9;
+  int64_t num_ticks = static_cast<int64_t>(num_samples / samples_per_tick);
+  m.ns_per_block = total / num_blocks;
+  m.max_ns_per_block = slowest;
+  m.budget_percent = 100.0 * slowest / block_ns;
+  m.ns_per_tick = num_ticks > 0 ? total / num_ticks : -1;
+  m.max_rss_kb = get_max_rss_kb();
+  record_counters(counters, num_ticks, m);
+  return m;
+}
+
+/*
+ * Output
+ */
+
+static void write_csv(const std::vector<Measurement> &results,
+                      std::ostream &out) {
+  out << "sweep,neurons,density,target_rate,subdivision,block_size,"
+         "ns_per_tick,ns_per_block,max_ns_per_block,budget_percent,"
+         "firing_rate,setup_bytes,max_rss_kb,cycles_per_tick,"
+         "instructions_per_tick,cache_misses_per_tick\n";
+  for (const Measurement &m : results) {
+    const Config &c = m.config;
+    out << c.sweep << "," << c.neurons << "," << c.density << "," << c.rate
+        << "," << c.subdivision << "," << c.block_size << ","
+        << m.ns_per_tick << "," << m.ns_per_block << "," << m.max_ns_per_block
+        << "," << m.budget_percent << "," << m.firing_rate << ","
+        << m.setup_bytes << "," << m.max_rss_kb << "," << m.cycles_per_tick
+        << "," << m.instructions_per_tick << "," << m.cache_misses_per_tick
+        << "\n";
+  }
+}
+
+// One row per neuron count and one column per `column` value, showing
+// `value` for the results picked by `in_table`.
+template <typename Column, typename InTable, typename Value>
+static void print_table(const char *title, const char *column_name,
+                        const std::vector<Measurement> &results,
+                        const std::vector<int> &neurons,
+                        const std::vector<double> &columns, Column column,
+                        InTable in_table, Value value) {
+  std::printf("\n%s\n%8s", title, "neurons");
+  for (double c : columns) {
+    std::printf(" %9s=%-4g", column_name, c);
+  }
+  std::printf("\n");
+  for (int n : neurons) {
+    std::printf("%8d", n);
+    for (double c : columns) {
+      std::string cell{"-"};
+      for (const Measurement &m : results) {
+        if (m.config.neurons == n && column(m) == c && in_table(m)) {
+          cell = value(m);
+        }
+      }
+      std::printf(" %14s", cell.c_str());
+    }
+    std::printf("\n");
+  }
+}
+
+static std::string format(const char *f, double v) {
+  char text[32];
+  std::snprintf(text, sizeof(text), f, v);
+  return text;
+}
+
+template <typename T>
+static bool parse_list(const std::string &text, std::vector<T> &list) {
+  list.clear();
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    std::stringstream value(item);
+    T v;
+    if (!(value >> v)) {
+      return false;
+    }
+    list.push_back(v);
+  }
+  return !list.empty();
+}
+
+int main(int argc, const char *argv[]) {
+  std::string sweep{"all"}, csv_path;
+  std::vector<int> neurons{4, 16, 64, 256, 1024, 4096};
+  std::vector<double> densities{0, 0.1, 0.5, 1};
+  std::vector<double> rates{0.01, 0.1, 0.5};
+  std::vector<int> subdivisions{1, 4, 16};
+  std::vector<int> block_sizes{32, 128, 512, 1024, 4096};
+  double seconds{0.05};
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+      std::cout << usage;
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+    std::string value = argv[++i];
+    bool ok{true};
+    if (arg == "--sweep") {
+      sweep = value;
+      ok = sweep == "tick" || sweep == "block" || sweep == "all";
+    } else if (arg == "--neurons") {
+      ok = parse_list(value, neurons);
+    } else if (arg == "--densities") {
+      ok = parse_list(value, densities);
+    } else if (arg == "--rates") {
+      ok = parse_list(value, rates);
+    } else if (arg == "--subdivisions") {
+      ok = parse_list(value, subdivisions);
+    } else if (arg == "--block-sizes") {
+      ok = parse_list(value, block_sizes);
+    } else if (arg == "--seconds") {
+      seconds = std::atof(value.c_str());
+    } else if (arg == "--csv") {
+      csv_path = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cerr << "can't use " << arg << " " << value << "\n\n" << usage;
+      return 1;
+    }
+  }
+
+  std::printf("perf counters %s\n", PerfCounters().is_available()
+                                        ? "available"
+                                        : "unavailable, skipping them");
+  std::vector<Measurement> results;
+  if (sweep != "block") {
+    for (int n : neurons) {
+      for (double density : densities) {
+        for (double rate : rates) {
+          results.push_back(
+              measure_ticks(Config{"tick", n, density, rate}, seconds));
+          std::fprintf(stderr, "\rtick  n=%-5d density=%-4g rate=%-4g", n,
+                       density, rate);
+        }
+      }
+    }
+  }
+  if (sweep != "tick") {
+    for (int n : neurons) {
+      for (int subdivision : subdivisions) {
+        for (int block_size : block_sizes) {
+          Config config{"block", n, block_density, block_rate, subdivision,
+                        block_size};
+          results.push_back(measure_blocks(config, seconds));
+          std::fprintf(stderr, "\rblock n=%-5d subdivision=%-3d block=%-5d", n,
+                       subdivision, block_size);
+        }
+      }
+    }
+  }
+  std::fprintf(stderr, "\r%60s\r", "");
+
+  if (sweep != "block") {
+    for (double rate : rates) {
+      std::string title = "ns per tick (Brain), target firing rate " +
+                          format("%g", rate);
+      print_table(
+          title.c_str(), "density", results, neurons, densities,
+          [](const Measurement &m) { return m.config.density; },
+          [rate](const Measurement &m) {
+            return m.config.sweep == "tick" && m.config.rate == rate;
+          },
+          [](const Measurement &m) { return format("%.0f", m.ns_per_tick); });
+    }
+  }
+  if (sweep != "tick") {
+    std::vector<double> columns(block_sizes.begin(), block_sizes.end());
+    for (int subdivision : subdivisions) {
+      std::string title =
+          "slowest block as % of its real time budget (MidiGenerator), "
+          "subdivision " +
+          std::to_string(subdivision) + " (* can't keep up)";
+      print_table(
+          title.c_str(), "block", results, neurons, columns,
+          [](const Measurement &m) { return m.config.block_size; },
+          [subdivision](const Measurement &m) {
+            return m.config.sweep == "block" &&
+                   m.config.subdivision == subdivision;
+          },
+          [](const Measurement &m) {
+            return format(m.budget_percent > 100 ? "%.1f*" : "%.1f",
+                          m.budget_percent);
+          });
+    }
+  }
+
+  if (!csv_path.empty()) {
+    std::ofstream out(csv_path);
+    write_csv(results, out);
+    if (!out) {
+      std::cerr << "couldn't write " << csv_path << "\n";
+      return 1;
+    }
+    std::cout << "\nSaved to " << csv_path << "\n";
+  }
+  return 0;
+}
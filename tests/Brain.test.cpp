@@ -6,6 +6,8 @@
  */
 
 #include "../Source/MidiGenerator/WellNeurons/Brain.hpp"
+#include "../Source/Utils/AllocationCounter.hpp"
+#include "../Source/Utils/RealtimeChecker.hpp"
 #include <catch2/catch.hpp>
 #include <iostream>
 
@@ -32,6 +34,21 @@ SCENARIO("The Brain") {
       }
     }
 
+    WHEN("we prepare the brain for a bigger network") {
+      brain.prepare(8);
+      const int *output = brain.get_output().data();
+      std::vector<int> input(8, 1);
+
+      THEN("growing the network doesn't reallocate the working space") {
+        for (int i = 0; i < 4; ++i) {
+          brain.add_neuron();
+        }
+        REQUIRE(brain.num_neurons() == 8);
+        brain.process_next(input);
+        REQUIRE(brain.get_output().data() == output);
+      }
+    }
+
     WHEN("we remove a neuron from the brain") {
       brain.remove_neuron();
       THEN("the neurons and connections resize") {
@@ -64,6 +81,56 @@ SCENARIO("The Brain") {
       REQUIRE_THROWS(brain.set_connection_weights(std::vector<std::vector<int>>{
           std::vector<int>{1, 3}, std::vector<int>{4, 6},
           std::vector<int>{7, 9}}));
+      REQUIRE_THROWS(
+          brain.set_connection_weights_from(0, std::vector<int>{1, 2}));
+    }
+
+    WHEN("we set the connection weights from one neuron") {
+      brain.set_connection_weights_from(2, std::vector<int>{4, 3, 2, 1});
+      THEN("only that neuron's weights change") {
+        REQUIRE(brain.get_connection_weights().at(2) ==
+                std::vector<int>{4, 3, 2, 1});
+        REQUIRE(brain.get_connection_weights().at(1) ==
+                std::vector<int>{0, 0, 0, 0});
+      }
+    }
+
+    WHEN("we copy the brain and change the copy") {
+      brain.set_connection_weight_for_neurons(1, 2, 5);
+      Brain copy = brain;
+      REQUIRE(copy.shares_input_weights(brain));
+      for (int from = 0; from < 4; ++from) {
+        REQUIRE(copy.shares_connection_weights_from(brain, from));
+      }
+      copy.set_connection_weight_for_neurons(1, 2, 7);
+      THEN("only the row that changed is copied") {
+        REQUIRE(!copy.shares_connection_weights_from(brain, 1));
+        REQUIRE(copy.shares_connection_weights_from(brain, 0));
+        REQUIRE(copy.shares_connection_weights_from(brain, 3));
+        REQUIRE(copy.shares_input_weights(brain));
+      }
+      THEN("the original keeps its weights") {
+        REQUIRE(brain.get_connection_weight_for_neurons(1, 2) == 5);
+        REQUIRE(copy.get_connection_weight_for_neurons(1, 2) == 7);
+      }
+      THEN("preparing the copy keeps the rows it shares") {
+        copy.prepare(8);
+        REQUIRE(copy.shares_input_weights(brain));
+        REQUIRE(copy.shares_connection_weights_from(brain, 0));
+        REQUIRE(!copy.shares_connection_weights_from(brain, 1));
+        copy.add_neuron();
+        REQUIRE(!copy.shares_connection_weights_from(brain, 0));
+        REQUIRE(brain.get_connection_weights().at(0).size() == 4);
+      }
+    }
+
+    WHEN("we set the states of individual neurons") {
+      brain.set_state_for_neuron(1, 7);
+      THEN("only that neuron's state changes") {
+        REQUIRE(brain.get_state_for_neuron(1) == 7);
+        REQUIRE(brain.get_state_for_neuron(0) == 0);
+        REQUIRE_THROWS(brain.set_state_for_neuron(4, 1));
+      }
     }
 
     WHEN("we set the input weights of individual neurons") {
@@ -179,6 +246,8 @@ SCENARIO("The Brain") {
                        [](Neuron n) { return n.get_input(); });
         REQUIRE(states == std::vector<int>{3, 0, -16});
         REQUIRE(inputs == std::vector<int>{0, 0, 0});
+        REQUIRE(brain.get_state_for_neuron(0) == 3);
+        REQUIRE(brain.get_state_for_neuron(2) == -16);
       }
     }
   }
@@ -268,5 +337,67 @@ SCENARIO("The Brain") {
       brain.process_next(std::vector<int>{0, 1, 0, 0});
       REQUIRE(brain.get_output() == std::vector<int>{1, 1, 0, 0});
     }
+
+    THEN("the output levels are graded and agree with the output") {
+      brain.process_next(std::vector<int>{1, 1, 1, 0});
+      brain.process_next(std::vector<int>{0, 0, 0, 1});
+      brain.process_next(std::vector<int>{1, 1, 1, 0});
+      REQUIRE(brain.get_output() == std::vector<int>{1, 0, 0, 0});
+      REQUIRE(brain.get_output_levels() == std::vector<int>{3, 0, 0, 0});
+    }
+
+    THEN("processing the next state should not allocate") {
+      std::vector<int> input{1, 0, 1, 1};
+      AllocationCounter counter;
+      for (int i = 0; i < 16; ++i) {
+        brain.process_next(input);
+      }
+      REQUIRE(counter.get_num_allocations() == 0);
+    }
+
+    THEN("processing and fast forwarding should be real time safe") {
+      std::vector<int> input{1, 0, 1, 1};
+      RealtimeChecker checker;
+      for (int i = 0; i < 16; ++i) {
+        brain.process_next(input);
+      }
+      brain.fast_forward(input, 100);
+      checker.stop();
+      INFO(checker.get_report());
+      REQUIRE(checker.get_num_violations() == 0);
+    }
+  }
+
+  GIVEN("a Brain with 6 neurons with mixed excitation and inhibition") {
+    Brain brain(6);
+    unsigned int seed = 12345;
+    auto next_weight = [&seed](int range) {
+      seed = seed * 1103515245 + 12345;
+      return static_cast<int>((seed >> 16) % (2 * range + 1)) - range;
+    };
+    for (int i = 0; i < 6; ++i) {
+      brain.set_input_weight_for_neuron(i, next_weight(3));
+      brain.set_threshold_for_neuron(i, next_weight(20));
+      for (int j = 0; j < 6; ++j) {
+        brain.set_connection_weight_for_neurons(i, j, next_weight(5));
+      }
+    }
+    std::vector<int> input(6, 1);
+
+    THEN("fast forwarding matches stepping through every tick") {
+      for (int num_ticks : {0, 1, 7, 100, 2000}) {
+        Brain stepped = brain;
+        Brain jumped = brain;
+        for (int t = 0; t < num_ticks; ++t) {
+          stepped.process_next(input);
+        }
+        jumped.fast_forward(input, num_ticks);
+        for (int i = 0; i < 6; ++i) {
+          REQUIRE(jumped.get_state_for_neuron(i) ==
+                  stepped.get_state_for_neuron(i));
+        }
+        REQUIRE(jumped.get_output() == stepped.get_output());
+      }
+    }
   }
 }
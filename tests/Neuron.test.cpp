@@ -22,6 +22,11 @@ SCENARIO("A Neuron") {
       REQUIRE(Neuron.get_threshold() == 3);
     }
 
+    WHEN("we set the state") {
+      Neuron.set_state(4);
+      REQUIRE(Neuron.get_state() == 4);
+    }
+
     WHEN("we set the input") {
       Neuron.set_input(8);
       REQUIRE(Neuron.get_input() == 8);
@@ -51,6 +56,23 @@ SCENARIO("A Neuron") {
         REQUIRE(Neuron.get_output() == 1);
       }
     }
+
+    WHEN("we get the output level of the neuron") {
+      Neuron.set_threshold(2);
+      Neuron.set_input(1);
+      Neuron.update_state();
+      REQUIRE(Neuron.get_output_level() == 0);
+      Neuron.set_input(4);
+      Neuron.update_state();
+      THEN("it is how far the state is over the threshold") {
+        REQUIRE(Neuron.get_output_level() == 3);
+      }
+      Neuron.set_input(1000);
+      Neuron.update_state();
+      THEN("it is capped at the max output level") {
+        REQUIRE(Neuron.get_output_level() == Neuron::max_output_level);
+      }
+    }
   }
 
   GIVEN("we have an instance of Neuron") {